@@ -6,6 +6,7 @@
  */
 
 #include "adamantine.hh"
+#include "calibration.hh"
 #include <validate_input_database.hh>
 
 #ifdef ADAMANTINE_WITH_ADIAK
@@ -54,7 +55,11 @@ int main(int argc, char *argv[])
     boost_po::options_description description("Options:");
     description.add_options()("help,h", "Produce help message.")(
         "input-file,i", boost_po::value<std::string>(),
-        "Name of the input file.");
+        "Name of the input file.")(
+        "dry-run", "Perform the refinement and the material deposition without "
+                   "solving and report the size of the problem.")(
+        "calibrate", "Run short trial simulations to select the finite element "
+                     "degree, the quadrature, and the time stepping method.");
     // Declare a map that will contains the values read. Parse the command line
     // and finally populate the map.
     boost_po::variables_map map;
@@ -133,7 +138,47 @@ int main(int argc, char *argv[])
       adiak::value("MemorySpace", "Host");
 #endif
 
-    if (dim == 2)
+    if (map.count("calibrate") == 1)
+    {
+      if (rank == 0)
+        std::cout << "Starting calibration" << std::endl;
+      if (memory_space == "device")
+      {
+        if (dim == 2)
+          calibrate<2, dealii::MemorySpace::CUDA>(communicator, database);
+        else
+          calibrate<3, dealii::MemorySpace::CUDA>(communicator, database);
+      }
+      else
+      {
+        if (dim == 2)
+          calibrate<2, dealii::MemorySpace::Host>(communicator, database);
+        else
+          calibrate<3, dealii::MemorySpace::Host>(communicator, database);
+      }
+    }
+    else if (map.count("dry-run") == 1)
+    {
+      // The dry run only needs one mesh so ensemble simulations are treated
+      // like a single simulation.
+      if (rank == 0)
+        std::cout << "Starting dry run" << std::endl;
+      if (memory_space == "device")
+      {
+        if (dim == 2)
+          dry_run<2, dealii::MemorySpace::CUDA>(communicator, database, timers);
+        else
+          dry_run<3, dealii::MemorySpace::CUDA>(communicator, database, timers);
+      }
+      else
+      {
+        if (dim == 2)
+          dry_run<2, dealii::MemorySpace::Host>(communicator, database, timers);
+        else
+          dry_run<3, dealii::MemorySpace::Host>(communicator, database, timers);
+      }
+    }
+    else if (dim == 2)
     {
       if (ensemble_calc)
       {
@@ -15,6 +15,7 @@
 #include <MaterialProperty.hh>
 #include <MechanicalPhysics.hh>
 #include <MemoryBlock.hh>
+#include <MemoryReport.hh>
 #include <PointCloud.hh>
 #include <PostProcessor.hh>
 #include <RayTracing.hh>
@@ -29,19 +30,26 @@
 #include <deal.II/base/index_set.h>
 #include <deal.II/base/mpi.h>
 #include <deal.II/base/types.h>
+#include <deal.II/base/utilities.h>
 #include <deal.II/distributed/cell_data_transfer.templates.h>
 #include <deal.II/distributed/solution_transfer.h>
 #include <deal.II/grid/filtered_iterator.h>
 #include <deal.II/grid/grid_refinement.h>
 #include <deal.II/lac/trilinos_sparse_matrix.h>
 #include <deal.II/lac/vector_operation.h>
+#include <deal.II/numerics/adaptation_strategies.h>
 #include <deal.II/numerics/error_estimator.h>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/program_options.hpp>
 #include <boost/property_tree/info_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
 
+#include <algorithm>
+#include <limits>
+#include <map>
 #include <memory>
+#include <tuple>
 #include <type_traits>
 #include <unordered_map>
 
@@ -50,6 +58,8 @@
 #endif
 
 #include <cmath>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 
 template <int dim, typename MemorySpaceType,
@@ -346,13 +356,80 @@ initialize_thermal_physics(
   }
 }
 
+// History of the temperature of the cells used by the progressive coarsening.
+// The vectors are indexed by the active cell index and they are transferred
+// with the mesh.
+struct CoolingHistory
+{
+  // Time since which the cell satisfies the coarsening criteria. It is
+  // infinite if the cell does not satisfy them.
+  std::vector<double> cooling_start_times;
+  // Largest temperature of the cell when the criteria were last evaluated.
+  std::vector<double> temperatures;
+  // Time at which the criteria were last evaluated.
+  double time = -1.;
+};
+
+// Combine the data transferred from the children of a cell that is coarsened.
+// The data of a cell contains the material states, the cos and the sin of the
+// deposition angle, the melted indicator, the cooling start time, and the
+// temperature. The material states are averaged, the cooling start time is the
+// latest one, i.e., infinite if one of the children is not cooling, and the
+// temperature is the largest one. The other entries are
+// infinite on the inactive cells so they are combined over the activated
+// children only: the deposition angle is averaged and the cell has melted if
+// one of the children has melted.
+inline std::vector<double>
+coarsen_cell_data(std::vector<std::vector<double>> const &children_data,
+                  unsigned int const n_material_states)
+{
+  unsigned int const has_melted_index = n_material_states + 2;
+  unsigned int const cooling_start_index = has_melted_index + 1;
+  unsigned int const temperature_index = cooling_start_index + 1;
+  std::vector<double> parent_data(temperature_index + 1, 0.);
+  parent_data[cooling_start_index] = std::numeric_limits<double>::lowest();
+  parent_data[temperature_index] = std::numeric_limits<double>::lowest();
+  unsigned int n_activated_children = 0;
+  for (auto const &child_data : children_data)
+  {
+    for (unsigned int i = 0; i < n_material_states; ++i)
+      parent_data[i] += child_data[i] / children_data.size();
+    if (std::isfinite(child_data[has_melted_index]))
+    {
+      parent_data[n_material_states] += child_data[n_material_states];
+      parent_data[n_material_states + 1] += child_data[n_material_states + 1];
+      parent_data[has_melted_index] = std::max(parent_data[has_melted_index],
+                                               child_data[has_melted_index]);
+      ++n_activated_children;
+    }
+    parent_data[cooling_start_index] = std::max(
+        parent_data[cooling_start_index], child_data[cooling_start_index]);
+    parent_data[temperature_index] =
+        std::max(parent_data[temperature_index], child_data[temperature_index]);
+  }
+
+  if (n_activated_children > 0)
+  {
+    parent_data[n_material_states] /= n_activated_children;
+    parent_data[n_material_states + 1] /= n_activated_children;
+  }
+  else
+  {
+    for (unsigned int i = n_material_states; i < cooling_start_index; ++i)
+      parent_data[i] = std::numeric_limits<double>::infinity();
+  }
+
+  return parent_data;
+}
+
 template <int dim, typename MemorySpaceType>
 void refine_and_transfer(
     std::unique_ptr<adamantine::ThermalPhysicsInterface<dim, MemorySpaceType>>
         &thermal_physics,
     adamantine::MaterialProperty<dim, MemorySpaceType> &material_properties,
     dealii::DoFHandler<dim> &dof_handler,
-    dealii::LA::distributed::Vector<double, MemorySpaceType> &solution)
+    dealii::LA::distributed::Vector<double, MemorySpaceType> &solution,
+    CoolingHistory &cooling_history)
 {
 #ifdef ADAMANTINE_WITH_CALIPER
   CALI_CXX_MARK_FUNCTION;
@@ -376,10 +453,12 @@ void refine_and_transfer(
   // Transfer material state
   unsigned int const direction_data_size = 2;
   unsigned int const phase_history_data_size = 1;
+  unsigned int const cooling_data_size = 2;
   unsigned int constexpr n_material_states = adamantine::g_n_material_states;
+  unsigned int const cooling_data_offset =
+      n_material_states + direction_data_size + phase_history_data_size;
   std::vector<std::vector<double>> data_to_transfer;
-  std::vector<double> dummy_cell_data(n_material_states + direction_data_size +
-                                          phase_history_data_size,
+  std::vector<double> dummy_cell_data(cooling_data_offset + cooling_data_size,
                                       std::numeric_limits<double>::infinity());
   adamantine::MemoryBlockView<double, MemorySpaceType> material_state_view =
       material_properties.get_state();
@@ -399,8 +478,7 @@ void refine_and_transfer(
   {
     if (cell->is_locally_owned())
     {
-      std::vector<double> cell_data(n_material_states + direction_data_size +
-                                    phase_history_data_size);
+      std::vector<double> cell_data(cooling_data_offset + cooling_data_size);
       for (unsigned int i = 0; i < n_material_states; ++i)
         cell_data[i] = state_host_view(i, cell_id);
       if (cell->active_fe_index() == 0)
@@ -425,6 +503,10 @@ void refine_and_transfer(
         cell_data[n_material_states + direction_data_size] =
             std::numeric_limits<double>::infinity();
       }
+      cell_data[cooling_data_offset] =
+          cooling_history.cooling_start_times[cell->active_cell_index()];
+      cell_data[cooling_data_offset + 1] =
+          cooling_history.temperatures[cell->active_cell_index()];
       data_to_transfer.push_back(cell_data);
       ++cell_id;
     }
@@ -461,9 +543,17 @@ void refine_and_transfer(
     solution_transfer.prepare_for_coarsening_and_refinement(solution_host);
   }
 
+  // The children of a coarsened cell do not have the same data in general so
+  // they are combined explicitly.
   dealii::parallel::distributed::CellDataTransfer<
       dim, dim, std::vector<std::vector<double>>>
-      cell_data_trans(triangulation);
+      cell_data_trans(
+          triangulation, false,
+          &dealii::AdaptationStrategies::Refinement::preserve<
+              dim, dim, std::vector<double>>,
+          [&](typename dealii::Triangulation<dim>::cell_iterator const &,
+              std::vector<std::vector<double>> const &children_data)
+          { return coarsen_cell_data(children_data, n_material_states); });
   cell_data_trans.prepare_for_coarsening_and_refinement(data_to_transfer);
 
 #ifdef ADAMANTINE_WITH_CALIPER
@@ -497,9 +587,12 @@ void refine_and_transfer(
   // Unpack the material state and repopulate the material state
   std::vector<std::vector<double>> transferred_data(
       triangulation.n_active_cells(),
-      std::vector<double>(n_material_states + direction_data_size +
-                          phase_history_data_size));
+      std::vector<double>(cooling_data_offset + cooling_data_size));
   cell_data_trans.unpack(transferred_data);
+  cooling_history.cooling_start_times.assign(
+      triangulation.n_active_cells(), std::numeric_limits<double>::infinity());
+  cooling_history.temperatures.assign(triangulation.n_active_cells(),
+                                      std::numeric_limits<double>::lowest());
   material_state_view = material_properties.get_state();
   material_state_host.reinit(material_state_view.extent(0),
                              material_state_view.extent(1));
@@ -531,6 +624,10 @@ void refine_and_transfer(
         else
           has_melted.push_back(false);
       }
+      cooling_history.cooling_start_times[total_cell_id] =
+          transferred_data[total_cell_id][cooling_data_offset];
+      cooling_history.temperatures[total_cell_id] =
+          transferred_data[total_cell_id][cooling_data_offset + 1];
       ++cell_id;
     }
     ++total_cell_id;
@@ -621,6 +718,219 @@ compute_cells_to_refine(
   return cells_to_refine;
 }
 
+// Return the largest distance traveled by the beams since the positions stored
+// in @p beam_positions and update these positions to their values at @p time.
+template <int dim>
+double compute_beam_displacement(
+    std::vector<std::shared_ptr<adamantine::HeatSource<dim>>> const
+        &heat_sources,
+    std::vector<dealii::Point<3>> &beam_positions, double const time)
+{
+  if (beam_positions.size() != heat_sources.size())
+  {
+    beam_positions.resize(heat_sources.size());
+    for (unsigned int i = 0; i < heat_sources.size(); ++i)
+      beam_positions[i] = heat_sources[i]->get_scan_path().value(time);
+    return 0.;
+  }
+
+  double displacement = 0.;
+  for (unsigned int i = 0; i < heat_sources.size(); ++i)
+  {
+    dealii::Point<3> const position =
+        heat_sources[i]->get_scan_path().value(time);
+    displacement =
+        std::max(displacement, position.distance(beam_positions[i]));
+    beam_positions[i] = position;
+  }
+
+  return displacement;
+}
+
+// Follow the scan paths from @p time until one of the beams has traveled @p
+// lookahead_distance. Return the time reached and the number of time steps
+// used to reach it. The number of time steps is capped so that a beam that
+// does not move does not stall the search.
+template <int dim>
+std::pair<double, unsigned int> compute_lookahead(
+    std::vector<std::shared_ptr<adamantine::HeatSource<dim>>> const
+        &heat_sources,
+    double const time, double const time_step, double const lookahead_distance,
+    double const duration)
+{
+  unsigned int constexpr max_n_time_steps = 1000;
+  std::vector<dealii::Point<3>> beam_positions;
+  compute_beam_displacement(heat_sources, beam_positions, time);
+  double lookahead_time = time;
+  double travel = 0.;
+  unsigned int n_time_steps = 0;
+  while ((travel < lookahead_distance) && (lookahead_time < duration) &&
+         (n_time_steps < max_n_time_steps))
+  {
+    lookahead_time = std::min(lookahead_time + time_step, duration);
+    travel += compute_beam_displacement(heat_sources, beam_positions,
+                                        lookahead_time);
+    ++n_time_steps;
+  }
+
+  return std::make_pair(lookahead_time, std::max(n_time_steps, 1u));
+}
+
+// Return true if the mesh needs to be refined. By default, the mesh is refined
+// every time_steps_refinement time steps. When refinement.beam_travel_distance
+// is set, the mesh is refined every time the beams have traveled that
+// distance. In both cases, the mesh is also refined when time reaches the end
+// of the region that was refined previously.
+inline bool
+need_refinement(unsigned int const n_time_step, double const time,
+                double const next_refinement_time,
+                unsigned int const time_steps_refinement,
+                boost::optional<double> const &beam_travel_distance,
+                double const beam_travel)
+{
+  if (time >= next_refinement_time)
+    return true;
+  if (beam_travel_distance)
+    return beam_travel >= beam_travel_distance.get();
+
+  return (n_time_step % time_steps_refinement) == 0;
+}
+
+// Return the time up to which the mesh is refined along the scan paths and the
+// number of time steps used to sample the scan paths.
+template <int dim>
+std::pair<double, unsigned int> compute_refinement_window(
+    std::vector<std::shared_ptr<adamantine::HeatSource<dim>>> const
+        &heat_sources,
+    double const time, double const time_step, double const duration,
+    unsigned int const time_steps_refinement,
+    boost::optional<double> const &beam_travel_distance,
+    double const lookahead_distance)
+{
+  if (beam_travel_distance)
+    return compute_lookahead(heat_sources, time, time_step,
+                             lookahead_distance, duration);
+
+  return std::make_pair(time + time_steps_refinement * time_step,
+                        time_steps_refinement);
+}
+
+// Return the largest value of the temperature on each locally owned cell. The
+// value is lowest() on the cells that do not have any degree of freedom.
+template <int dim, typename MemorySpaceType>
+dealii::Vector<float> compute_max_temperature_per_cell(
+    dealii::DoFHandler<dim> const &dof_handler,
+    dealii::LA::distributed::Vector<double, MemorySpaceType> const &solution)
+{
+  dealii::LA::distributed::Vector<double, dealii::MemorySpace::Host>
+      solution_host(solution.get_partitioner());
+  solution_host.import(solution, dealii::VectorOperation::insert);
+  solution_host.update_ghost_values();
+
+  dealii::Vector<float> max_temperature(
+      dof_handler.get_triangulation().n_active_cells());
+  std::vector<dealii::types::global_dof_index> dof_indices;
+  for (auto const &cell : dealii::filter_iterators(
+           dof_handler.active_cell_iterators(),
+           dealii::IteratorFilters::LocallyOwnedCell()))
+  {
+    float cell_max_temperature = std::numeric_limits<float>::lowest();
+    dof_indices.resize(cell->get_fe().n_dofs_per_cell());
+    cell->get_dof_indices(dof_indices);
+    for (auto const index : dof_indices)
+      cell_max_temperature =
+          std::max(cell_max_temperature,
+                   static_cast<float>(solution_host(index)));
+    max_temperature[cell->active_cell_index()] = cell_max_temperature;
+  }
+
+  return max_temperature;
+}
+
+// Flag for coarsening the cells whose temperature and rate of change of the
+// temperature have stayed below the thresholds of the
+// refinement.progressive_coarsening section for cooling_time seconds. A cell is
+// not coarsened below the minimum level of its layer. The layers are counted
+// from the top of the part downward. Return true if at least one cell was
+// flagged on any processor.
+template <int dim, typename MemorySpaceType>
+bool flag_cooled_cells(
+    dealii::DoFHandler<dim> const &dof_handler,
+    dealii::LA::distributed::Vector<double, MemorySpaceType> const &solution,
+    double const time, double const current_source_height,
+    boost::property_tree::ptree const &coarsening_database,
+    CoolingHistory &cooling_history)
+{
+  // PropertyTreeInput refinement.progressive_coarsening.temperature
+  double const max_temperature = coarsening_database.get<double>("temperature");
+  // PropertyTreeInput refinement.progressive_coarsening.temperature_rate
+  double const max_temperature_rate = coarsening_database.get(
+      "temperature_rate", std::numeric_limits<double>::infinity());
+  // PropertyTreeInput refinement.progressive_coarsening.cooling_time
+  double const cooling_time = coarsening_database.get("cooling_time", 0.);
+  // PropertyTreeInput refinement.progressive_coarsening.layer_thickness
+  double const layer_thickness =
+      coarsening_database.get<double>("layer_thickness");
+  // PropertyTreeInput refinement.progressive_coarsening.min_levels
+  std::vector<int> min_levels;
+  std::vector<std::string> min_levels_split;
+  std::string const min_levels_string =
+      coarsening_database.get<std::string>("min_levels", "0");
+  boost::split(min_levels_split, min_levels_string,
+               [](char c) { return c == ','; });
+  for (auto &level : min_levels_split)
+    min_levels.push_back(std::stoi(level));
+
+  dealii::Vector<float> const cell_temperatures =
+      compute_max_temperature_per_cell(dof_handler, solution);
+  double const elapsed_time = time - cooling_history.time;
+  bool flagged = false;
+  for (auto const &cell : dealii::filter_iterators(
+           dof_handler.active_cell_iterators(),
+           dealii::IteratorFilters::LocallyOwnedCell()))
+  {
+    unsigned int const cell_index = cell->active_cell_index();
+    double const temperature = cell_temperatures[cell_index];
+    double const previous_temperature =
+        cooling_history.temperatures[cell_index];
+    double const temperature_rate =
+        ((elapsed_time > 0.) &&
+         (previous_temperature > std::numeric_limits<double>::lowest()))
+            ? std::abs(temperature - previous_temperature) / elapsed_time
+            : 0.;
+    double &cooling_start_time =
+        cooling_history.cooling_start_times[cell_index];
+    if ((temperature < max_temperature) &&
+        (temperature_rate < max_temperature_rate))
+    {
+      if (!std::isfinite(cooling_start_time))
+        cooling_start_time = time;
+    }
+    else
+    {
+      cooling_start_time = std::numeric_limits<double>::infinity();
+    }
+    cooling_history.temperatures[cell_index] = temperature;
+
+    double const depth =
+        current_source_height - cell->center()[adamantine::axis<dim>::z];
+    unsigned int const layer =
+        depth > 0. ? static_cast<unsigned int>(depth / layer_thickness) : 0;
+    int const min_level =
+        min_levels[std::min<std::size_t>(layer, min_levels.size() - 1)];
+    if ((time - cooling_start_time >= cooling_time) &&
+        (cell->level() > min_level))
+    {
+      cell->set_coarsen_flag();
+      flagged = true;
+    }
+  }
+  cooling_history.time = time;
+
+  return dealii::Utilities::MPI::logical_or(
+      flagged, dof_handler.get_triangulation().get_communicator());
+}
+
 template <int dim, int fe_degree, typename MemorySpaceType>
 void refine_mesh(
     std::unique_ptr<adamantine::ThermalPhysicsInterface<dim, MemorySpaceType>>
@@ -630,7 +940,8 @@ void refine_mesh(
     std::vector<std::shared_ptr<adamantine::HeatSource<dim>>> &heat_sources,
     double const time, double const next_refinement_time,
     unsigned int const time_steps_refinement,
-    boost::property_tree::ptree const &refinement_database)
+    boost::property_tree::ptree const &refinement_database,
+    CoolingHistory &cooling_history)
 {
 #ifdef ADAMANTINE_WITH_CALIPER
   CALI_CXX_MARK_FUNCTION;
@@ -660,12 +971,44 @@ void refine_mesh(
   // PropertyTreeInput refinement.beam_cutoff
   const double refinement_beam_cutoff =
       refinement_database.get<double>("beam_cutoff", 1.0e-15);
+  // Cells hotter than coarsening_temperature and cells that the beams have
+  // crossed during the last coarsening_delay seconds are not coarsened. This
+  // avoids coarsening and refining the same cells repeatedly.
+  // PropertyTreeInput refinement.coarsening_temperature
+  double const coarsening_temperature = refinement_database.get(
+      "coarsening_temperature", std::numeric_limits<double>::infinity());
+  // PropertyTreeInput refinement.coarsening_delay
+  double const coarsening_delay =
+      refinement_database.get("coarsening_delay", 0.);
+
+  // The history is empty the first time the mesh is refined.
+  if (cooling_history.temperatures.size() != triangulation.n_active_cells())
+  {
+    cooling_history.cooling_start_times.assign(
+        triangulation.n_active_cells(),
+        std::numeric_limits<double>::infinity());
+    cooling_history.temperatures.assign(triangulation.n_active_cells(),
+                                        std::numeric_limits<double>::lowest());
+  }
+
+  // The gradient jump indicator is computed using the matrix-free data of the
+  // thermal operator. It is cheaper than the Kelly error estimator and it can
+  // ignore the cold part of the domain.
+  // PropertyTreeInput refinement.error_estimator
+  std::string const error_estimator =
+      refinement_database.get<std::string>("error_estimator", "kelly");
+  // PropertyTreeInput refinement.error_estimator_min_temperature
+  double const error_estimator_min_temperature = refinement_database.get(
+      "error_estimator_min_temperature", std::numeric_limits<double>::lowest());
 
   for (unsigned int i = 0; i < n_kelly_refinements; ++i)
   {
     // Estimate the error. For simplicity, always use dealii::QGauss
     dealii::Vector<float> estimated_error_per_cell =
-        estimate_error(triangulation, dof_handler, fe_degree, solution);
+        (error_estimator == "gradient_jump")
+            ? thermal_physics->compute_refinement_indicator(
+                  solution, error_estimator_min_temperature)
+            : estimate_error(triangulation, dof_handler, fe_degree, solution);
 
     // Flag the cells for refinement.
     unsigned int new_n_cells = static_cast<unsigned int>(
@@ -684,7 +1027,7 @@ void refine_mesh(
 
     // Execute the refinement and transfer the solution onto the new mesh.
     refine_and_transfer(thermal_physics, material_properties, dof_handler,
-                        solution);
+                        solution, cooling_history);
   }
 
   // Refine the mesh along the trajectory of the sources.
@@ -701,6 +1044,18 @@ void refine_mesh(
                 thermal_physics.get())
                 ->get_current_source_height();
 
+  // Progressively coarsen the cells that have cooled down.
+  // PropertyTreeInput refinement.progressive_coarsening
+  boost::optional<boost::property_tree::ptree const &> coarsening_database =
+      refinement_database.get_child_optional("progressive_coarsening");
+  if (coarsening_database &&
+      flag_cooled_cells(dof_handler, solution, time, current_source_height,
+                        coarsening_database.get(), cooling_history))
+  {
+    refine_and_transfer(thermal_physics, material_properties, dof_handler,
+                        solution, cooling_history);
+  }
+
   for (unsigned int i = 0; i < n_beam_refinements; ++i)
   {
     // Compute the cells to be refined.
@@ -714,16 +1069,33 @@ void refine_mesh(
     const bool coarsen_after_beam =
         refinement_database.get<bool>("coarsen_after_beam", false);
 
-    // If coarsening is allowed, set the coarsening flag everywhere
+    // If coarsening is allowed, set the coarsening flag everywhere except on
+    // the cells that are still hot.
     if (coarsen_after_beam)
     {
+      dealii::Vector<float> const max_temperature =
+          std::isfinite(coarsening_temperature)
+              ? compute_max_temperature_per_cell(dof_handler, solution)
+              : dealii::Vector<float>();
       for (auto cell : dealii::filter_iterators(
                triangulation.active_cell_iterators(),
                dealii::IteratorFilters::LocallyOwnedCell()))
       {
-        if (cell->level() > 0)
+        if ((cell->level() > 0) &&
+            ((max_temperature.size() == 0) ||
+             (max_temperature[cell->active_cell_index()] <
+              coarsening_temperature)))
           cell->set_coarsen_flag();
       }
+
+      if (coarsening_delay > 0.)
+      {
+        for (auto &cell : compute_cells_to_refine(
+                 triangulation, std::max(time - coarsening_delay, 0.), time,
+                 time_steps_refinement, heat_sources, current_source_height,
+                 refinement_beam_cutoff))
+          cell->clear_coarsen_flag();
+      }
     }
 
     // Flag the cells for refinement.
@@ -737,7 +1109,7 @@ void refine_mesh(
 
     // Execute the refinement and transfer the solution onto the new mesh.
     refine_and_transfer(thermal_physics, material_properties, dof_handler,
-                        solution);
+                        solution, cooling_history);
   }
 
   // Recompute the inverse of the mass matrix
@@ -753,7 +1125,8 @@ void refine_mesh(
     std::vector<std::shared_ptr<adamantine::HeatSource<dim>>> &heat_sources,
     double const time, double const next_refinement_time,
     unsigned int const time_steps_refinement,
-    boost::property_tree::ptree const &refinement_database)
+    boost::property_tree::ptree const &refinement_database,
+    CoolingHistory &cooling_history)
 {
   if (!thermal_physics)
     return;
@@ -764,70 +1137,80 @@ void refine_mesh(
   {
     refine_mesh<dim, 1>(thermal_physics, material_properties, solution,
                         heat_sources, time, next_refinement_time,
-                        time_steps_refinement, refinement_database);
+                        time_steps_refinement, refinement_database,
+                        cooling_history);
     break;
   }
   case 2:
   {
     refine_mesh<dim, 2>(thermal_physics, material_properties, solution,
                         heat_sources, time, next_refinement_time,
-                        time_steps_refinement, refinement_database);
+                        time_steps_refinement, refinement_database,
+                        cooling_history);
     break;
   }
   case 3:
   {
     refine_mesh<dim, 3>(thermal_physics, material_properties, solution,
                         heat_sources, time, next_refinement_time,
-                        time_steps_refinement, refinement_database);
+                        time_steps_refinement, refinement_database,
+                        cooling_history);
     break;
   }
   case 4:
   {
     refine_mesh<dim, 4>(thermal_physics, material_properties, solution,
                         heat_sources, time, next_refinement_time,
-                        time_steps_refinement, refinement_database);
+                        time_steps_refinement, refinement_database,
+                        cooling_history);
     break;
   }
   case 5:
   {
     refine_mesh<dim, 5>(thermal_physics, material_properties, solution,
                         heat_sources, time, next_refinement_time,
-                        time_steps_refinement, refinement_database);
+                        time_steps_refinement, refinement_database,
+                        cooling_history);
     break;
   }
   case 6:
   {
     refine_mesh<dim, 6>(thermal_physics, material_properties, solution,
                         heat_sources, time, next_refinement_time,
-                        time_steps_refinement, refinement_database);
+                        time_steps_refinement, refinement_database,
+                        cooling_history);
     break;
   }
   case 7:
   {
     refine_mesh<dim, 7>(thermal_physics, material_properties, solution,
                         heat_sources, time, next_refinement_time,
-                        time_steps_refinement, refinement_database);
+                        time_steps_refinement, refinement_database,
+                        cooling_history);
     break;
   }
   case 8:
   {
     refine_mesh<dim, 8>(thermal_physics, material_properties, solution,
                         heat_sources, time, next_refinement_time,
-                        time_steps_refinement, refinement_database);
+                        time_steps_refinement, refinement_database,
+                        cooling_history);
     break;
   }
   case 9:
   {
     refine_mesh<dim, 9>(thermal_physics, material_properties, solution,
                         heat_sources, time, next_refinement_time,
-                        time_steps_refinement, refinement_database);
+                        time_steps_refinement, refinement_database,
+                        cooling_history);
     break;
   }
   case 10:
   {
     refine_mesh<dim, 10>(thermal_physics, material_properties, solution,
                          heat_sources, time, next_refinement_time,
-                         time_steps_refinement, refinement_database);
+                         time_steps_refinement, refinement_database,
+                         cooling_history);
     break;
   }
   default:
@@ -837,6 +1220,205 @@ void refine_mesh(
   }
 }
 
+// Return true if the largest temperature @p max_temperature is less than the
+// threshold of the time_stepping.cooldown section and if the largest absolute
+// value of the rate of change of the temperature between @p old_time and @p
+// time is less than the threshold on the rate. The rate is computed from the
+// largest absolute value of the change of the temperature @p
+// max_temperature_change. If the part has cooled down and fast_forward is true,
+// the temperature is relaxed toward the ambient temperature up to @p duration
+// using an exponential decay. The time constant of the decay is given by the
+// ratio of the largest difference with the ambient temperature and of the
+// largest rate of change.
+template <typename MemorySpaceType>
+bool is_cooled_down(
+    dealii::LA::distributed::Vector<double, MemorySpaceType> &temperature,
+    double const max_temperature, double const max_temperature_change,
+    double const old_time, double const time, double const duration,
+    boost::property_tree::ptree const &cooldown_database,
+    double const ambient_temperature)
+{
+  // PropertyTreeInput time_stepping.cooldown.temperature
+  double const temperature_threshold =
+      cooldown_database.get<double>("temperature");
+  // PropertyTreeInput time_stepping.cooldown.temperature_rate
+  double const temperature_rate_threshold = cooldown_database.get(
+      "temperature_rate", std::numeric_limits<double>::infinity());
+  // PropertyTreeInput time_stepping.cooldown.fast_forward
+  bool const fast_forward = cooldown_database.get("fast_forward", false);
+
+  if (time <= old_time)
+    return false;
+
+  double const temperature_rate = max_temperature_change / (time - old_time);
+  if ((max_temperature >= temperature_threshold) ||
+      (temperature_rate >= temperature_rate_threshold))
+    return false;
+
+  if (fast_forward && (duration > time))
+  {
+    temperature.add(-ambient_temperature);
+    double const max_difference = temperature.linfty_norm();
+    if (max_difference > 0.)
+      temperature *=
+          std::exp(-(duration - time) * temperature_rate / max_difference);
+    temperature.add(ambient_temperature);
+  }
+
+  return true;
+}
+
+// Estimate the number of vectors of the size of the temperature that are
+// allocated by the time stepping scheme: the solution, the inverse of the mass
+// matrix, the stages of the Runge-Kutta method, a couple of temporaries, and
+// the Krylov basis of GMRES for the implicit methods.
+inline unsigned int
+estimate_n_work_vectors(boost::property_tree::ptree const &database)
+{
+  std::map<std::string, unsigned int> const n_stages = {
+      {"forward_euler", 1},  {"rk_third_order", 3},    {"rk_fourth_order", 4},
+      {"heun_euler", 2},     {"bogacki_shampine", 4},  {"dopri", 7},
+      {"fehlberg", 6},       {"cash_karp", 6},         {"backward_euler", 1},
+      {"sdirk2", 2},         {"implicit_midpoint", 1}, {"crank_nicolson", 2}};
+  // PropertyTreeInput time_stepping.method
+  std::string method = database.get<std::string>("time_stepping.method");
+  std::transform(method.begin(), method.end(), method.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  auto const stages = n_stages.find(method);
+  unsigned int n_work_vectors =
+      4 + (stages != n_stages.end() ? stages->second : 1);
+  if ((method == "backward_euler") || (method == "implicit_midpoint") ||
+      (method == "crank_nicolson") || (method == "sdirk2"))
+  {
+    // PropertyTreeInput time_stepping.n_tmp_vectors
+    n_work_vectors += database.get("time_stepping.n_tmp_vectors", 30) + 2;
+  }
+
+  return n_work_vectors;
+}
+
+// Add the memory used by the mesh, the material properties, and the thermal
+// simulation to @p memory_report. The vectors allocated by the time stepping
+// scheme are estimated from the size of the temperature.
+template <int dim, typename MemorySpaceType>
+void add_memory_consumption(
+    adamantine::MemoryReport &memory_report,
+    adamantine::Geometry<dim> &geometry,
+    adamantine::MaterialProperty<dim, MemorySpaceType> const
+        &material_properties,
+    std::unique_ptr<adamantine::ThermalPhysicsInterface<
+        dim, MemorySpaceType>> const &thermal_physics,
+    dealii::LA::distributed::Vector<double, MemorySpaceType> const &temperature,
+    unsigned int const n_work_vectors)
+{
+  memory_report.add("Triangulation",
+                    geometry.get_triangulation().memory_consumption());
+  memory_report.add("MaterialProperty",
+                    material_properties.memory_consumption());
+  if (thermal_physics)
+  {
+    thermal_physics->add_memory_consumption(memory_report);
+    memory_report.add("Temperature", temperature.memory_consumption());
+    // The temperature and the inverse of the mass matrix are already part of
+    // the report.
+    memory_report.add("Time stepping vectors",
+                      (n_work_vectors - 2) * temperature.memory_consumption());
+  }
+}
+
+// Refine the mesh up to the end of the next refinement window and condense
+// the material that has cooled down. @p next_refinement_time is set to the end
+// of the window and the distance traveled by the beams is reset. This step is
+// shared by run() and dry_run().
+template <int dim, typename MemorySpaceType>
+void adapt_mesh(
+    std::unique_ptr<adamantine::ThermalPhysicsInterface<dim, MemorySpaceType>>
+        &thermal_physics,
+    adamantine::MaterialProperty<dim, MemorySpaceType> &material_properties,
+    dealii::LA::distributed::Vector<double, MemorySpaceType> &temperature,
+    std::vector<std::shared_ptr<adamantine::HeatSource<dim>>> &heat_sources,
+    double const time, double const time_step, double const duration,
+    unsigned int const time_steps_refinement,
+    boost::optional<double> const &beam_travel_distance,
+    double const lookahead_distance,
+    boost::property_tree::ptree const &refinement_database,
+    CoolingHistory &cooling_history, double &next_refinement_time,
+    double &beam_travel, std::vector<adamantine::Timer> &timers)
+{
+  unsigned int n_refinement_time_steps = 0;
+  std::tie(next_refinement_time, n_refinement_time_steps) =
+      compute_refinement_window(heat_sources, time, time_step, duration,
+                                time_steps_refinement, beam_travel_distance,
+                                lookahead_distance);
+  beam_travel = 0.;
+  timers[adamantine::refine].start();
+  refine_mesh(thermal_physics, material_properties, temperature, heat_sources,
+              time, next_refinement_time, n_refinement_time_steps,
+              refinement_database, cooling_history);
+  thermal_physics->condense_cooled_material(time, temperature, timers);
+  timers[adamantine::refine].stop();
+}
+
+// Activate the material deposited between @p time and the end of the next
+// activation window. Nothing is done until @p time is past @p
+// activation_time_end, which is then moved to the end of the new window. We
+// use an epsilon to get the "expected" behavior when the deposition time and
+// the time should match exactly but don't because of floating point accuracy.
+// Return true if material has been added. This step is shared by run() and
+// dry_run().
+template <int dim, typename MemorySpaceType>
+bool activate_material(
+    std::unique_ptr<adamantine::ThermalPhysicsInterface<dim, MemorySpaceType>>
+        &thermal_physics,
+    adamantine::SharedMemoryArray<dealii::BoundingBox<dim>> const
+        &material_deposition_boxes,
+    std::vector<double> const &deposition_times,
+    std::vector<double> const &deposition_cos,
+    std::vector<double> const &deposition_sin, double const time,
+    double const time_step, double const duration,
+    double const activation_time, double const new_material_temperature,
+    double &activation_time_end,
+    dealii::LA::distributed::Vector<double, MemorySpaceType> &temperature,
+    std::vector<adamantine::Timer> &timers)
+{
+  if (time <= activation_time_end)
+    return false;
+
+  double const eps = time_step / 1e12;
+  auto activation_start =
+      std::lower_bound(deposition_times.begin(), deposition_times.end(),
+                       time - eps) -
+      deposition_times.begin();
+  activation_time_end =
+      std::min(time + std::max(activation_time, time_step), duration) - eps;
+  auto activation_end =
+      std::lower_bound(deposition_times.begin(), deposition_times.end(),
+                       activation_time_end) -
+      deposition_times.begin();
+  if (activation_start >= activation_end)
+    return false;
+
+  // Compute the elements to activate.
+  // TODO Right now, we compute the list of cells that get activated for the
+  // entire material deposition. We should restrict the list to the cells that
+  // are activated between activation_start and activation_end.
+  timers[adamantine::add_material_search].start();
+  auto elements_to_activate = adamantine::get_elements_to_activate(
+      thermal_physics->get_dof_handler(), material_deposition_boxes);
+  timers[adamantine::add_material_search].stop();
+
+  // For now assume that all deposited material has never been melted (may or
+  // may not be reasonable)
+  std::vector<bool> has_melted(deposition_cos.size(), false);
+
+  thermal_physics->add_material(elements_to_activate, deposition_cos,
+                                deposition_sin, has_melted, activation_start,
+                                activation_end, new_material_temperature,
+                                temperature);
+
+  return true;
+}
+
 template <int dim, typename MemorySpaceType>
 std::pair<dealii::LinearAlgebra::distributed::Vector<double,
                                                      dealii::MemorySpace::Host>,
@@ -998,11 +1580,15 @@ run(MPI_Comm const &communicator, boost::property_tree::ptree const &database,
               mechanical_physics, displacement, material_properties, timers);
   ++n_time_step;
 
-  // Create the bounding boxes used for material deposition
+  // Create the bounding boxes used for material deposition. The boxes are
+  // shared by the processors of the node and they are freed collectively when
+  // they go out of scope.
   auto [material_deposition_boxes, deposition_times, deposition_cos,
         deposition_sin] =
-      adamantine::create_material_deposition_boxes<dim>(geometry_database,
-                                                        heat_sources);
+      adamantine::create_material_deposition_boxes<dim>(
+          communicator, geometry_database, heat_sources);
+  adamantine::check_symmetry_plane(geometry_database, heat_sources,
+                                   material_deposition_boxes);
   // Extract the time-stepping database
   boost::property_tree::ptree time_stepping_database =
       database.get_child("time_stepping");
@@ -1017,15 +1603,109 @@ run(MPI_Comm const &communicator, boost::property_tree::ptree const &database,
   // PropertyTreeInput refinement.time_steps_between_refinement
   unsigned int const time_steps_refinement =
       refinement_database.get("time_steps_between_refinement", 10);
+  // PropertyTreeInput refinement.beam_travel_distance
+  boost::optional<double> const beam_travel_distance =
+      refinement_database.get_optional<double>("beam_travel_distance");
+  // PropertyTreeInput refinement.lookahead_distance
+  double const lookahead_distance = refinement_database.get(
+      "lookahead_distance", 2. * beam_travel_distance.get_value_or(0.));
   // PropertyTreeInput post_processor.time_steps_between_output
   unsigned int const time_steps_output =
       post_processor_database.get("time_steps_between_output", 1);
 
   double next_refinement_time = time;
+  // Distance traveled by the beams since the last refinement.
+  double beam_travel = 0.;
+  std::vector<dealii::Point<3>> beam_positions;
+  compute_beam_displacement(heat_sources, beam_positions, time);
+  CoolingHistory cooling_history;
   // PropertyTreeInput materials.new_material_temperature
   double const new_material_temperature =
       database.get("materials.new_material_temperature", 300.);
 
+  // Once the beams have stopped and all the material has been deposited, the
+  // simulation stops as soon as the part has cooled down.
+  boost::optional<boost::property_tree::ptree const &> cooldown_database =
+      time_stepping_database.get_child_optional("cooldown");
+  double cooldown_start_time = std::numeric_limits<double>::infinity();
+  // PropertyTreeInput time_stepping.cooldown.ambient_temperature
+  double const ambient_temperature =
+      cooldown_database
+          ? cooldown_database->get("ambient_temperature", initial_temperature)
+          : initial_temperature;
+  dealii::LA::distributed::Vector<double, MemorySpaceType> old_temperature;
+  if (cooldown_database && use_thermal_physics)
+  {
+    cooldown_start_time = deposition_times.empty()
+                              ? std::numeric_limits<double>::lowest()
+                              : deposition_times.back();
+    for (auto const &source : heat_sources)
+    {
+      auto const &segment_list = source->get_scan_path().get_segment_list();
+      if (!segment_list.empty())
+        cooldown_start_time =
+            std::max(cooldown_start_time, segment_list.back().end_time);
+    }
+  }
+
+  // Open the file where the solver and throughput counters are written. The
+  // counters are global so only rank 0 writes them.
+  // PropertyTreeInput profiling.counters_file
+  boost::optional<std::string> counters_filename =
+      database.get_optional<std::string>("profiling.counters_file");
+  std::ofstream counters_file;
+  if (counters_filename && use_thermal_physics &&
+      (dealii::Utilities::MPI::this_mpi_process(communicator) == 0))
+  {
+    counters_file.open(counters_filename.get());
+    adamantine::Counters::write_csv_header(counters_file);
+  }
+
+  // Report the memory used by the different subsystems every time the mesh
+  // changes.
+  // PropertyTreeInput profiling.memory_report
+  bool const print_memory_report =
+      database.get("profiling.memory_report", false);
+  adamantine::MemoryReport memory_report(communicator);
+  unsigned int const n_work_vectors =
+      use_thermal_physics ? estimate_n_work_vectors(database) : 0;
+  auto report_memory = [&](std::string const &event)
+  {
+    add_memory_consumption(memory_report, geometry, material_properties,
+                           thermal_physics, temperature, n_work_vectors);
+    if (use_mechanical_physics)
+    {
+      memory_report.add("MechanicalPhysics",
+                        mechanical_physics->memory_consumption());
+      memory_report.add("Displacement", displacement.memory_consumption());
+    }
+    memory_report.print(std::cout, event);
+  };
+  if (print_memory_report)
+    report_memory("after initialization");
+
+  // The steady state in the frame of the heat sources replaces the transient
+  // simulation.
+  // PropertyTreeInput time_stepping.quasi_steady.time
+  boost::optional<double> const quasi_steady_time =
+      time_stepping_database.get_optional<double>("quasi_steady.time");
+  if (quasi_steady_time && use_thermal_physics)
+  {
+    time = quasi_steady_time.get();
+    unsigned int const n_newton_iterations =
+        thermal_physics->solve_quasi_steady_state(time, temperature, timers);
+    if (dealii::Utilities::MPI::this_mpi_process(communicator) == 0)
+      std::cout << "Quasi-steady state computed in " << n_newton_iterations
+                << " Newton iterations" << std::endl;
+    thermal_physics->set_state_to_material_properties();
+    output_pvtu(*post_processor, n_time_step, time, thermal_physics,
+                temperature, mechanical_physics, displacement,
+                material_properties, timers);
+    ++n_time_step;
+    // Skip the time loop.
+    time = std::max(time, duration);
+  }
+
 #ifdef ADAMANTINE_WITH_CALIPER
   CALI_CXX_MARK_LOOP_BEGIN(main_loop_id, "main_loop");
 #endif
@@ -1038,95 +1718,141 @@ run(MPI_Comm const &communicator, boost::property_tree::ptree const &database,
       time_step = duration - time;
     unsigned int rank = dealii::Utilities::MPI::this_mpi_process(communicator);
 
-    // Refine the mesh after time_steps_refinement time steps or when time
-    // is greater or equal than the next predicted time for refinement. This
-    // is necessary when using an embedded method.
-    if ((((n_time_step % time_steps_refinement) == 0) ||
-         (time >= next_refinement_time)) &&
+    if (use_thermal_physics)
+      thermal_physics->get_counters().reset();
+
+    // Refine the mesh after time_steps_refinement time steps, or after the
+    // beams have traveled beam_travel_distance, or when time is greater or
+    // equal than the next predicted time for refinement. The last condition is
+    // necessary when using an embedded method.
+    if (need_refinement(n_time_step, time, next_refinement_time,
+                        time_steps_refinement, beam_travel_distance,
+                        beam_travel) &&
         use_thermal_physics)
     {
-      next_refinement_time = time + time_steps_refinement * time_step;
-      timers[adamantine::refine].start();
-      refine_mesh(thermal_physics, material_properties, temperature,
-                  heat_sources, time, next_refinement_time,
-                  time_steps_refinement, refinement_database);
-      timers[adamantine::refine].stop();
+      adapt_mesh(thermal_physics, material_properties, temperature,
+                 heat_sources, time, time_step, duration, time_steps_refinement,
+                 beam_travel_distance, lookahead_distance, refinement_database,
+                 cooling_history, next_refinement_time, beam_travel, timers);
       if ((rank == 0) && (verbose_output == true))
         std::cout << "n_dofs: " << thermal_physics->get_dof_handler().n_dofs()
                   << std::endl;
+      if (print_memory_report)
+        report_memory("after refinement");
     }
 
     // Add material if necessary.
-    // We use an epsilon to get the "expected" behavior when the deposition
-    // time and the time match should match exactly but don't because of
-    // floating point accuracy.
     timers[adamantine::add_material_activate].start();
-    if (time > activation_time_end)
+    if (use_thermal_physics &&
+        activate_material(thermal_physics, material_deposition_boxes,
+                          deposition_times, deposition_cos, deposition_sin,
+                          time, time_step, duration, activation_time,
+                          new_material_temperature, activation_time_end,
+                          temperature, timers))
     {
-      double const eps = time_step / 1e12;
-      auto activation_start =
-          std::lower_bound(deposition_times.begin(), deposition_times.end(),
-                           time - eps) -
-          deposition_times.begin();
-      activation_time_end =
-          std::min(time + std::max(activation_time, time_step), duration) - eps;
-      auto activation_end =
-          std::lower_bound(deposition_times.begin(), deposition_times.end(),
-                           activation_time_end) -
-          deposition_times.begin();
-      if (activation_start < activation_end)
-      {
-        if (use_thermal_physics)
-        {
-          // Compute the elements to activate.
-          // TODO Right now, we compute the list of cells that get activated for
-          // the entire material deposition. We should restrict the list to the
-          // cells that are activated between activation_start and
-          // activation_end.
-          timers[adamantine::add_material_search].start();
-          auto elements_to_activate = adamantine::get_elements_to_activate(
-              thermal_physics->get_dof_handler(), material_deposition_boxes);
-
-          timers[adamantine::add_material_search].stop();
-
-          // For now assume that all deposited material has never been melted
-          // (may or may not be reasonable)
-          std::vector<bool> has_melted(deposition_cos.size(), false);
-
-          thermal_physics->add_material(elements_to_activate, deposition_cos,
-                                        deposition_sin, has_melted,
-                                        activation_start, activation_end,
-                                        new_material_temperature, temperature);
-        }
-      }
-
-      if ((rank == 0) && (verbose_output == true) &&
-          (activation_end - activation_start > 0) && use_thermal_physics)
-      {
+      if ((rank == 0) && (verbose_output == true))
         std::cout << "n_dofs: " << thermal_physics->get_dof_handler().n_dofs()
                   << std::endl;
-      }
+      if (print_memory_report)
+        report_memory("after material deposition");
     }
     timers[adamantine::add_material_activate].stop();
 
-    // If thermomechanics are being solved, mark cells that are above the
-    // solidus as cells that should have their reference temperature reset.
-    // This cannot be in the thermomechanics solve because some cells may go
-    // above the solidus and then back below the solidus in the time between
-    // thermomechanical solves.
-    if (use_thermal_physics && use_mechanical_physics)
-    {
-      thermal_physics->mark_has_melted(material_reference_temps[0],
-                                       temperature);
-    }
-
     timers[adamantine::evol_time].start();
 
     // Solve the thermal problem
+    bool cooled_down = false;
     if (use_thermal_physics)
     {
+      bool const check_cooldown = time >= cooldown_start_time;
+      double const old_time = time;
+      if (check_cooldown)
+      {
+        if (old_temperature.get_partitioner() != temperature.get_partitioner())
+          old_temperature.reinit(temperature.get_partitioner());
+        old_temperature = temperature;
+      }
       time = thermal_physics->evolve_one_time_step(time, time_step, temperature,
                                                    timers);
+      if (beam_travel_distance)
+        beam_travel +=
+            compute_beam_displacement(heat_sources, beam_positions, time);
+
+      // Mark the cells that are above the solidus as cells that should have
+      // their reference temperature reset. This cannot be in the
+      // thermomechanics solve because some cells may go above the solidus and
+      // then back below the solidus in the time between thermomechanical
+      // solves. On the host, the cells are marked during a single pass over
+      // the temperature that also computes the diagnostics of the step and the
+      // quantities needed to check the cool-down.
+      double max_temperature = std::numeric_limits<double>::max();
+      double max_temperature_change = std::numeric_limits<double>::max();
+      if (check_cooldown)
+        old_temperature.sadd(-1., 1., temperature);
+      if constexpr (std::is_same_v<MemorySpaceType, dealii::MemorySpace::Host>)
+      {
+        adamantine::CellDiagnostics<dim> diagnostics(
+            material_reference_temps[0]);
+        dealii::Vector<double> cell_change;
+        if (check_cooldown)
+        {
+          // The change of the temperature is reduced with the other
+          // diagnostics.
+          old_temperature.update_ghost_values();
+          diagnostics.add(
+              "max_temperature_change",
+              adamantine::CellDiagnostics<dim>::Reduction::max,
+              [&](typename adamantine::CellDiagnostics<dim>::CellValues const
+                      &cell_values)
+              {
+                cell_change.reinit(
+                    cell_values.cell->get_fe().n_dofs_per_cell());
+                cell_values.cell->get_dof_values(old_temperature, cell_change);
+                return cell_change.linfty_norm();
+              });
+        }
+        thermal_physics->compute_cell_diagnostics(temperature, diagnostics);
+        if (check_cooldown)
+        {
+          old_temperature.zero_out_ghost_values();
+          max_temperature = diagnostics.get("max_temperature");
+          max_temperature_change = diagnostics.get("max_temperature_change");
+        }
+        if ((rank == 0) && (verbose_output == true))
+        {
+          std::cout << "Maximum temperature: "
+                    << diagnostics.get("max_temperature")
+                    << " Melt pool volume: "
+                    << diagnostics.get("melt_pool_volume") << std::endl;
+        }
+      }
+      else
+      {
+        if (use_mechanical_physics)
+          thermal_physics->mark_has_melted(material_reference_temps[0],
+                                           temperature);
+        if (check_cooldown)
+        {
+          max_temperature = temperature.linfty_norm();
+          max_temperature_change = old_temperature.linfty_norm();
+        }
+      }
+
+      if (check_cooldown)
+      {
+        cooled_down = is_cooled_down(
+            temperature, max_temperature, max_temperature_change, old_time,
+            time, duration, cooldown_database.get(), ambient_temperature);
+        if (cooled_down)
+        {
+          if (rank == 0)
+            std::cout << "The part has cooled down at time " << time << " s"
+                      << std::endl;
+          // PropertyTreeInput time_stepping.cooldown.fast_forward
+          if (cooldown_database->get("fast_forward", false))
+            time = std::max(time, duration);
+        }
+      }
     }
 
     // Solve the (thermo-)mechanical problem
@@ -1134,7 +1860,7 @@ run(MPI_Comm const &communicator, boost::property_tree::ptree const &database,
     {
       // Since there is no history dependence in the model, only calculate
       // mechanics when outputting
-      if (n_time_step % time_steps_output == 0)
+      if ((n_time_step % time_steps_output == 0) || cooled_down)
       {
         if (use_thermal_physics)
         {
@@ -1152,11 +1878,23 @@ run(MPI_Comm const &communicator, boost::property_tree::ptree const &database,
           mechanical_physics->setup_dofs();
         }
         displacement = mechanical_physics->solve();
+        if (use_thermal_physics)
+        {
+          thermal_physics->get_counters().increment(
+              adamantine::cg_iterations,
+              mechanical_physics->get_n_solver_iterations());
+        }
       }
     }
 
     timers[adamantine::evol_time].stop();
 
+    if (counters_file.is_open())
+    {
+      thermal_physics->get_counters().write_csv_row(counters_file, n_time_step,
+                                                    time);
+    }
+
     // Get the new time step
     if (use_thermal_physics)
     {
@@ -1180,8 +1918,9 @@ run(MPI_Comm const &communicator, boost::property_tree::ptree const &database,
       }
     }
 
-    // Output the solution
-    if (n_time_step % time_steps_output == 0)
+    // Output the solution. The final state is always written when the part
+    // has cooled down.
+    if ((n_time_step % time_steps_output == 0) || cooled_down)
     {
       if (use_thermal_physics)
       {
@@ -1192,6 +1931,9 @@ run(MPI_Comm const &communicator, boost::property_tree::ptree const &database,
                   material_properties, timers);
     }
     ++n_time_step;
+
+    if (cooled_down)
+      break;
   }
 #ifdef ADAMANTINE_WITH_CALIPER
   CALI_CXX_MARK_LOOP_END(main_loop_id);
@@ -1199,6 +1941,9 @@ run(MPI_Comm const &communicator, boost::property_tree::ptree const &database,
 
   post_processor->write_pvd();
 
+  if (print_memory_report)
+    memory_report.print_high_water_marks(std::cout);
+
   // This is only used for integration test
   if constexpr (std::is_same_v<MemorySpaceType, dealii::MemorySpace::Host>)
   {
@@ -1230,6 +1975,213 @@ run(MPI_Comm const &communicator, boost::property_tree::ptree const &database,
   }
 }
 
+// Walk the scan path and the material deposition schedule without solving the
+// heat equation. Only the mesh refinement along the beams and the material
+// activation are performed. A timeline of the size of the problem and of the
+// memory used per processor is printed every time the mesh changes. The
+// function returns the largest number of degrees of freedom and the largest
+// number of active cells reached during the simulation, the number of times the
+// mesh was refined, and the number of degrees of freedom at the end of the
+// simulation.
+template <int dim, typename MemorySpaceType>
+std::tuple<unsigned long long, unsigned long long, unsigned int,
+           unsigned long long>
+dry_run(MPI_Comm const &communicator,
+        boost::property_tree::ptree const &database,
+        std::vector<adamantine::Timer> &timers)
+{
+#ifdef ADAMANTINE_WITH_CALIPER
+  CALI_CXX_MARK_FUNCTION;
+#endif
+
+  // Extract the physics property tree
+  boost::property_tree::ptree physics_database = database.get_child("physics");
+  adamantine::ASSERT_THROW(physics_database.get<bool>("thermal"),
+                           "Error: The dry run requires thermal physics.");
+
+  // Create the Geometry
+  boost::property_tree::ptree geometry_database =
+      database.get_child("geometry");
+  adamantine::Geometry<dim> geometry(communicator, geometry_database);
+
+  // Create the MaterialProperty
+  boost::property_tree::ptree material_database =
+      database.get_child("materials");
+  adamantine::MaterialProperty<dim, MemorySpaceType> material_properties(
+      communicator, geometry.get_triangulation(), material_database);
+
+  // Create ThermalPhysics
+  boost::property_tree::ptree discretization_database =
+      database.get_child("discretization");
+  // PropertyTreeInput discretization.thermal.fe_degree
+  unsigned int const fe_degree =
+      discretization_database.get<unsigned int>("thermal.fe_degree");
+  // PropertyTreeInput discretization.thermal.quadrature
+  std::string quadrature_type =
+      discretization_database.get("thermal.quadrature", "gauss");
+  std::unique_ptr<adamantine::ThermalPhysicsInterface<dim, MemorySpaceType>>
+      thermal_physics = initialize_thermal_physics<dim>(
+          fe_degree, quadrature_type, communicator, database, geometry,
+          material_properties);
+  std::vector<std::shared_ptr<adamantine::HeatSource<dim>>> heat_sources =
+      thermal_physics->get_heat_sources();
+
+  // The temperature is never computed, it only carries the size of the problem
+  // during the refinement, the condensation, and the activation. The
+  // condensation thus treats the material as if it were at the initial
+  // temperature.
+  // PropertyTreeInput materials.initial_temperature
+  double const initial_temperature =
+      material_database.get("initial_temperature", 300.);
+  dealii::LA::distributed::Vector<double, MemorySpaceType> temperature;
+  thermal_physics->setup_dofs();
+  thermal_physics->update_material_deposition_orientation();
+  thermal_physics->compute_inverse_mass_matrix();
+  thermal_physics->initialize_dof_vector(initial_temperature, temperature);
+  thermal_physics->get_state_from_material_properties();
+
+  // Create the bounding boxes used for material deposition. The boxes are
+  // shared by the processors of the node and they are freed collectively when
+  // they go out of scope.
+  auto [material_deposition_boxes, deposition_times, deposition_cos,
+        deposition_sin] =
+      adamantine::create_material_deposition_boxes<dim>(
+          communicator, geometry_database, heat_sources);
+  adamantine::check_symmetry_plane(geometry_database, heat_sources,
+                                   material_deposition_boxes);
+  // PropertyTreeInput geometry.deposition_time
+  double const activation_time =
+      geometry_database.get<double>("deposition_time", 0.);
+  // PropertyTreeInput materials.new_material_temperature
+  double const new_material_temperature =
+      database.get("materials.new_material_temperature", 300.);
+
+  // Extract the time-stepping database. Without a solve, adaptive time
+  // stepping cannot predict the next time step so the initial one is used
+  // throughout.
+  boost::property_tree::ptree time_stepping_database =
+      database.get_child("time_stepping");
+  // PropertyTreeInput time_stepping.time_step
+  double time_step = time_stepping_database.get<double>("time_step");
+  // PropertyTreeInput time_stepping.duration
+  double const duration = time_stepping_database.get<double>("duration");
+
+  // Extract the refinement database. The refinement based on the Kelly error
+  // estimator requires the temperature so it is skipped.
+  boost::property_tree::ptree refinement_database =
+      database.get_child("refinement");
+  refinement_database.put("n_heat_refinements", 0);
+  // PropertyTreeInput refinement.time_steps_between_refinement
+  unsigned int const time_steps_refinement =
+      refinement_database.get("time_steps_between_refinement", 10);
+  // PropertyTreeInput refinement.beam_travel_distance
+  boost::optional<double> const beam_travel_distance =
+      refinement_database.get_optional<double>("beam_travel_distance");
+  // PropertyTreeInput refinement.lookahead_distance
+  double const lookahead_distance = refinement_database.get(
+      "lookahead_distance", 2. * beam_travel_distance.get_value_or(0.));
+
+  unsigned int const n_work_vectors = estimate_n_work_vectors(database);
+  unsigned int const rank =
+      dealii::Utilities::MPI::this_mpi_process(communicator);
+  unsigned long long max_n_dofs = 0;
+  unsigned long long max_n_cells = 0;
+  unsigned int n_refinements = 0;
+  double max_memory = 0.;
+  // Print the size of the problem and the memory used by the processor that
+  // uses the most memory. The memory is the resident set size of the dry run,
+  // which contains the mesh, the DoFHandler, and the MatrixFree data, plus the
+  // vectors allocated by the time stepping scheme.
+  auto report = [&](unsigned int n_time_step, double time)
+  {
+    adamantine::Counters const &counters = thermal_physics->get_counters();
+    unsigned long long const n_dofs = counters.get(adamantine::n_active_dofs);
+    unsigned long long const n_cells =
+        counters.get(adamantine::n_active_cells);
+    dealii::Utilities::System::MemoryStats memory_stats;
+    dealii::Utilities::System::get_memory_stats(memory_stats);
+    double const vectors_memory =
+        static_cast<double>(n_work_vectors) *
+        thermal_physics->get_dof_handler().n_locally_owned_dofs() *
+        sizeof(double) / 1e6;
+    double const memory = dealii::Utilities::MPI::max(
+        memory_stats.VmRSS / 1e3 + vectors_memory, communicator);
+    max_n_dofs = std::max(max_n_dofs, n_dofs);
+    max_n_cells = std::max(max_n_cells, n_cells);
+    max_memory = std::max(max_memory, memory);
+    if (rank == 0)
+      std::cout << std::setw(10) << n_time_step << std::setw(14) << time
+                << std::setw(14) << n_dofs << std::setw(14) << n_cells
+                << std::setw(14) << memory << std::endl;
+  };
+
+  if (rank == 0)
+    std::cout << std::setw(10) << "time_step" << std::setw(14) << "time"
+              << std::setw(14) << "n_dofs" << std::setw(14) << "n_cells"
+              << std::setw(14) << "memory [MB]" << std::endl;
+  report(0, 0.);
+
+  unsigned int n_time_step = 1;
+  double time = 0.;
+  double activation_time_end = -1.;
+  double next_refinement_time = time;
+  double beam_travel = 0.;
+  std::vector<dealii::Point<3>> beam_positions;
+  compute_beam_displacement(heat_sources, beam_positions, time);
+  CoolingHistory cooling_history;
+  while (time < duration)
+  {
+    if ((time + time_step) > duration)
+      time_step = duration - time;
+    bool mesh_changed = false;
+
+    if (need_refinement(n_time_step, time, next_refinement_time,
+                        time_steps_refinement, beam_travel_distance,
+                        beam_travel))
+    {
+      adapt_mesh(thermal_physics, material_properties, temperature,
+                 heat_sources, time, time_step, duration, time_steps_refinement,
+                 beam_travel_distance, lookahead_distance, refinement_database,
+                 cooling_history, next_refinement_time, beam_travel, timers);
+      ++n_refinements;
+      mesh_changed = true;
+    }
+
+    timers[adamantine::add_material_activate].start();
+    if (activate_material(thermal_physics, material_deposition_boxes,
+                          deposition_times, deposition_cos, deposition_sin,
+                          time, time_step, duration, activation_time,
+                          new_material_temperature, activation_time_end,
+                          temperature, timers))
+      mesh_changed = true;
+    timers[adamantine::add_material_activate].stop();
+
+    time += time_step;
+    if (beam_travel_distance)
+      beam_travel +=
+          compute_beam_displacement(heat_sources, beam_positions, time);
+    if (mesh_changed)
+      report(n_time_step, time);
+    ++n_time_step;
+  }
+
+  if (rank == 0)
+  {
+    std::cout << "Number of time steps: " << n_time_step - 1 << std::endl;
+    std::cout << "Maximum number of degrees of freedom: " << max_n_dofs
+              << std::endl;
+    std::cout << "Maximum number of active cells: " << max_n_cells
+              << std::endl;
+    std::cout << "Maximum memory per processor: " << max_memory << " MB"
+              << std::endl;
+    std::cout << "Number of refinements: " << n_refinements << std::endl;
+  }
+
+  unsigned long long const n_dofs = thermal_physics->get_dof_handler().n_dofs();
+
+  return std::make_tuple(max_n_dofs, max_n_cells, n_refinements, n_dofs);
+}
+
 template <int dim, typename MemorySpaceType>
 std::vector<dealii::LA::distributed::BlockVector<double>>
 run_ensemble(MPI_Comm const &communicator,
@@ -1584,7 +2536,18 @@ run_ensemble(MPI_Comm const &communicator,
   // PropertyTreeInput refinement.time_steps_between_refinement
   unsigned int const time_steps_refinement =
       refinement_database.get("time_steps_between_refinement", 10);
+  // PropertyTreeInput refinement.beam_travel_distance
+  boost::optional<double> const beam_travel_distance =
+      refinement_database.get_optional<double>("beam_travel_distance");
+  // PropertyTreeInput refinement.lookahead_distance
+  double const lookahead_distance = refinement_database.get(
+      "lookahead_distance", 2. * beam_travel_distance.get_value_or(0.));
   double next_refinement_time = time;
+  // Distance traveled by the beams since the last refinement.
+  double beam_travel = 0.;
+  std::vector<dealii::Point<3>> beam_positions;
+  compute_beam_displacement(heat_sources_ensemble[0], beam_positions, time);
+  std::vector<CoolingHistory> cooling_history_ensemble(ensemble_size);
   // PropertyTreeInput time_stepping.time_step
   double time_step = time_stepping_database.get<double>("time_step");
   // PropertyTreeInput time_stepping.duration
@@ -1596,11 +2559,15 @@ run_ensemble(MPI_Comm const &communicator,
   // ----- Deposit material -----
   // For now assume that all ensemble members share the same geometry (they
   // have independent adamantine::Geometry objects, but all are constructed
-  // from identical parameters), base new additions on the 0th ensemble member
+  // from identical parameters), base new additions on the 0th ensemble member.
+  // The boxes are shared by the members and by the processors of the node.
+  // They are freed collectively when they go out of scope.
   auto [material_deposition_boxes, deposition_times, deposition_cos,
         deposition_sin] =
       adamantine::create_material_deposition_boxes<dim>(
-          geometry_database, heat_sources_ensemble[0]);
+          communicator, geometry_database, heat_sources_ensemble[0]);
+  adamantine::check_symmetry_plane(geometry_database, heat_sources_ensemble[0],
+                                   material_deposition_boxes);
 
   timers[adamantine::add_material_search].start();
   std::vector<std::vector<
@@ -1615,6 +2582,29 @@ run_ensemble(MPI_Comm const &communicator,
   }
   timers[adamantine::add_material_search].stop();
 
+  // ----- Report the memory used by the ensemble -----
+  // PropertyTreeInput profiling.memory_report
+  bool const print_memory_report =
+      database.get("profiling.memory_report", false);
+  adamantine::MemoryReport memory_report(communicator);
+  unsigned int const n_work_vectors = estimate_n_work_vectors(database);
+  auto report_memory = [&](std::string const &event)
+  {
+    for (unsigned int member = 0; member < ensemble_size; ++member)
+    {
+      add_memory_consumption(
+          memory_report, *geometry_ensemble[member],
+          *material_properties_ensemble[member],
+          thermal_physics_ensemble[member],
+          solution_augmented_ensemble[member].block(base_state),
+          n_work_vectors);
+    }
+    memory_report.add("DataAssimilator", data_assimilator.memory_consumption());
+    memory_report.print(std::cout, event);
+  };
+  if (print_memory_report)
+    report_memory("after initialization");
+
   // ----- Main time stepping loop -----
   if (rank == 0)
     std::cout << "Starting the main time stepping loop..." << std::endl;
@@ -1631,13 +2621,21 @@ run_ensemble(MPI_Comm const &communicator,
       time_step = duration - time;
 
     // ----- Refine the mesh if necessary -----
-    // Refine the mesh after time_steps_refinement time steps or when time
-    // is greater or equal than the next predicted time for refinement. This
-    // is necessary when using an embedded method.
-    if (((n_time_step % time_steps_refinement) == 0) ||
-        (time >= next_refinement_time))
+    // Refine the mesh after time_steps_refinement time steps, or after the
+    // beams have traveled beam_travel_distance, or when time is greater or
+    // equal than the next predicted time for refinement. The last condition is
+    // necessary when using an embedded method. All the ensemble members
+    // follow the same scan path.
+    if (need_refinement(n_time_step, time, next_refinement_time,
+                        time_steps_refinement, beam_travel_distance,
+                        beam_travel))
     {
-      next_refinement_time = time + time_steps_refinement * time_step;
+      unsigned int n_refinement_time_steps = 0;
+      std::tie(next_refinement_time, n_refinement_time_steps) =
+          compute_refinement_window(heat_sources_ensemble[0], time, time_step,
+                                    duration, time_steps_refinement,
+                                    beam_travel_distance, lookahead_distance);
+      beam_travel = 0.;
       timers[adamantine::refine].start();
 
       for (unsigned int member = 0; member < ensemble_size; ++member)
@@ -1646,7 +2644,8 @@ run_ensemble(MPI_Comm const &communicator,
                     *material_properties_ensemble[member],
                     solution_augmented_ensemble[member].block(base_state),
                     heat_sources_ensemble[member], time, next_refinement_time,
-                    time_steps_refinement, refinement_database);
+                    n_refinement_time_steps, refinement_database,
+                    cooling_history_ensemble[member]);
         solution_augmented_ensemble[member].collect_sizes();
       }
 
@@ -1655,6 +2654,8 @@ run_ensemble(MPI_Comm const &communicator,
         std::cout << "n_dofs: "
                   << thermal_physics_ensemble[0]->get_dof_handler().n_dofs()
                   << std::endl;
+      if (print_memory_report)
+        report_memory("after refinement");
     }
 
     // We use an epsilon to get the "expected" behavior when the deposition
@@ -1675,6 +2676,7 @@ run_ensemble(MPI_Comm const &communicator,
                            activation_time_end) -
           deposition_times.begin();
       if (activation_start < activation_end)
+      {
         for (unsigned int member = 0; member < ensemble_size; ++member)
         {
           // Compute the elements to activate.
@@ -1697,6 +2699,9 @@ run_ensemble(MPI_Comm const &communicator,
 
           solution_augmented_ensemble[member].collect_sizes();
         }
+        if (print_memory_report)
+          report_memory("after material deposition");
+      }
 
       if ((rank == 0) && (verbose_output == true) &&
           (activation_end - activation_start > 0))
@@ -1716,6 +2721,9 @@ run_ensemble(MPI_Comm const &communicator,
           solution_augmented_ensemble[member].block(base_state), timers);
     }
     timers[adamantine::evol_time].stop();
+    if (beam_travel_distance)
+      beam_travel += compute_beam_displacement(heat_sources_ensemble[0],
+                                               beam_positions, time);
 
     // ----- Get the new time step size -----
     // Needs to be the same for all ensemble members, obtained from the 0th
@@ -1974,6 +2982,9 @@ run_ensemble(MPI_Comm const &communicator,
     post_processor_ensemble[member]->write_pvd();
   }
 
+  if (print_memory_report)
+    memory_report.print_high_water_marks(std::cout);
+
   // This is only used for integration test
   if constexpr (std::is_same_v<MemorySpaceType, dealii::MemorySpace::Host>)
   {
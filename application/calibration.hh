@@ -0,0 +1,320 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#ifndef CALIBRATION_HH
+#define CALIBRATION_HH
+
+#include "adamantine.hh"
+#include <validate_input_database.hh>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <chrono>
+#include <limits>
+
+// Parse a comma-separated list of values.
+template <typename T>
+std::vector<T> parse_calibration_list(std::string const &list)
+{
+  std::vector<std::string> split_list;
+  boost::split(split_list, list, [](char c) { return c == ','; });
+  std::vector<T> values;
+  for (auto &value : split_list)
+  {
+    boost::trim(value);
+    if (!value.empty())
+      values.push_back(boost::lexical_cast<T>(value));
+  }
+
+  return values;
+}
+
+// Run a short simulation using @p trial_database and return the wall time (the
+// largest over the processors) and the extrema of the temperature. If the
+// simulation fails, the wall time is infinite.
+template <int dim, typename MemorySpaceType>
+std::tuple<double, double, double>
+run_calibration_trial(MPI_Comm const &communicator,
+                      boost::property_tree::ptree &trial_database)
+{
+  std::vector<adamantine::Timer> trial_timers;
+  initialize_timers(communicator, trial_timers);
+  double wall_time = std::numeric_limits<double>::infinity();
+  double min_temperature = std::numeric_limits<double>::quiet_NaN();
+  double max_temperature = std::numeric_limits<double>::quiet_NaN();
+  try
+  {
+    adamantine::validate_input_database(trial_database);
+    auto const start = std::chrono::steady_clock::now();
+    auto [temperature, displacement] = run<dim, MemorySpaceType>(
+        communicator, trial_database, trial_timers);
+    auto const end = std::chrono::steady_clock::now();
+    wall_time = dealii::Utilities::MPI::max(
+        std::chrono::duration<double>(end - start).count(), communicator);
+    double local_min = std::numeric_limits<double>::max();
+    double local_max = std::numeric_limits<double>::lowest();
+    for (unsigned int i = 0; i < temperature.locally_owned_size(); ++i)
+    {
+      local_min = std::min(local_min, temperature.local_element(i));
+      local_max = std::max(local_max, temperature.local_element(i));
+    }
+    min_temperature = dealii::Utilities::MPI::min(local_min, communicator);
+    max_temperature = dealii::Utilities::MPI::max(local_max, communicator);
+  }
+  catch (std::exception const &exception)
+  {
+    if (dealii::Utilities::MPI::this_mpi_process(communicator) == 0)
+      std::cout << "Trial failed: " << exception.what() << std::endl;
+  }
+
+  return std::make_tuple(wall_time, min_temperature, max_temperature);
+}
+
+// Check that the reference simulation of the calibration succeeded. An
+// explicit reference that diverged returns non-finite extrema.
+inline void check_calibration_reference(double const reference_time,
+                                        double const reference_min,
+                                        double const reference_max)
+{
+  adamantine::ASSERT_THROW(
+      std::isfinite(reference_time),
+      "Error: The reference simulation of the calibration failed.");
+  adamantine::ASSERT_THROW(
+      std::isfinite(reference_min) && std::isfinite(reference_max),
+      "Error: The reference simulation of the calibration diverged. Increase "
+      "calibration.reference_time_step_ratio.");
+}
+
+// Return the error of a candidate relative to the reference. The error of a
+// candidate that failed or diverged is infinite.
+inline double compute_calibration_error(
+    double const wall_time, double const min_temperature,
+    double const max_temperature, double const reference_min,
+    double const reference_max, double const temperature_scale)
+{
+  if (!std::isfinite(wall_time))
+    return std::numeric_limits<double>::infinity();
+
+  double const error = std::max(std::abs(max_temperature - reference_max),
+                                std::abs(min_temperature - reference_min)) /
+                       temperature_scale;
+
+  return std::isfinite(error) ? error : std::numeric_limits<double>::infinity();
+}
+
+// Return the index of the fastest candidate whose error is less than
+// @p tolerance. If none does, return the index of the most accurate one. The
+// candidates that failed are never selected.
+inline unsigned int
+select_calibration_candidate(std::vector<double> const &wall_times,
+                             std::vector<double> const &errors,
+                             double const tolerance)
+{
+  unsigned int best = 0;
+  bool accurate_candidate = false;
+  for (unsigned int i = 0; i < errors.size(); ++i)
+  {
+    if (errors[i] <= tolerance)
+    {
+      if ((!accurate_candidate) || (wall_times[i] < wall_times[best]))
+        best = i;
+      accurate_candidate = true;
+    }
+    else if ((!accurate_candidate) && (errors[i] < errors[best]))
+    {
+      best = i;
+    }
+  }
+  adamantine::ASSERT_THROW((errors.size() > 0) && std::isfinite(errors[best]),
+                           "Error: All the candidates of the calibration "
+                           "failed.");
+
+  return best;
+}
+
+// Run short trial windows of the simulation described in @p database using
+// the candidate finite element degrees, quadratures, time stepping methods,
+// and GMRES parameters listed in the calibration section of the input file.
+// The error of every candidate is measured against a reference simulation that
+// uses a smaller time step and the highest finite element degree. The fastest
+// candidate whose error is less than the target tolerance is written as a
+// configuration block that can be copied in the input file.
+template <int dim, typename MemorySpaceType>
+void calibrate(MPI_Comm const &communicator,
+               boost::property_tree::ptree const &database)
+{
+  unsigned int const rank =
+      dealii::Utilities::MPI::this_mpi_process(communicator);
+  boost::property_tree::ptree const &calibration_database =
+      database.get_child("calibration");
+
+  // PropertyTreeInput calibration.fe_degrees
+  auto const fe_degrees = parse_calibration_list<unsigned int>(
+      calibration_database.get<std::string>("fe_degrees", "1,2,3"));
+  // PropertyTreeInput calibration.quadratures
+  auto const quadratures = parse_calibration_list<std::string>(
+      calibration_database.get<std::string>("quadratures", "gauss,lobatto"));
+  // PropertyTreeInput calibration.time_stepping_methods
+  auto const methods =
+      parse_calibration_list<std::string>(calibration_database.get(
+          "time_stepping_methods",
+          database.get<std::string>("time_stepping.method")));
+  // PropertyTreeInput calibration.n_tmp_vectors
+  auto const n_tmp_vectors =
+      parse_calibration_list<unsigned int>(calibration_database.get(
+          "n_tmp_vectors",
+          database.get<std::string>("time_stepping.n_tmp_vectors", "30")));
+  // PropertyTreeInput calibration.gmres_tolerances
+  auto const gmres_tolerances =
+      parse_calibration_list<double>(calibration_database.get(
+          "gmres_tolerances",
+          database.get<std::string>("time_stepping.tolerance", "1e-12")));
+  // PropertyTreeInput calibration.duration
+  double const duration = calibration_database.get(
+      "duration", database.get<double>("time_stepping.duration"));
+  // PropertyTreeInput calibration.tolerance
+  double const tolerance = calibration_database.get("tolerance", 1e-2);
+  // PropertyTreeInput calibration.reference_time_step_ratio
+  double const reference_time_step_ratio =
+      calibration_database.get("reference_time_step_ratio", 10.);
+  // PropertyTreeInput calibration.output_file
+  std::string const output_file =
+      calibration_database.get<std::string>("output_file", "calibration.info");
+  adamantine::ASSERT_THROW(fe_degrees.size() > 0 && quadratures.size() > 0 &&
+                               methods.size() > 0,
+                           "Error: The calibration needs at least one "
+                           "fe_degree, one quadrature, and one method.");
+  adamantine::ASSERT_THROW(
+      tolerance > 0., "Error: The calibration tolerance must be positive.");
+
+  // The trials do not output anything and only simulate the calibration window.
+  boost::property_tree::ptree trial_database = database;
+  trial_database.erase("profiling");
+  trial_database.erase("calibration");
+  trial_database.put("ensemble.ensemble_simulation", false);
+  trial_database.put("verbose_output", false);
+  trial_database.put("time_stepping.duration", duration);
+  trial_database.put(
+      "post_processor.filename_prefix",
+      database.get<std::string>("post_processor.filename_prefix") +
+          "_calibration");
+  trial_database.put("post_processor.time_steps_between_output",
+                     std::numeric_limits<int>::max());
+  // PropertyTreeInput materials.initial_temperature
+  double const initial_temperature =
+      database.get("materials.initial_temperature", 300.);
+
+  // Reference simulation
+  boost::property_tree::ptree reference_database = trial_database;
+  reference_database.put("discretization.thermal.fe_degree",
+                         *std::max_element(fe_degrees.begin(),
+                                           fe_degrees.end()));
+  reference_database.put("discretization.thermal.quadrature", "gauss");
+  reference_database.put("time_stepping.method", "rk_fourth_order");
+  reference_database.put("time_stepping.time_step",
+                         database.get<double>("time_stepping.time_step") /
+                             reference_time_step_ratio);
+  if (rank == 0)
+    std::cout << "Calibration: running the reference simulation" << std::endl;
+  auto const [reference_time, reference_min, reference_max] =
+      run_calibration_trial<dim, MemorySpaceType>(communicator,
+                                                  reference_database);
+  check_calibration_reference(reference_time, reference_min, reference_max);
+  // The error is measured on the extrema of the temperature relative to the
+  // increase of temperature of the reference.
+  double const temperature_scale =
+      std::max(std::abs(reference_max - initial_temperature), 1e-12);
+
+  // Trial simulations
+  std::vector<boost::property_tree::ptree> candidates;
+  std::vector<double> wall_times;
+  std::vector<double> errors;
+  for (auto const fe_degree : fe_degrees)
+  {
+    for (auto const &quadrature : quadratures)
+    {
+      for (auto method : methods)
+      {
+        boost::algorithm::to_lower(method);
+        bool const implicit_method =
+            (method == "backward_euler") || (method == "implicit_midpoint") ||
+            (method == "crank_nicolson") || (method == "sdirk2");
+        // The GMRES parameters are only used by the implicit methods.
+        unsigned int const n_gmres_configurations =
+            implicit_method ? n_tmp_vectors.size() * gmres_tolerances.size()
+                            : 1;
+        for (unsigned int i = 0; i < n_gmres_configurations; ++i)
+        {
+          // The candidate only contains the parameters that are calibrated.
+          boost::property_tree::ptree candidate;
+          boost::property_tree::ptree candidate_database = trial_database;
+          auto set_parameter = [&](std::string const &key, auto const &value)
+          {
+            candidate.put(key, value);
+            candidate_database.put(key, value);
+          };
+          set_parameter("discretization.thermal.fe_degree", fe_degree);
+          set_parameter("discretization.thermal.quadrature", quadrature);
+          set_parameter("time_stepping.method", method);
+          if (implicit_method)
+          {
+            set_parameter("time_stepping.n_tmp_vectors",
+                          n_tmp_vectors[i / gmres_tolerances.size()]);
+            set_parameter("time_stepping.tolerance",
+                          gmres_tolerances[i % gmres_tolerances.size()]);
+          }
+
+          if (rank == 0)
+          {
+            std::cout << "Calibration: fe_degree " << fe_degree
+                      << ", quadrature " << quadrature << ", method " << method;
+            if (implicit_method)
+              std::cout << ", n_tmp_vectors "
+                        << candidate.get<std::string>(
+                               "time_stepping.n_tmp_vectors")
+                        << ", tolerance "
+                        << candidate.get<std::string>(
+                               "time_stepping.tolerance");
+            std::cout << std::endl;
+          }
+
+          auto const [wall_time, min_temperature, max_temperature] =
+              run_calibration_trial<dim, MemorySpaceType>(communicator,
+                                                          candidate_database);
+          double const error = compute_calibration_error(
+              wall_time, min_temperature, max_temperature, reference_min,
+              reference_max, temperature_scale);
+          candidates.push_back(candidate);
+          wall_times.push_back(wall_time);
+          errors.push_back(error);
+          if (rank == 0)
+            std::cout << "  wall time: " << wall_time << " s, error: " << error
+                      << std::endl;
+        }
+      }
+    }
+  }
+
+  unsigned int const best =
+      select_calibration_candidate(wall_times, errors, tolerance);
+
+  if (rank == 0)
+  {
+    if (errors[best] > tolerance)
+      std::cout << "Calibration: no candidate reached the tolerance "
+                << tolerance << ", the most accurate one is recommended."
+                << std::endl;
+    std::cout << "Calibration: recommended configuration (wall time "
+              << wall_times[best] << " s, error " << errors[best]
+              << ") written to " << output_file << std::endl;
+    boost::property_tree::info_parser::write_info(output_file,
+                                                  candidates[best]);
+  }
+}
+
+#endif
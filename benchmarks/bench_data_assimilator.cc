@@ -0,0 +1,104 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <DataAssimilator.hh>
+#include <Geometry.hh>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include "benchmark.hh"
+#include "main.cc"
+
+void update_ensemble(MPI_Comm const &communicator,
+                     unsigned int n_ensemble_members, unsigned int expt_size,
+                     unsigned int n_repetitions)
+{
+  int constexpr dim = 2;
+  unsigned int constexpr n_divisions = 100;
+
+  // Create the Geometry
+  boost::property_tree::ptree geometry_database;
+  geometry_database.put("import_mesh", false);
+  geometry_database.put("length", 1.);
+  geometry_database.put("length_divisions", n_divisions);
+  geometry_database.put("height", 1.);
+  geometry_database.put("height_divisions", n_divisions);
+  adamantine::Geometry<dim> geometry(communicator, geometry_database);
+
+  dealii::FE_Q<dim> fe(1);
+  dealii::DoFHandler<dim> dof_handler(geometry.get_triangulation());
+  dof_handler.distribute_dofs(fe);
+  unsigned int const sim_size = dof_handler.n_dofs();
+
+  // Observations are spread uniformly over the degrees of freedom
+  std::pair<std::vector<int>, std::vector<int>> expt_to_dof_mapping;
+  std::vector<double> expt_data(expt_size);
+  for (unsigned int i = 0; i < expt_size; ++i)
+  {
+    expt_to_dof_mapping.first.push_back(i);
+    expt_to_dof_mapping.second.push_back(i * (sim_size / expt_size));
+    expt_data[i] = 1000. + i % 100;
+  }
+
+  boost::property_tree::ptree database;
+  database.put("localization_cutoff_function", "gaspari_cohn");
+  database.put("localization_cutoff_distance", 0.05);
+  adamantine::DataAssimilator data_assimilator(database);
+  data_assimilator.update_covariance_sparsity_pattern<dim>(dof_handler, 0);
+  data_assimilator.update_dof_mapping<dim>(expt_to_dof_mapping);
+
+  // Create the ensemble
+  std::vector<dealii::LA::distributed::BlockVector<double>>
+      augmented_state_ensemble(n_ensemble_members);
+  for (unsigned int member = 0; member < n_ensemble_members; ++member)
+  {
+    augmented_state_ensemble[member].reinit(2);
+    augmented_state_ensemble[member].block(0).reinit(sim_size);
+    for (unsigned int i = 0; i < sim_size; ++i)
+      augmented_state_ensemble[member].block(0)(i) =
+          1000. + member + (i % 100);
+    augmented_state_ensemble[member].collect_sizes();
+  }
+
+  // Diagonal experimental covariance matrix
+  dealii::SparsityPattern pattern(expt_size, expt_size, 1);
+  for (unsigned int i = 0; i < expt_size; ++i)
+    pattern.add(i, i);
+  pattern.compress();
+  dealii::SparseMatrix<double> R(pattern);
+  for (unsigned int i = 0; i < expt_size; ++i)
+    R.add(i, i, 1.);
+
+  adamantine::benchmark::measure(
+      communicator,
+      "DataAssimilator::update_ensemble n_members=" +
+          std::to_string(n_ensemble_members) +
+          " n_obs=" + std::to_string(expt_size),
+      static_cast<double>(n_ensemble_members) * sim_size, "DoFs",
+      n_repetitions,
+      [&]()
+      {
+        data_assimilator.update_ensemble(communicator, augmented_state_ensemble,
+                                         expt_data, R);
+      });
+}
+
+void run_benchmarks(MPI_Comm const &communicator, unsigned int n_repetitions)
+{
+  // Like the unit tests, the ensemble members are serial vectors.
+  if (dealii::Utilities::MPI::n_mpi_processes(communicator) != 1)
+    return;
+
+  for (unsigned int n_ensemble_members : {5, 10, 20})
+    for (unsigned int expt_size : {100, 1000})
+      update_ensemble(communicator, n_ensemble_members, expt_size,
+                      n_repetitions);
+}
@@ -0,0 +1,71 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <Geometry.hh>
+#include <material_deposition.hh>
+
+#include <deal.II/fe/fe_nothing.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/grid/filtered_iterator.h>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include "benchmark.hh"
+#include "main.cc"
+
+void get_elements_to_activate(MPI_Comm const &communicator,
+                              unsigned int n_boxes_per_direction,
+                              unsigned int n_repetitions)
+{
+  int constexpr dim = 3;
+  unsigned int constexpr n_divisions = 64;
+
+  // Create the Geometry
+  boost::property_tree::ptree geometry_database;
+  geometry_database.put("import_mesh", false);
+  geometry_database.put("length", 1.);
+  geometry_database.put("length_divisions", n_divisions);
+  geometry_database.put("height", 1.);
+  geometry_database.put("height_divisions", n_divisions);
+  geometry_database.put("width", 1.);
+  geometry_database.put("width_divisions", n_divisions);
+  adamantine::Geometry<dim> geometry(communicator, geometry_database);
+
+  // All the cells are inactive
+  dealii::hp::FECollection<dim> fe_collection;
+  fe_collection.push_back(dealii::FE_Q<dim>(1));
+  fe_collection.push_back(dealii::FE_Nothing<dim>());
+  dealii::DoFHandler<dim> dof_handler(geometry.get_triangulation());
+  dof_handler.distribute_dofs(fe_collection);
+  for (auto const &cell :
+       dealii::filter_iterators(dof_handler.active_cell_iterators(),
+                                dealii::IteratorFilters::LocallyOwnedCell()))
+    cell->set_active_fe_index(1);
+
+  // Create a raster of thin deposition boxes on the top layer of cells
+  std::vector<dealii::BoundingBox<dim>> boxes;
+  double const box_size = 1. / n_boxes_per_direction;
+  double const z_min = 1. - 1. / n_divisions;
+  for (unsigned int j = 0; j < n_boxes_per_direction; ++j)
+    for (unsigned int i = 0; i < n_boxes_per_direction; ++i)
+      boxes.emplace_back(std::make_pair(
+          dealii::Point<dim>(i * box_size, j * box_size, z_min),
+          dealii::Point<dim>((i + 1) * box_size, (j + 1) * box_size, 1.)));
+
+  adamantine::benchmark::measure(
+      communicator,
+      "get_elements_to_activate n_boxes=" + std::to_string(boxes.size()),
+      boxes.size(), "boxes", n_repetitions,
+      [&]() { adamantine::get_elements_to_activate(dof_handler, boxes); });
+}
+
+void run_benchmarks(MPI_Comm const &communicator, unsigned int n_repetitions)
+{
+  get_elements_to_activate(communicator, 10, n_repetitions);
+  get_elements_to_activate(communicator, 100, n_repetitions);
+  get_elements_to_activate(communicator, 300, n_repetitions);
+}
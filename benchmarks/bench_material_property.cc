@@ -0,0 +1,102 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <Geometry.hh>
+#include <MaterialProperty.hh>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/lac/read_write_vector.h>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include "benchmark.hh"
+#include "main.cc"
+
+void update(MPI_Comm const &communicator, std::string const &property_format,
+            unsigned int n_repetitions)
+{
+  int constexpr dim = 3;
+  unsigned int constexpr n_divisions = 40;
+
+  // Create the Geometry
+  boost::property_tree::ptree geometry_database;
+  geometry_database.put("import_mesh", false);
+  geometry_database.put("length", 1.);
+  geometry_database.put("length_divisions", n_divisions);
+  geometry_database.put("height", 1.);
+  geometry_database.put("height_divisions", n_divisions);
+  geometry_database.put("width", 1.);
+  geometry_database.put("width_divisions", n_divisions);
+  adamantine::Geometry<dim> geometry(communicator, geometry_database);
+  auto const &triangulation = geometry.get_triangulation();
+
+  // Half of the cells are powder so that the mixture of states is computed.
+  unsigned int n = 0;
+  for (auto cell : triangulation.active_cell_iterators())
+  {
+    cell->set_material_id(0);
+    cell->set_user_index(static_cast<int>(
+        (n % 2) ? adamantine::MaterialState::powder
+                : adamantine::MaterialState::solid));
+    ++n;
+  }
+
+  // Create the MaterialProperty
+  boost::property_tree::ptree database;
+  database.put("property_format", property_format);
+  database.put("n_materials", 1);
+  for (std::string state : {"solid", "powder", "liquid"})
+  {
+    std::string const prefix = "material_0." + state;
+    if (property_format == "polynomial")
+    {
+      database.put(prefix + ".density", "7904., -0.1");
+      database.put(prefix + ".specific_heat", "714., 0.1");
+      database.put(prefix + ".thermal_conductivity_x", "31., 0.01, 1e-5");
+      database.put(prefix + ".thermal_conductivity_y", "31., 0.01, 1e-5");
+      database.put(prefix + ".thermal_conductivity_z", "31., 0.01, 1e-5");
+    }
+    else
+    {
+      database.put(prefix + ".density",
+                   "0., 7904.; 1000., 7800.; 2000., 7700.");
+      database.put(prefix + ".specific_heat",
+                   "0., 714.; 1000., 800.; 2000., 850.");
+      database.put(prefix + ".thermal_conductivity_x",
+                   "0., 31.; 1000., 35.; 2000., 37.");
+      database.put(prefix + ".thermal_conductivity_y",
+                   "0., 31.; 1000., 35.; 2000., 37.");
+      database.put(prefix + ".thermal_conductivity_z",
+                   "0., 31.; 1000., 35.; 2000., 37.");
+    }
+  }
+  database.put("material_0.solidus", 1675.);
+  database.put("material_0.liquidus", 1708.);
+  database.put("material_0.latent_heat", 290000.);
+  adamantine::MaterialProperty<dim, dealii::MemorySpace::Host> mat_prop(
+      communicator, triangulation, database);
+
+  // Create a temperature field that spans the three states
+  dealii::FE_Q<dim> fe(2);
+  dealii::DoFHandler<dim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+  dealii::LA::distributed::Vector<double, dealii::MemorySpace::Host>
+      temperature(dof_handler.locally_owned_dofs(), communicator);
+  for (unsigned int i = 0; i < temperature.locally_owned_size(); ++i)
+    temperature.local_element(i) = 300. + (i % 2000);
+
+  adamantine::benchmark::measure(
+      communicator, "MaterialProperty::update " + property_format,
+      triangulation.n_global_active_cells(), "cells", n_repetitions,
+      [&]() { mat_prop.update(dof_handler, temperature); });
+}
+
+void run_benchmarks(MPI_Comm const &communicator, unsigned int n_repetitions)
+{
+  update(communicator, "polynomial", n_repetitions);
+  update(communicator, "table", n_repetitions);
+}
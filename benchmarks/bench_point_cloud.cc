@@ -0,0 +1,57 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <PointCloud.hh>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include "benchmark.hh"
+#include "main.cc"
+
+void read_next_frame(MPI_Comm const &communicator, unsigned int n_points,
+                     unsigned int n_repetitions)
+{
+  // All the repetitions read the same frame. The file name must not contain
+  // #frame for this to work.
+  std::string const prefix =
+      "bench_point_cloud_" + std::to_string(n_points) + "_" +
+      std::to_string(dealii::Utilities::MPI::this_mpi_process(communicator));
+  std::string const filename = prefix + "_#camera.csv";
+  std::string const frame_filename = prefix + "_0.csv";
+  {
+    std::ofstream file(frame_filename);
+    file << "\"x\", \"y\", \"z\", \"T\"\n";
+    for (unsigned int i = 0; i < n_points; ++i)
+      file << (i % 1000) * 1e-5 << "," << (i / 1000) * 1e-5 << ",1e-3,"
+           << 300. + (i % 1500) << "\n";
+  }
+  double const n_bytes = std::filesystem::file_size(frame_filename);
+
+  boost::property_tree::ptree experiment_database;
+  experiment_database.put("file", filename);
+  experiment_database.put("first_camera_id", 0);
+  experiment_database.put("last_camera_id", 0);
+  adamantine::PointCloud<3> point_cloud(experiment_database);
+
+  adamantine::benchmark::measure(
+      communicator, "PointCloud::read_next_frame n_points=" +
+                        std::to_string(n_points),
+      n_bytes, "bytes", n_repetitions,
+      [&]() { point_cloud.read_next_frame(); });
+
+  std::remove(frame_filename.c_str());
+}
+
+void run_benchmarks(MPI_Comm const &communicator, unsigned int n_repetitions)
+{
+  read_next_frame(communicator, 10000, n_repetitions);
+  read_next_frame(communicator, 1000000, n_repetitions);
+}
@@ -0,0 +1,96 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include "../application/adamantine.hh"
+
+#include "benchmark.hh"
+#include "main.cc"
+
+void refine_and_transfer_cycle(MPI_Comm const &communicator,
+                               unsigned int n_divisions,
+                               unsigned int n_repetitions)
+{
+  int constexpr dim = 3;
+  unsigned int constexpr fe_degree = 2;
+
+  boost::property_tree::ptree database;
+  database.put("geometry.import_mesh", false);
+  database.put("geometry.length", 1.);
+  database.put("geometry.length_divisions", n_divisions);
+  database.put("geometry.height", 1.);
+  database.put("geometry.height_divisions", n_divisions);
+  database.put("geometry.width", 1.);
+  database.put("geometry.width_divisions", n_divisions);
+  database.put("boundary.type", "adiabatic");
+  database.put("sources.n_beams", 0);
+  database.put("time_stepping.method", "forward_euler");
+  database.put("materials.property_format", "polynomial");
+  database.put("materials.n_materials", 1);
+  for (std::string state : {"solid", "powder", "liquid"})
+  {
+    std::string const prefix = "materials.material_0." + state;
+    database.put(prefix + ".density", 1.);
+    database.put(prefix + ".specific_heat", 1.);
+    database.put(prefix + ".thermal_conductivity_x", 10.);
+    database.put(prefix + ".thermal_conductivity_y", 10.);
+    database.put(prefix + ".thermal_conductivity_z", 10.);
+  }
+
+  adamantine::Geometry<dim> geometry(communicator,
+                                     database.get_child("geometry"));
+  adamantine::MaterialProperty<dim, dealii::MemorySpace::Host>
+      material_properties(communicator, geometry.get_triangulation(),
+                          database.get_child("materials"));
+  auto thermal_physics =
+      initialize_thermal_physics<dim>(fe_degree, "gauss", communicator,
+                                      database, geometry, material_properties);
+  dealii::LA::distributed::Vector<double, dealii::MemorySpace::Host>
+      temperature;
+  thermal_physics->setup_dofs();
+  thermal_physics->update_material_deposition_orientation();
+  thermal_physics->compute_inverse_mass_matrix();
+  thermal_physics->initialize_dof_vector(300., temperature);
+  thermal_physics->get_state_from_material_properties();
+
+  auto &dof_handler = thermal_physics->get_dof_handler();
+  auto &triangulation = geometry.get_triangulation();
+  // Each repetition transfers the data from the coarse cells to the children
+  // and back.
+  double const n_coarse_cells = triangulation.n_global_active_cells();
+  double const n_transferred_cells =
+      n_coarse_cells * (1. + dealii::GeometryInfo<dim>::max_children_per_cell);
+
+  // Refine every cell once and then coarsen them back so that every repetition
+  // works on the same meshes.
+  adamantine::benchmark::measure(
+      communicator,
+      "refine_and_transfer n_cells=" +
+          std::to_string(triangulation.n_global_active_cells()),
+      n_transferred_cells, "cells", n_repetitions,
+      [&]()
+      {
+        for (auto cell : dealii::filter_iterators(
+                 triangulation.active_cell_iterators(),
+                 dealii::IteratorFilters::LocallyOwnedCell()))
+          cell->set_refine_flag();
+        refine_and_transfer(thermal_physics, material_properties, dof_handler,
+                            temperature);
+
+        for (auto cell : dealii::filter_iterators(
+                 triangulation.active_cell_iterators(),
+                 dealii::IteratorFilters::LocallyOwnedCell()))
+          cell->set_coarsen_flag();
+        refine_and_transfer(thermal_physics, material_properties, dof_handler,
+                            temperature);
+      });
+}
+
+void run_benchmarks(MPI_Comm const &communicator, unsigned int n_repetitions)
+{
+  refine_and_transfer_cycle(communicator, 8, n_repetitions);
+  refine_and_transfer_cycle(communicator, 16, n_repetitions);
+}
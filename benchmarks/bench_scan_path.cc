@@ -0,0 +1,63 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <ScanPath.hh>
+
+#include <cstdio>
+#include <fstream>
+
+#include "benchmark.hh"
+#include "main.cc"
+
+void value(MPI_Comm const &communicator, unsigned int n_events,
+           unsigned int n_repetitions)
+{
+  // Write a raster scan path in the event series format. Every event is one
+  // hatch of length 1 mm scanned in 1 ms.
+  std::string const filename =
+      "bench_scan_path_" + std::to_string(n_events) + "_" +
+      std::to_string(dealii::Utilities::MPI::this_mpi_process(communicator)) +
+      ".inp";
+  {
+    std::ofstream file(filename);
+    for (unsigned int i = 0; i < n_events; ++i)
+    {
+      double const x = (i % 2) ? 0. : 1e-3;
+      double const y = i * 1e-4;
+      file << (i + 1) * 1e-3 << ", " << x << ", " << y << ", 0.0, 1.0\n";
+    }
+  }
+  adamantine::ScanPath scan_path(filename, "event_series");
+
+  // Query the position of the beam at increasing times over the entire path,
+  // like during a simulation.
+  unsigned int constexpr n_queries = 10000;
+  double const duration = n_events * 1e-3;
+  double sum = 0.;
+  adamantine::benchmark::measure(
+      communicator,
+      "ScanPath::value n_events=" + std::to_string(n_events), n_queries,
+      "queries", n_repetitions,
+      [&]()
+      {
+        for (unsigned int i = 0; i < n_queries; ++i)
+          sum += scan_path.value(i * duration / n_queries)[0];
+      });
+
+  // Use the result so that the compiler cannot remove the loop.
+  if (sum < 0.)
+    std::cout << sum << std::endl;
+
+  std::remove(filename.c_str());
+}
+
+void run_benchmarks(MPI_Comm const &communicator, unsigned int n_repetitions)
+{
+  value(communicator, 1000, n_repetitions);
+  value(communicator, 10000, n_repetitions);
+  value(communicator, 100000, n_repetitions);
+}
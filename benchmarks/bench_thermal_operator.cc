@@ -0,0 +1,104 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <Geometry.hh>
+#include <ThermalOperator.hh>
+
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/fe/fe_nothing.h>
+#include <deal.II/fe/fe_q.h>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include "benchmark.hh"
+#include "main.cc"
+
+template <int dim, int fe_degree>
+void vmult(MPI_Comm const &communicator, unsigned int n_divisions,
+           unsigned int n_repetitions)
+{
+  // Create the Geometry
+  boost::property_tree::ptree geometry_database;
+  geometry_database.put("import_mesh", false);
+  geometry_database.put("length", 1.);
+  geometry_database.put("length_divisions", n_divisions);
+  geometry_database.put("height", 1.);
+  geometry_database.put("height_divisions", n_divisions);
+  geometry_database.put("width", 1.);
+  geometry_database.put("width_divisions", n_divisions);
+  adamantine::Geometry<dim> geometry(communicator, geometry_database);
+
+  // Create the DoFHandler
+  dealii::hp::FECollection<dim> fe_collection;
+  fe_collection.push_back(dealii::FE_Q<dim>(fe_degree));
+  fe_collection.push_back(dealii::FE_Nothing<dim>());
+  dealii::DoFHandler<dim> dof_handler(geometry.get_triangulation());
+  dof_handler.distribute_dofs(fe_collection);
+  dealii::AffineConstraints<double> affine_constraints;
+  affine_constraints.close();
+  dealii::hp::QCollection<1> q_collection;
+  q_collection.push_back(dealii::QGauss<1>(fe_degree + 1));
+  q_collection.push_back(dealii::QGauss<1>(1));
+
+  // Create the MaterialProperty
+  boost::property_tree::ptree mat_prop_database;
+  mat_prop_database.put("property_format", "polynomial");
+  mat_prop_database.put("n_materials", 1);
+  for (std::string state : {"solid", "powder", "liquid"})
+  {
+    std::string const prefix = "material_0." + state;
+    mat_prop_database.put(prefix + ".density", 1.);
+    mat_prop_database.put(prefix + ".specific_heat", 1.);
+    mat_prop_database.put(prefix + ".thermal_conductivity_x", 10.);
+    mat_prop_database.put(prefix + ".thermal_conductivity_y", 10.);
+    mat_prop_database.put(prefix + ".thermal_conductivity_z", 10.);
+  }
+  adamantine::MaterialProperty<dim, dealii::MemorySpace::Host> mat_properties(
+      communicator, geometry.get_triangulation(), mat_prop_database);
+
+  // Initialize the ThermalOperator without heat source
+  std::vector<std::shared_ptr<adamantine::HeatSource<dim>>> heat_sources;
+  adamantine::ThermalOperator<dim, fe_degree, dealii::MemorySpace::Host>
+      thermal_operator(communicator, adamantine::BoundaryType::adiabatic,
+                       mat_properties, heat_sources);
+  std::vector<double> deposition_cos(
+      geometry.get_triangulation().n_locally_owned_active_cells(), 1.);
+  std::vector<double> deposition_sin(
+      geometry.get_triangulation().n_locally_owned_active_cells(), 0.);
+  thermal_operator.reinit(dof_handler, affine_constraints, q_collection);
+  thermal_operator.set_material_deposition_orientation(deposition_cos,
+                                                       deposition_sin);
+  thermal_operator.compute_inverse_mass_matrix(dof_handler, affine_constraints);
+  thermal_operator.get_state_from_material_properties();
+
+  dealii::LA::distributed::Vector<double, dealii::MemorySpace::Host> src;
+  dealii::LA::distributed::Vector<double, dealii::MemorySpace::Host> dst;
+  thermal_operator.initialize_dof_vector(src);
+  thermal_operator.initialize_dof_vector(dst);
+  src = 300.;
+
+  adamantine::benchmark::measure(
+      communicator,
+      "ThermalOperator::vmult dim=" + std::to_string(dim) +
+          " fe_degree=" + std::to_string(fe_degree),
+      dof_handler.n_dofs(), "DoFs", n_repetitions,
+      [&]() { thermal_operator.vmult(dst, src); });
+}
+
+void run_benchmarks(MPI_Comm const &communicator, unsigned int n_repetitions)
+{
+  // The number of divisions is chosen such that the number of DoFs is roughly
+  // independent of the polynomial degree.
+  vmult<2, 1>(communicator, 512, n_repetitions);
+  vmult<2, 2>(communicator, 256, n_repetitions);
+  vmult<2, 3>(communicator, 170, n_repetitions);
+  vmult<2, 4>(communicator, 128, n_repetitions);
+  vmult<3, 1>(communicator, 64, n_repetitions);
+  vmult<3, 2>(communicator, 32, n_repetitions);
+  vmult<3, 3>(communicator, 21, n_repetitions);
+  vmult<3, 4>(communicator, 16, n_repetitions);
+}
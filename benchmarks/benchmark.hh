@@ -0,0 +1,59 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#ifndef BENCHMARK_HH
+#define BENCHMARK_HH
+
+#include <deal.II/base/mpi.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace adamantine
+{
+namespace benchmark
+{
+/**
+ * Execute @p kernel once to warm up the caches, then @p n_repetitions times
+ * while measuring the wall-clock time. The time reported is the maximum over
+ * all the processors. @p n_items is the number of items (DoFs, bytes, points,
+ * ...) processed by one call to @p kernel and @p unit is the name of these
+ * items. The result is printed by rank 0 as one line of a table: name of the
+ * benchmark, time per repetition in seconds, and throughput in @p unit/s.
+ */
+template <typename Kernel>
+void measure(MPI_Comm const &communicator, std::string const &name,
+             double n_items, std::string const &unit,
+             unsigned int n_repetitions, Kernel &&kernel)
+{
+  kernel();
+
+  MPI_Barrier(communicator);
+  auto const start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < n_repetitions; ++i)
+    kernel();
+  std::chrono::duration<double> const local_time =
+      std::chrono::steady_clock::now() - start;
+  double const time =
+      dealii::Utilities::MPI::max(local_time.count(), communicator);
+
+  if (dealii::Utilities::MPI::this_mpi_process(communicator) == 0)
+  {
+    double const time_per_repetition = time / n_repetitions;
+    std::cout << std::left << std::setw(50) << name << std::right
+              << std::scientific << std::setprecision(3) << std::setw(12)
+              << time_per_repetition << " s  " << std::setw(12)
+              << n_items / time_per_repetition << " " << unit << "/s"
+              << std::endl;
+  }
+}
+} // namespace benchmark
+} // namespace adamantine
+
+#endif
@@ -0,0 +1,31 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <deal.II/base/mpi.h>
+
+#include <Kokkos_Core.hpp>
+
+#include <string>
+
+/**
+ * Function defined by each benchmark. @p n_repetitions is the number of times
+ * each kernel is executed after the warm-up.
+ */
+void run_benchmarks(MPI_Comm const &communicator, unsigned int n_repetitions);
+
+int main(int argc, char *argv[])
+{
+  dealii::Utilities::MPI::MPI_InitFinalize mpi_initialization(
+      argc, argv, dealii::numbers::invalid_unsigned_int);
+  Kokkos::ScopeGuard guard(argc, argv);
+
+  // The number of repetitions can be passed as the first argument.
+  unsigned int const n_repetitions = argc > 1 ? std::stoi(argv[1]) : 10;
+  run_benchmarks(MPI_COMM_WORLD, n_repetitions);
+
+  return 0;
+}
@@ -0,0 +1,19 @@
+function(adamantine_ADD_BENCHMARK BENCHMARK_NAME)
+    add_executable(${BENCHMARK_NAME} ${CMAKE_CURRENT_SOURCE_DIR}/${BENCHMARK_NAME}.cc)
+    target_link_libraries(${BENCHMARK_NAME} Boost::boost)
+    target_link_libraries(${BENCHMARK_NAME} Boost::chrono)
+    target_link_libraries(${BENCHMARK_NAME} Boost::program_options)
+    target_link_libraries(${BENCHMARK_NAME} MPI::MPI_CXX)
+    target_link_libraries(${BENCHMARK_NAME} Adamantine)
+    set_target_properties(${BENCHMARK_NAME} PROPERTIES
+        CXX_STANDARD 17
+        CXX_STANDARD_REQUIRED ON
+        CXX_EXTENSIONS OFF
+    )
+    DEAL_II_SETUP_TARGET(${BENCHMARK_NAME})
+    add_dependencies(benchmarks ${BENCHMARK_NAME})
+    add_custom_command(TARGET run_benchmarks POST_BUILD
+        WORKING_DIRECTORY ${CMAKE_BINARY_DIR}/bin
+        COMMAND ${MPIEXEC} ${MPIEXEC_NUMPROC_FLAG} 1 ${CMAKE_BINARY_DIR}/bin/${BENCHMARK_NAME}
+    )
+endfunction()
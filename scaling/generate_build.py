@@ -0,0 +1,279 @@
+#!/usr/bin/env python3
+# Copyright (c) 2023, the adamantine authors.
+#
+# This file is subject to the Modified BSD License and may not be distributed
+# without copyright and license information. Please refer to the file LICENSE
+# for the text and further information on this license.
+
+"""Generate a synthetic but realistic build for adamantine.
+
+The build is a rectangular part deposited layer by layer on a substrate. Each
+layer is scanned with a raster pattern: the hatches are parallel to the x axis
+and separated by the hatch spacing. When several beams are used, the width of
+the part is divided in stripes and each beam scans its own stripe at the same
+time as the others.
+
+Three files are written:
+  * <prefix>.info: the input file, built from a template (for example
+    tests/data/demo_316_short.info or tests/data/bare_plate_L_da.info) whose
+    geometry, sources, and time_stepping blocks are replaced,
+  * <prefix>_scan_path_<beam>.txt: the scan path of each beam using the
+    segment format,
+  * <prefix>_material_deposition.txt: the material deposition file matching
+    the scan paths.
+"""
+
+import argparse
+import math
+from collections import OrderedDict
+
+
+# Input files use the INFO format of Boost.PropertyTree. The parser below
+# supports the subset of the format used by adamantine: one "key value" pair
+# per line, comments starting with ';', and subtrees delimited by braces.
+def _strip_comment(line):
+    in_quotes = False
+    for i, c in enumerate(line):
+        if c == '"':
+            in_quotes = not in_quotes
+        elif c == ';' and not in_quotes:
+            return line[:i]
+    return line
+
+
+def read_info(filename):
+    """Read an INFO file and return a tree of OrderedDict."""
+    root = OrderedDict()
+    stack = [root]
+    last_key = None
+    with open(filename) as f:
+        for line in f:
+            line = _strip_comment(line).strip()
+            if not line:
+                continue
+            if line == '{':
+                child = OrderedDict()
+                stack[-1][last_key] = child
+                stack.append(child)
+            elif line == '}':
+                stack.pop()
+            else:
+                tokens = line.split(None, 1)
+                last_key = tokens[0]
+                stack[-1][last_key] = tokens[1] if len(tokens) > 1 else ''
+    return root
+
+
+def write_info(tree, filename):
+    """Write a tree of OrderedDict as an INFO file."""
+    def write_tree(f, tree, indent):
+        for key, value in tree.items():
+            if isinstance(value, dict):
+                f.write(' ' * indent + key + '\n')
+                f.write(' ' * indent + '{\n')
+                write_tree(f, value, indent + 2)
+                f.write(' ' * indent + '}\n')
+            else:
+                f.write(' ' * indent + '{} {}\n'.format(key, value).rstrip()
+                        + '\n')
+    with open(filename, 'w') as f:
+        write_tree(f, tree, 0)
+
+
+def _format(value):
+    return '{:.9g}'.format(value)
+
+
+def get_subtree(tree, path):
+    """Return the subtree at path (keys separated by dots), creating it if
+    necessary."""
+    for key in path.split('.'):
+        if not isinstance(tree.get(key), dict):
+            tree[key] = OrderedDict()
+        tree = tree[key]
+    return tree
+
+
+def raster_scan_paths(args):
+    """Return, for each beam, the list of segments (mode, x, y, z, power
+    modifier, param) and the list of deposited tracks (x_start, x_end, y, z,
+    start time, end time)."""
+    stripe_width = args.width / args.n_beams
+    n_hatches = max(1, int(math.floor(stripe_width / args.hatch_spacing)))
+    scan_paths = []
+    tracks = []
+    for beam in range(args.n_beams):
+        segments = []
+        y_start = beam * stripe_width + 0.5 * args.hatch_spacing
+        time = 0.
+        x = 0.
+        y = y_start
+        for layer in range(args.n_layers):
+            z = args.substrate_height + (layer + 1) * args.layer_thickness
+            # Position the beam (point segment) and wait between layers
+            dwell = 1e-6 if layer == 0 else max(1e-6, args.interlayer_dwell)
+            x = 0.
+            y = y_start
+            segments.append((1, x, y, z, 0., dwell))
+            time += dwell
+            for hatch in range(n_hatches):
+                y = y_start + hatch * args.hatch_spacing
+                if hatch > 0:
+                    # Move to the next hatch with the beam off
+                    segments.append((0, x, y, z, 0., args.scan_speed))
+                    time += args.hatch_spacing / args.scan_speed
+                x_end = args.length if x == 0. else 0.
+                segments.append((0, x_end, y, z, 1., args.scan_speed))
+                hatch_time = args.length / args.scan_speed
+                tracks.append((x, x_end, y, z, time, time + hatch_time))
+                time += hatch_time
+                x = x_end
+        scan_paths.append(segments)
+
+    tracks.sort(key=lambda track: track[4])
+    return scan_paths, tracks
+
+
+def write_scan_path(segments, filename):
+    with open(filename, 'w') as f:
+        f.write('Number of path segments\n')
+        f.write('{}\n'.format(len(segments)))
+        f.write('Mode x y z pmod param\n')
+        for segment in segments:
+            f.write('{} {:.9e} {:.9e} {:.9e} {:g} {:.9e}\n'.format(*segment))
+
+
+def write_material_deposition(tracks, args, filename):
+    """Each track is deposited as one box. The material is added before the
+    beam reaches it, like with the deposition_lead_time of the scan_paths
+    method."""
+    with open(filename, 'w') as f:
+        f.write('3\n')
+        for x_start, x_end, y, z, start_time, _ in tracks:
+            angle = 0. if x_end > x_start else math.pi
+            center = (0.5 * (x_start + x_end), y,
+                      z - 0.5 * args.layer_thickness)
+            size = (abs(x_end - x_start), args.hatch_spacing,
+                    args.layer_thickness)
+            time = max(0., start_time - args.deposition_lead_time)
+            f.write('{:.9e} {:.9e} {:.9e} {:.9e} {:.9e} {:.9e} {:.9e} {:.9e}\n'
+                    .format(*center, *size, time, angle))
+
+
+def generate_build(args):
+    """Generate the input file, the scan paths, and the material deposition
+    file. Return the name of the input file and the duration of the build."""
+    scan_paths, tracks = raster_scan_paths(args)
+    scan_path_files = []
+    for beam, segments in enumerate(scan_paths):
+        filename = '{}_scan_path_{}.txt'.format(args.prefix, beam)
+        write_scan_path(segments, filename)
+        scan_path_files.append(filename)
+    deposition_file = args.prefix + '_material_deposition.txt'
+    write_material_deposition(tracks, args, deposition_file)
+    duration = max(track[5] for track in tracks)
+
+    database = read_info(args.template)
+
+    # Geometry: the cells have the same size in the three directions
+    height = args.substrate_height + args.n_layers * args.layer_thickness
+    geometry = OrderedDict()
+    geometry['import_mesh'] = 'false'
+    geometry['dim'] = '3'
+    geometry['length'] = _format(args.length)
+    geometry['height'] = _format(height)
+    geometry['width'] = _format(args.width)
+    geometry['length_divisions'] = str(
+        max(1, round(args.length / args.cell_size)))
+    geometry['height_divisions'] = str(max(1, round(height / args.cell_size)))
+    geometry['width_divisions'] = str(
+        max(1, round(args.width / args.cell_size)))
+    geometry['material_height'] = _format(args.substrate_height)
+    geometry['material_deposition'] = 'true'
+    geometry['material_deposition_method'] = 'file'
+    geometry['material_deposition_file'] = deposition_file
+    database['geometry'] = geometry
+
+    # Sources: every beam uses the properties of beam_0 of the template
+    sources = database['sources']
+    beam_template = sources['beam_0']
+    new_sources = OrderedDict()
+    new_sources['n_beams'] = str(args.n_beams)
+    for beam, filename in enumerate(scan_path_files):
+        beam_database = OrderedDict(beam_template)
+        beam_database['scan_path_file'] = filename
+        beam_database['scan_path_file_format'] = 'segment'
+        new_sources['beam_{}'.format(beam)] = beam_database
+    database['sources'] = new_sources
+
+    time_stepping = get_subtree(database, 'time_stepping')
+    time_stepping['duration'] = _format(
+        duration if args.duration is None else min(duration, args.duration))
+    if args.time_step is not None:
+        time_stepping['time_step'] = _format(args.time_step)
+
+    if args.max_level is not None:
+        get_subtree(database, 'refinement')['max_level'] = str(args.max_level)
+        get_subtree(database, 'refinement')['n_beam_refinements'] = str(
+            args.max_level)
+
+    post_processor = get_subtree(database, 'post_processor')
+    post_processor['filename_prefix'] = args.prefix
+    # Do not let the output pollute the measurements
+    post_processor['time_steps_between_output'] = '1000000000'
+
+    profiling = get_subtree(database, 'profiling')
+    profiling['timer'] = 'true'
+    profiling['counters_file'] = args.prefix + '_counters.csv'
+    profiling.pop('caliper', None)
+
+    input_file = args.prefix + '.info'
+    write_info(database, input_file)
+
+    return input_file, duration
+
+
+def add_arguments(parser):
+    parser.add_argument('--template', required=True,
+                        help='input file used as template')
+    parser.add_argument('--prefix', default='synthetic_build',
+                        help='prefix of the generated files')
+    parser.add_argument('--length', type=float, default=10e-3,
+                        help='length of the part [m]')
+    parser.add_argument('--width', type=float, default=10e-3,
+                        help='width of the part [m]')
+    parser.add_argument('--substrate-height', type=float, default=1e-3,
+                        help='height of the substrate [m]')
+    parser.add_argument('--n-layers', type=int, default=2,
+                        help='number of layers')
+    parser.add_argument('--layer-thickness', type=float, default=0.1e-3,
+                        help='thickness of a layer [m]')
+    parser.add_argument('--hatch-spacing', type=float, default=0.2e-3,
+                        help='distance between two hatches [m]')
+    parser.add_argument('--n-beams', type=int, default=1,
+                        help='number of beams scanning at the same time')
+    parser.add_argument('--scan-speed', type=float, default=0.8,
+                        help='speed of the beams [m/s]')
+    parser.add_argument('--interlayer-dwell', type=float, default=0.,
+                        help='time between two layers [s]')
+    parser.add_argument('--deposition-lead-time', type=float, default=5e-4,
+                        help='time between the deposition of a track and the '
+                        'arrival of the beam [s]')
+    parser.add_argument('--cell-size', type=float, default=0.2e-3,
+                        help='size of the cells of the coarse mesh [m]')
+    parser.add_argument('--max-level', type=int, default=None,
+                        help='number of refinements around the beams')
+    parser.add_argument('--time-step', type=float, default=None,
+                        help='time step [s] (default: value of the template)')
+    parser.add_argument('--duration', type=float, default=None,
+                        help='stop the simulation before the end of the build '
+                        '[s]')
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawTextHelpFormatter)
+    add_arguments(parser)
+    args = parser.parse_args()
+    input_file, duration = generate_build(args)
+    print('Wrote {} (build duration: {:g} s)'.format(input_file, duration))
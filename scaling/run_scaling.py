@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+# Copyright (c) 2023, the adamantine authors.
+#
+# This file is subject to the Modified BSD License and may not be distributed
+# without copyright and license information. Please refer to the file LICENSE
+# for the text and further information on this license.
+
+"""Run strong and weak scaling studies of adamantine on synthetic builds.
+
+For every number of processors, a build is generated with generate_build.py,
+adamantine is run, and the timers (profiling.timer) and the solver counters
+(profiling.counters_file) are collected into a scaling table.
+
+  * strong scaling: the build is the same for all the numbers of processors,
+  * weak scaling: the length of the part (and therefore the number of cells
+    and the number of hatches per layer) grows linearly with the number of
+    processors.
+
+Example:
+  ./run_scaling.py --adamantine ../build/bin/adamantine \\
+      --template ../tests/data/demo_316_short.info --ranks 1 2 4 8 \\
+      --mode strong --duration 2e-3
+"""
+
+import argparse
+import copy
+import csv
+import os
+import re
+import subprocess
+import sys
+
+import generate_build
+
+TIMER_REGEX = re.compile(r'Time elapsed in (.+): (\d+(?:\.\d+)?)')
+
+
+def parse_timers(output):
+    """Return a dictionary section -> time in seconds. The timers are printed
+    in milliseconds by rank 0."""
+    timers = {}
+    for line in output.splitlines():
+        match = TIMER_REGEX.search(line)
+        if match:
+            timers[match.group(1)] = float(match.group(2)) / 1000.
+    return timers
+
+
+def parse_counters(filename):
+    """Return the summary of the counters written by adamantine."""
+    summary = {'n_time_steps': 0, 'max_n_active_dofs': 0,
+               'max_n_active_cells': 0, 'operator_applications': 0,
+               'gmres_iterations': 0, 'newton_iterations': 0,
+               'rejected_steps': 0, 'vmult_dofs_per_second': 0.}
+    if not os.path.exists(filename):
+        return summary
+    throughputs = []
+    with open(filename) as f:
+        for row in csv.DictReader(f):
+            summary['n_time_steps'] += 1
+            summary['max_n_active_dofs'] = max(summary['max_n_active_dofs'],
+                                               int(row['n_active_dofs']))
+            summary['max_n_active_cells'] = max(
+                summary['max_n_active_cells'], int(row['n_active_cells']))
+            for key in ['operator_applications', 'gmres_iterations',
+                        'newton_iterations', 'rejected_steps']:
+                summary[key] += int(row[key])
+            if float(row['vmult_dofs_per_second']) > 0.:
+                throughputs.append(float(row['vmult_dofs_per_second']))
+    if throughputs:
+        summary['vmult_dofs_per_second'] = sum(throughputs) / len(throughputs)
+    return summary
+
+
+def run_case(args, n_ranks):
+    build_args = copy.copy(args)
+    build_args.prefix = '{}_{}_{}'.format(args.prefix, args.mode, n_ranks)
+    if args.mode == 'weak':
+        build_args.length = args.length * n_ranks
+    input_file, _ = generate_build.generate_build(build_args)
+
+    command = [args.mpiexec, '-n', str(n_ranks), args.adamantine,
+               '--input-file=' + input_file]
+    print(' '.join(command), flush=True)
+    result = subprocess.run(command, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT, universal_newlines=True)
+    with open(build_args.prefix + '.log', 'w') as log:
+        log.write(result.stdout)
+    if result.returncode != 0:
+        print('adamantine failed, see ' + build_args.prefix + '.log',
+              file=sys.stderr)
+
+    row = {'n_ranks': n_ranks, 'length': build_args.length,
+           'status': 'ok' if result.returncode == 0 else 'failed'}
+    row.update(parse_counters(build_args.prefix + '_counters.csv'))
+    row.update(parse_timers(result.stdout))
+    return row
+
+
+def write_table(rows, mode, filename):
+    """Write the table as CSV and print it. The efficiency is computed with
+    respect to the first number of processors."""
+    reference = rows[0]
+    for row in rows:
+        total = row.get('Main')
+        reference_total = reference.get('Main')
+        if total and reference_total:
+            if mode == 'strong':
+                row['efficiency'] = reference_total * reference['n_ranks'] / \
+                    (total * row['n_ranks'])
+            else:
+                row['efficiency'] = reference_total / total
+        row['dofs_per_rank'] = row['max_n_active_dofs'] / row['n_ranks']
+    columns = []
+    for row in rows:
+        for key in row:
+            if key not in columns:
+                columns.append(key)
+
+    with open(filename, 'w', newline='') as f:
+        writer = csv.DictWriter(f, fieldnames=columns)
+        writer.writeheader()
+        writer.writerows(rows)
+
+    print()
+    print(' | '.join(columns))
+    for row in rows:
+        print(' | '.join('{:.4g}'.format(row[c]) if isinstance(row.get(c),
+                                                                float)
+                         else str(row.get(c, '')) for c in columns))
+    print('\nWrote ' + filename)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawTextHelpFormatter)
+    generate_build.add_arguments(parser)
+    parser.add_argument('--adamantine', required=True,
+                        help='path to the adamantine executable')
+    parser.add_argument('--mpiexec', default='mpirun',
+                        help='MPI launcher (default: mpirun)')
+    parser.add_argument('--ranks', type=int, nargs='+', default=[1, 2, 4],
+                        help='numbers of processors')
+    parser.add_argument('--mode', choices=['strong', 'weak'], default='strong',
+                        help='type of scaling study')
+    args = parser.parse_args()
+
+    rows = [run_case(args, n_ranks) for n_ranks in args.ranks]
+    write_table(rows, args.mode, '{}_{}_scaling.csv'.format(args.prefix,
+                                                              args.mode))
@@ -0,0 +1,226 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <CartesianIndex.hh>
+#include <instantiation.hh>
+
+#include <algorithm>
+#include <cmath>
+
+namespace adamantine
+{
+namespace
+{
+/**
+ * Return true if the closed boxes @p box_1 and @p box_2 intersect.
+ */
+template <int dim>
+bool intersect_closed(dealii::BoundingBox<dim> const &box_1,
+                      dealii::BoundingBox<dim> const &box_2)
+{
+  auto const &[lower_1, upper_1] = box_1.get_boundary_points();
+  auto const &[lower_2, upper_2] = box_2.get_boundary_points();
+  for (int d = 0; d < dim; ++d)
+    if ((lower_1[d] > upper_2[d]) || (lower_2[d] > upper_1[d]))
+      return false;
+
+  return true;
+}
+} // namespace
+
+template <int dim>
+CartesianIndex<dim>::CartesianIndex(dealii::DoFHandler<dim> const &dof_handler)
+    : _dof_handler(dof_handler)
+{
+  // Collect the coordinates of the faces of the coarse cells and check that
+  // the cells are axis-aligned boxes.
+  unsigned int n_coarse_cells = 0;
+  for (auto const &cell : dof_handler.cell_iterators_on_level(0))
+  {
+    auto const [lower, upper] = cell->bounding_box().get_boundary_points();
+    double const tolerance = 1e-10 * cell->diameter();
+    for (auto const v : cell->vertex_indices())
+      for (int d = 0; d < dim; ++d)
+        if (std::min(std::abs(cell->vertex(v)[d] - lower[d]),
+                     std::abs(cell->vertex(v)[d] - upper[d])) > tolerance)
+          return;
+    for (int d = 0; d < dim; ++d)
+    {
+      _coordinates[d].push_back(lower[d]);
+      _coordinates[d].push_back(upper[d]);
+    }
+    ++n_coarse_cells;
+  }
+  if (n_coarse_cells == 0)
+    return;
+
+  unsigned int n_lattice_cells = 1;
+  for (int d = 0; d < dim; ++d)
+  {
+    auto &coordinates = _coordinates[d];
+    std::sort(coordinates.begin(), coordinates.end());
+    double const tolerance = 1e-10 * (coordinates.back() - coordinates.front());
+    auto equal = [&](double a, double b) { return b - a <= tolerance; };
+    coordinates.erase(
+        std::unique(coordinates.begin(), coordinates.end(), equal),
+        coordinates.end());
+    n_lattice_cells *= coordinates.size() - 1;
+  }
+  if (n_lattice_cells != n_coarse_cells)
+    return;
+
+  // Every coarse cell must fill exactly one cell of the lattice.
+  _coarse_cells.resize(n_lattice_cells);
+  std::vector<bool> filled(n_lattice_cells, false);
+  for (auto const &cell : dof_handler.cell_iterators_on_level(0))
+  {
+    auto const [lower, upper] = cell->bounding_box().get_boundary_points();
+    double const tolerance = 1e-10 * cell->diameter();
+    unsigned int lattice_index = 0;
+    unsigned int stride = 1;
+    for (int d = 0; d < dim; ++d)
+    {
+      auto const &coordinates = _coordinates[d];
+      unsigned int const i =
+          std::lower_bound(coordinates.begin(), coordinates.end(),
+                           lower[d] - tolerance) -
+          coordinates.begin();
+      if ((i + 1 >= coordinates.size()) ||
+          (std::abs(coordinates[i + 1] - upper[d]) > tolerance))
+        return;
+      lattice_index += i * stride;
+      stride *= coordinates.size() - 1;
+    }
+    if (filled[lattice_index])
+      return;
+    filled[lattice_index] = true;
+    _coarse_cells[lattice_index] = cell;
+  }
+
+  _is_cartesian = true;
+}
+
+template <int dim>
+std::vector<typename dealii::DoFHandler<dim>::active_cell_iterator>
+CartesianIndex<dim>::intersect(
+    dealii::BoundingBox<dim> const &bounding_box) const
+{
+  std::vector<typename dealii::DoFHandler<dim>::active_cell_iterator> cells;
+  if (!_is_cartesian)
+    return cells;
+
+  // Find the range of coarse cells intersecting the box along every axis.
+  auto const &[lower, upper] = bounding_box.get_boundary_points();
+  std::array<unsigned int, dim> first;
+  std::array<unsigned int, dim> last;
+  for (int d = 0; d < dim; ++d)
+  {
+    auto const &coordinates = _coordinates[d];
+    // First cell whose upper face is not below the box and last cell whose
+    // lower face is not above the box.
+    auto const first_it =
+        std::lower_bound(coordinates.begin() + 1, coordinates.end(), lower[d]);
+    auto const last_it =
+        std::upper_bound(coordinates.begin(), coordinates.end() - 1, upper[d]);
+    if ((first_it == coordinates.end()) || (last_it == coordinates.begin()))
+      return cells;
+    first[d] = first_it - (coordinates.begin() + 1);
+    last[d] = last_it - coordinates.begin() - 1;
+    if (first[d] > last[d])
+      return cells;
+  }
+
+  // Loop over the coarse cells in the range and descend their refinement
+  // trees.
+  unsigned int n_cells = 1;
+  for (int d = 0; d < dim; ++d)
+    n_cells *= last[d] - first[d] + 1;
+  for (unsigned int n = 0; n < n_cells; ++n)
+  {
+    unsigned int lattice_index = 0;
+    unsigned int stride = 1;
+    unsigned int remainder = n;
+    for (int d = 0; d < dim; ++d)
+    {
+      unsigned int const range = last[d] - first[d] + 1;
+      lattice_index += (first[d] + remainder % range) * stride;
+      remainder /= range;
+      stride *= _coordinates[d].size() - 1;
+    }
+    add_active_cells(_coarse_cells[lattice_index], bounding_box, cells);
+  }
+
+  // Use the same order as the active cell iterators so that the result does
+  // not depend on the order of the traversal.
+  std::sort(cells.begin(), cells.end());
+
+  return cells;
+}
+
+template <int dim>
+typename dealii::DoFHandler<dim>::active_cell_iterator
+CartesianIndex<dim>::find_active_cell(dealii::Point<dim> const &point) const
+{
+  typename dealii::DoFHandler<dim>::active_cell_iterator const end(
+      _dof_handler.end());
+  if (!_is_cartesian)
+    return end;
+
+  unsigned int lattice_index = 0;
+  unsigned int stride = 1;
+  for (int d = 0; d < dim; ++d)
+  {
+    auto const &coordinates = _coordinates[d];
+    if ((point[d] < coordinates.front()) || (point[d] > coordinates.back()))
+      return end;
+    unsigned int const i = std::min<unsigned int>(
+        std::upper_bound(coordinates.begin(), coordinates.end(), point[d]) -
+            coordinates.begin() - 1,
+        coordinates.size() - 2);
+    lattice_index += i * stride;
+    stride *= coordinates.size() - 1;
+  }
+
+  // With isotropic refinement of a box, the children are numbered
+  // lexicographically, the x index running fastest.
+  auto cell = _coarse_cells[lattice_index];
+  while (cell->has_children())
+  {
+    dealii::Point<dim> const center = cell->center();
+    unsigned int child = 0;
+    for (int d = 0; d < dim; ++d)
+      if (point[d] >= center[d])
+        child += 1 << d;
+    cell = cell->child(child);
+  }
+
+  return typename dealii::DoFHandler<dim>::active_cell_iterator(cell);
+}
+
+template <int dim>
+void CartesianIndex<dim>::add_active_cells(
+    typename dealii::DoFHandler<dim>::cell_iterator const &cell,
+    dealii::BoundingBox<dim> const &bounding_box,
+    std::vector<typename dealii::DoFHandler<dim>::active_cell_iterator> &cells)
+    const
+{
+  if (!intersect_closed(cell->bounding_box(), bounding_box))
+    return;
+
+  if (cell->is_active())
+  {
+    cells.emplace_back(cell);
+  }
+  else
+  {
+    for (unsigned int i = 0; i < cell->n_children(); ++i)
+      add_active_cells(cell->child(i), bounding_box, cells);
+  }
+}
+} // namespace adamantine
+
+INSTANTIATE_DIM(CartesianIndex)
@@ -0,0 +1,98 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#ifndef CARTESIAN_INDEX_HH
+#define CARTESIAN_INDEX_HH
+
+#include <deal.II/base/bounding_box.h>
+#include <deal.II/dofs/dof_handler.h>
+
+#include <array>
+#include <vector>
+
+namespace adamantine
+{
+/**
+ * This class answers point and box queries on a mesh whose coarse cells form
+ * a Cartesian lattice of axis-aligned boxes, for instance the mesh created by
+ * GridGenerator::subdivided_hyper_rectangle. The coarse cell containing a
+ * point is found using a binary search along every axis and the active cells
+ * are then found by descending the refinement tree of the coarse cell. Unlike
+ * a bounding volume hierarchy, nothing needs to be built when the mesh is
+ * refined. The class assumes that the refinement is isotropic.
+ */
+template <int dim>
+class CartesianIndex
+{
+public:
+  /**
+   * Constructor. The coarse cells of @p dof_handler are checked to form a
+   * Cartesian lattice. If this is not the case, is_cartesian() returns false
+   * and the index cannot be used.
+   */
+  CartesianIndex(dealii::DoFHandler<dim> const &dof_handler);
+
+  /**
+   * Return true if the coarse cells form a Cartesian lattice.
+   */
+  bool is_cartesian() const;
+
+  /**
+   * Return the active cells that intersect @p bounding_box. The boundary of
+   * the cells and of the box are included. The cells are sorted in the order
+   * of DoFHandler::active_cell_iterators(). Only the cells that exist on this
+   * processor are returned, i.e., some of them may be ghost or artificial
+   * cells.
+   */
+  std::vector<typename dealii::DoFHandler<dim>::active_cell_iterator>
+  intersect(dealii::BoundingBox<dim> const &bounding_box) const;
+
+  /**
+   * Return the active cell that contains @p point. If the point is outside of
+   * the domain, DoFHandler::end() is returned.
+   */
+  typename dealii::DoFHandler<dim>::active_cell_iterator
+  find_active_cell(dealii::Point<dim> const &point) const;
+
+private:
+  /**
+   * Add to @p cells the active descendants of @p cell that intersect @p
+   * bounding_box.
+   */
+  void add_active_cells(
+      typename dealii::DoFHandler<dim>::cell_iterator const &cell,
+      dealii::BoundingBox<dim> const &bounding_box,
+      std::vector<typename dealii::DoFHandler<dim>::active_cell_iterator>
+          &cells) const;
+
+  /**
+   * DoFHandler associated with the mesh.
+   */
+  dealii::DoFHandler<dim> const &_dof_handler;
+  /**
+   * Flag is true if the coarse cells form a Cartesian lattice.
+   */
+  bool _is_cartesian = false;
+  /**
+   * Sorted coordinates of the faces of the coarse cells along every axis.
+   */
+  std::array<std::vector<double>, dim> _coordinates;
+  /**
+   * Coarse cells ordered lexicographically in the lattice, the x index
+   * running fastest.
+   */
+  std::vector<typename dealii::DoFHandler<dim>::cell_iterator> _coarse_cells;
+};
+
+template <int dim>
+inline bool CartesianIndex<dim>::is_cartesian() const
+{
+  return _is_cartesian;
+}
+} // namespace adamantine
+
+#endif
@@ -0,0 +1,133 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <CellDiagnostics.hh>
+#include <instantiation.hh>
+#include <utils.hh>
+
+#include <algorithm>
+
+namespace adamantine
+{
+template <int dim>
+CellDiagnostics<dim>::CellDiagnostics(double const melting_temperature)
+    : _melting_temperature(melting_temperature)
+{
+  add("max_temperature", Reduction::max,
+      [](CellValues const &cell_values)
+      { return cell_values.max_temperature; });
+  add("min_temperature", Reduction::min,
+      [](CellValues const &cell_values)
+      { return cell_values.min_temperature; });
+  add("activated_volume", Reduction::sum,
+      [](CellValues const &cell_values) { return cell_values.volume; });
+  add("melt_pool_volume", Reduction::sum,
+      [melting_temperature](CellValues const &cell_values)
+      {
+        return cell_values.average_temperature > melting_temperature
+                   ? cell_values.volume
+                   : 0.;
+      });
+}
+
+template <int dim>
+void CellDiagnostics<dim>::add(
+    std::string const &name, Reduction const reduction,
+    std::function<double(CellValues const &)> const &cell_value)
+{
+  ASSERT_THROW(std::find(_names.begin(), _names.end(), name) == _names.end(),
+               "Error: The diagnostic " + name + " already exists.");
+  _names.push_back(name);
+  _reductions.push_back(reduction);
+  _cell_values.push_back(cell_value);
+}
+
+template <int dim>
+void CellDiagnostics<dim>::reset(unsigned int const n_active_cells)
+{
+  _local_values.resize(_names.size());
+  for (unsigned int i = 0; i < _names.size(); ++i)
+  {
+    switch (_reductions[i])
+    {
+    case Reduction::sum:
+      _local_values[i] = 0.;
+      break;
+    case Reduction::min:
+      _local_values[i] = std::numeric_limits<double>::max();
+      break;
+    case Reduction::max:
+      _local_values[i] = std::numeric_limits<double>::lowest();
+      break;
+    }
+  }
+  _values.clear();
+  _melted_cells.assign(n_active_cells, false);
+}
+
+template <int dim>
+void CellDiagnostics<dim>::add_cell(CellValues const &cell_values)
+{
+  for (unsigned int i = 0; i < _names.size(); ++i)
+  {
+    double const value = _cell_values[i](cell_values);
+    switch (_reductions[i])
+    {
+    case Reduction::sum:
+      _local_values[i] += value;
+      break;
+    case Reduction::min:
+      _local_values[i] = std::min(_local_values[i], value);
+      break;
+    case Reduction::max:
+      _local_values[i] = std::max(_local_values[i], value);
+      break;
+    }
+  }
+
+  if (cell_values.average_temperature > _melting_temperature)
+    _melted_cells[cell_values.cell->active_cell_index()] = true;
+}
+
+template <int dim>
+void CellDiagnostics<dim>::reduce(MPI_Comm const &communicator)
+{
+  // min_max_avg computes the sum, the minimum, and the maximum of every entry
+  // with a single reduction.
+  std::vector<dealii::Utilities::MPI::MinMaxAvg> const min_max_sum =
+      dealii::Utilities::MPI::min_max_avg(_local_values, communicator);
+  _values.resize(_names.size());
+  for (unsigned int i = 0; i < _names.size(); ++i)
+  {
+    switch (_reductions[i])
+    {
+    case Reduction::sum:
+      _values[i] = min_max_sum[i].sum;
+      break;
+    case Reduction::min:
+      _values[i] = min_max_sum[i].min;
+      break;
+    case Reduction::max:
+      _values[i] = min_max_sum[i].max;
+      break;
+    }
+  }
+}
+
+template <int dim>
+double CellDiagnostics<dim>::get(std::string const &name) const
+{
+  auto const it = std::find(_names.begin(), _names.end(), name);
+  ASSERT_THROW(it != _names.end(), "Error: Unknown diagnostic " + name + ".");
+  ASSERT_THROW(_values.size() == _names.size(),
+               "Error: The diagnostics have not been reduced.");
+
+  return _values[it - _names.begin()];
+}
+} // namespace adamantine
+
+INSTANTIATE_DIM(CellDiagnostics)
@@ -0,0 +1,153 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#ifndef CELL_DIAGNOSTICS_HH
+#define CELL_DIAGNOSTICS_HH
+
+#include <deal.II/base/mpi.h>
+#include <deal.II/dofs/dof_handler.h>
+
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace adamantine
+{
+/**
+ * This class gathers quantities computed on every activated cell during a
+ * single pass over the temperature, for instance by
+ * ThermalOperatorBase::compute_cell_diagnostics. Every quantity is reduced
+ * locally while the cells are visited and all the quantities are then reduced
+ * over the processors using a single MPI reduction. The following quantities
+ * are always computed:
+ *   - <B>max_temperature</B>: largest temperature
+ *   - <B>min_temperature</B>: smallest temperature
+ *   - <B>activated_volume</B>: volume of the activated cells
+ *   - <B>melt_pool_volume</B>: volume of the cells whose average temperature
+ *     is larger than the melting temperature
+ * Other quantities can be added using add(). The cells whose average
+ * temperature is larger than the melting temperature are also flagged.
+ */
+template <int dim>
+class CellDiagnostics
+{
+public:
+  /**
+   * Operation used to reduce the values of the cells.
+   */
+  enum class Reduction
+  {
+    sum,
+    min,
+    max
+  };
+
+  /**
+   * Values computed on a cell and passed to the functions that define the
+   * quantities.
+   */
+  struct CellValues
+  {
+    typename dealii::DoFHandler<dim>::cell_iterator cell;
+    double average_temperature;
+    double min_temperature;
+    double max_temperature;
+    double volume;
+  };
+
+  /**
+   * Constructor.
+   */
+  CellDiagnostics(double const melting_temperature =
+                      std::numeric_limits<double>::infinity());
+
+  /**
+   * Add the quantity @p name. @p cell_value returns the contribution of a cell
+   * which is reduced using @p reduction.
+   */
+  void add(std::string const &name, Reduction const reduction,
+           std::function<double(CellValues const &)> const &cell_value);
+
+  /**
+   * Reset the local values before a new pass over the cells. @p n_active_cells
+   * is the number of active cells of the processor.
+   */
+  void reset(unsigned int const n_active_cells);
+
+  /**
+   * Add the contribution of a cell to every quantity.
+   */
+  void add_cell(CellValues const &cell_values);
+
+  /**
+   * Reduce the quantities over the processors. This function is collective.
+   */
+  void reduce(MPI_Comm const &communicator);
+
+  /**
+   * Return the value of the quantity @p name after the reduction.
+   */
+  double get(std::string const &name) const;
+
+  /**
+   * Return the names of the quantities in the order they were added.
+   */
+  std::vector<std::string> const &get_names() const;
+
+  /**
+   * Return the flags of the cells of this processor, indexed by the active
+   * cell index, whose average temperature is larger than the melting
+   * temperature.
+   */
+  std::vector<bool> const &get_melted_cells() const;
+
+private:
+  /**
+   * Temperature above which a cell is part of the melt pool.
+   */
+  double _melting_temperature;
+  /**
+   * Names of the quantities.
+   */
+  std::vector<std::string> _names;
+  /**
+   * Reduction used for every quantity.
+   */
+  std::vector<Reduction> _reductions;
+  /**
+   * Functions returning the contribution of a cell to every quantity.
+   */
+  std::vector<std::function<double(CellValues const &)>> _cell_values;
+  /**
+   * Values of the quantities reduced over the cells of this processor.
+   */
+  std::vector<double> _local_values;
+  /**
+   * Values of the quantities reduced over all the processors.
+   */
+  std::vector<double> _values;
+  /**
+   * Flags of the cells that are above the melting temperature.
+   */
+  std::vector<bool> _melted_cells;
+};
+
+template <int dim>
+inline std::vector<std::string> const &CellDiagnostics<dim>::get_names() const
+{
+  return _names;
+}
+
+template <int dim>
+inline std::vector<bool> const &CellDiagnostics<dim>::get_melted_cells() const
+{
+  return _melted_cells;
+}
+} // namespace adamantine
+
+#endif
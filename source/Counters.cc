@@ -0,0 +1,66 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <Counters.hh>
+
+namespace adamantine
+{
+Counters::Counters() { _counters.fill(0); }
+
+void Counters::increment(Counting counter, unsigned long long value)
+{
+  _counters[counter] += value;
+}
+
+void Counters::set(Counting counter, unsigned long long value)
+{
+  _counters[counter] = value;
+}
+
+unsigned long long Counters::get(Counting counter) const
+{
+  return _counters[counter];
+}
+
+void Counters::add_vmult(unsigned long long n_dofs, double elapsed_time)
+{
+  _vmult_dofs += n_dofs;
+  _vmult_time += elapsed_time;
+}
+
+double Counters::get_vmult_throughput() const
+{
+  return _vmult_time > 0. ? static_cast<double>(_vmult_dofs) / _vmult_time
+                          : 0.;
+}
+
+void Counters::reset()
+{
+  // The counters before n_active_dofs accumulate work over a time step. The
+  // other ones describe the size of the problem and they are not reset.
+  for (unsigned int i = 0; i < n_active_dofs; ++i)
+    _counters[i] = 0;
+  _vmult_dofs = 0;
+  _vmult_time = 0.;
+}
+
+void Counters::write_csv_header(std::ostream &out)
+{
+  out << "time_step,time,operator_applications,rk_stages,newton_iterations,"
+         "gmres_iterations,cg_iterations,rejected_steps,n_active_dofs,"
+         "n_active_cells,vmult_dofs_per_second\n";
+}
+
+void Counters::write_csv_row(std::ostream &out, unsigned int n_time_step,
+                             double time) const
+{
+  out << n_time_step << "," << time;
+  for (auto const counter : _counters)
+    out << "," << counter;
+  out << "," << get_vmult_throughput() << "\n";
+}
+} // namespace adamantine
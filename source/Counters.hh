@@ -0,0 +1,94 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#ifndef COUNTERS_HH
+#define COUNTERS_HH
+
+#include <types.hh>
+
+#include <array>
+#include <ostream>
+
+namespace adamantine
+{
+/**
+ * This class stores the solver and throughput counters of a time step. The
+ * counters that accumulate work (operator applications, RK stages, solver
+ * iterations, ...) are reset at the beginning of every time step. The counters
+ * that describe the size of the problem (number of active degrees of freedom
+ * and number of active cells) keep their value until they are set again. All
+ * the counters are global, i.e., they have the same value on every processor.
+ */
+class Counters
+{
+public:
+  /**
+   * Constructor.
+   */
+  Counters();
+
+  /**
+   * Increment the counter @p counter by @p value.
+   */
+  void increment(Counting counter, unsigned long long value = 1);
+
+  /**
+   * Set the value of the counter @p counter.
+   */
+  void set(Counting counter, unsigned long long value);
+
+  /**
+   * Return the value of the counter @p counter.
+   */
+  unsigned long long get(Counting counter) const;
+
+  /**
+   * Record an application of the ThermalOperator on @p n_dofs degrees of
+   * freedom that took @p elapsed_time seconds (wall clock).
+   */
+  void add_vmult(unsigned long long n_dofs, double elapsed_time);
+
+  /**
+   * Return the throughput of the ThermalOperator in DoFs/s since the last call
+   * to reset().
+   */
+  double get_vmult_throughput() const;
+
+  /**
+   * Reset to zero the counters that accumulate work over a time step.
+   */
+  void reset();
+
+  /**
+   * Write the header of the CSV file.
+   */
+  static void write_csv_header(std::ostream &out);
+
+  /**
+   * Write the counters of the time step @p n_time_step ending at @p time as
+   * one row of a CSV file.
+   */
+  void write_csv_row(std::ostream &out, unsigned int n_time_step,
+                     double time) const;
+
+private:
+  /**
+   * Values of the counters.
+   */
+  std::array<unsigned long long, n_counters> _counters;
+  /**
+   * Number of degrees of freedom processed by the ThermalOperator.
+   */
+  unsigned long long _vmult_dofs = 0;
+  /**
+   * Time spent in the ThermalOperator in seconds.
+   */
+  double _vmult_time = 0.;
+};
+} // namespace adamantine
+
+#endif
@@ -1,4 +1,4 @@
-/* Copyright (c) 2021-2022, the adamantine authors.
+/* Copyright (c) 2021-2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -9,6 +9,7 @@
 #include <utils.hh>
 
 #include <deal.II/arborx/distributed_tree.h>
+#include <deal.II/base/memory_consumption.h>
 #include <deal.II/dofs/dof_tools.h>
 #include <deal.II/fe/mapping_q1.h>
 #include <deal.II/lac/block_vector.h>
@@ -268,6 +269,15 @@ DataAssimilator::calc_H(dealii::SparsityPattern &pattern) const
   return H;
 }
 
+std::size_t DataAssimilator::memory_consumption() const
+{
+  return _covariance_sparsity_pattern.memory_consumption() +
+         dealii::MemoryConsumption::memory_consumption(
+             _expt_to_dof_mapping.first) +
+         dealii::MemoryConsumption::memory_consumption(
+             _expt_to_dof_mapping.second);
+}
+
 template <int dim>
 void DataAssimilator::update_dof_mapping(
     std::pair<std::vector<int>, std::vector<int>> const &expt_to_dof_mapping)
@@ -109,6 +109,13 @@ public:
   update_covariance_sparsity_pattern(dealii::DoFHandler<dim> const &dof_handler,
                                      const unsigned int parameter_size);
 
+  /**
+   * Return an estimate of the memory used by the sparsity pattern of the
+   * covariance matrix and by the mapping between the observations and the
+   * degrees of freedom in bytes.
+   */
+  std::size_t memory_consumption() const;
+
 private:
   /**
    * This calculates the Kalman gain and applies it to the perturbed innovation.
@@ -1,4 +1,4 @@
-/* Copyright (c) 2016 - 2021, the adamantine authors.
+/* Copyright (c) 2016 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -13,12 +13,156 @@
 #include <types.hh>
 #include <utils.hh>
 
+#include <deal.II/base/mpi.h>
 #include <deal.II/grid/filtered_iterator.h>
 #include <deal.II/grid/grid_generator.h>
 #include <deal.II/grid/grid_in.h>
+#include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/tria_description.h>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <tuple>
+#include <vector>
 
 namespace adamantine
 {
+namespace
+{
+/**
+ * Read the mesh in @p mesh_file using GridIn.
+ */
+template <int dim>
+void read_mesh(std::string const &mesh_file, std::string const &mesh_format,
+               dealii::Triangulation<dim> &triangulation)
+{
+  dealii::GridIn<dim> grid_in;
+  grid_in.attach_triangulation(triangulation);
+  typename dealii::GridIn<dim>::Format grid_in_format;
+  if (mesh_format == "abaqus")
+  {
+    grid_in_format = dealii::GridIn<dim>::Format::abaqus;
+  }
+  else if (mesh_format == "assimp")
+  {
+    grid_in_format = dealii::GridIn<dim>::Format::assimp;
+  }
+  else if (mesh_format == "unv")
+  {
+    grid_in_format = dealii::GridIn<dim>::Format::unv;
+  }
+  else if (mesh_format == "ucd")
+  {
+    grid_in_format = dealii::GridIn<dim>::Format::ucd;
+  }
+  else if (mesh_format == "dbmesh")
+  {
+    grid_in_format = dealii::GridIn<dim>::Format::dbmesh;
+  }
+  else if (mesh_format == "gmsh")
+  {
+    grid_in_format = dealii::GridIn<dim>::Format::msh;
+  }
+  else if (mesh_format == "tecplot")
+  {
+    grid_in_format = dealii::GridIn<dim>::Format::tecplot;
+  }
+  else if (mesh_format == "xda")
+  {
+    grid_in_format = dealii::GridIn<dim>::Format::xda;
+  }
+  else if (mesh_format == "vtk")
+  {
+    grid_in_format = dealii::GridIn<dim>::Format::vtk;
+  }
+  else if (mesh_format == "vtu")
+  {
+    grid_in_format = dealii::GridIn<dim>::Format::vtu;
+  }
+  else if (mesh_format == "exodusii")
+  {
+    grid_in_format = dealii::GridIn<dim>::Format::exodusii;
+  }
+  else
+  {
+    grid_in_format = dealii::GridIn<dim>::Format::Default;
+  }
+
+  grid_in.read(mesh_file, grid_in_format);
+}
+
+/**
+ * Return the height of the coarse cells along the z axis. Below @p
+ * material_height, the cells have the size given by @p height_divisions.
+ * Above @p material_height, the cells have the thickness of a deposited layer.
+ * The last layer is shrunk to fit the domain.
+ */
+std::vector<double> compute_layer_aligned_step_sizes(
+    double const height, unsigned int const height_divisions,
+    double const material_height, double const layer_thickness)
+{
+  std::vector<double> step_sizes;
+  double const substrate_height = std::min(material_height, height);
+  if (substrate_height > 0.)
+  {
+    unsigned int const n_substrate_cells = std::max(
+        1u, static_cast<unsigned int>(std::round(
+                substrate_height * height_divisions / height)));
+    step_sizes.assign(n_substrate_cells, substrate_height / n_substrate_cells);
+  }
+
+  double z = substrate_height;
+  // Ignore layers thinner than 1% of the layer thickness due to roundoff.
+  while (height - z > 1e-2 * layer_thickness)
+  {
+    double const step = std::min(layer_thickness, height - z);
+    step_sizes.push_back(step);
+    z += step;
+  }
+
+  return step_sizes;
+}
+
+/**
+ * Return the name of the file used to cache the triangulation read from @p
+ * mesh_file. The name contains a hash of the content of the mesh file so that
+ * the cache is not used if the mesh file is modified.
+ */
+template <int dim>
+std::string get_mesh_cache_filename(std::string const &mesh_file,
+                                    std::string const &mesh_format,
+                                    std::string const &mesh_cache_directory)
+{
+  std::ifstream file(mesh_file, std::ios::binary);
+  ASSERT_THROW(file.good(), "Error: Cannot open the mesh file " + mesh_file);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  // Use 64-bit FNV-1a because, unlike std::hash, the value is the same for all
+  // the compilers.
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (char c : buffer.str() + mesh_format)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  std::stringstream filename;
+  filename << std::filesystem::path(mesh_file).stem().string() << "_"
+           << std::hex << hash << "_" << std::dec << dim << "d.tria";
+
+  return (std::filesystem::path(mesh_cache_directory) / filename.str())
+      .string();
+}
+} // namespace
+
 template <int dim>
 Geometry<dim>::Geometry(MPI_Comm const &communicator,
                         boost::property_tree::ptree const &database)
@@ -33,61 +177,80 @@ Geometry<dim>::Geometry(MPI_Comm const &communicator,
     std::string mesh_file = database.get<std::string>("mesh_file");
     // PropertyTreeInput geometry.mesh_format
     std::string mesh_format = database.get<std::string>("mesh_format");
-    dealii::Triangulation<dim> serial_triangulation;
-    dealii::GridIn<dim> grid_in;
-    grid_in.attach_triangulation(serial_triangulation);
-    typename dealii::GridIn<dim>::Format grid_in_format;
-    if (mesh_format == "abaqus")
-    {
-      grid_in_format = dealii::GridIn<dim>::Format::abaqus;
-    }
-    else if (mesh_format == "assimp")
-    {
-      grid_in_format = dealii::GridIn<dim>::Format::assimp;
-    }
-    else if (mesh_format == "unv")
-    {
-      grid_in_format = dealii::GridIn<dim>::Format::unv;
-    }
-    else if (mesh_format == "ucd")
-    {
-      grid_in_format = dealii::GridIn<dim>::Format::ucd;
-    }
-    else if (mesh_format == "dbmesh")
-    {
-      grid_in_format = dealii::GridIn<dim>::Format::dbmesh;
-    }
-    else if (mesh_format == "gmsh")
-    {
-      grid_in_format = dealii::GridIn<dim>::Format::msh;
-    }
-    else if (mesh_format == "tecplot")
-    {
-      grid_in_format = dealii::GridIn<dim>::Format::tecplot;
-    }
-    else if (mesh_format == "xda")
-    {
-      grid_in_format = dealii::GridIn<dim>::Format::xda;
-    }
-    else if (mesh_format == "vtk")
-    {
-      grid_in_format = dealii::GridIn<dim>::Format::vtk;
-    }
-    else if (mesh_format == "vtu")
-    {
-      grid_in_format = dealii::GridIn<dim>::Format::vtu;
-    }
-    else if (mesh_format == "exodusii")
+    // PropertyTreeInput geometry.mesh_cache_directory
+    boost::optional<std::string> mesh_cache_directory =
+        database.get_optional<std::string>("mesh_cache_directory");
+    // Only the first processor reads the mesh, either from the mesh file or
+    // from the cache, and the description of the coarse mesh is broadcast to
+    // the other processors. The mesh file is thus parsed only once and the
+    // other processors never store a serial copy of the coarse mesh.
+    unsigned int const rank =
+        dealii::Utilities::MPI::this_mpi_process(communicator);
+    std::vector<dealii::Point<dim>> vertices;
+    std::vector<dealii::CellData<dim>> cells;
+    dealii::SubCellData subcell_data;
+    // An error on the first processor must be reported to the other
+    // processors before the broadcast of the mesh, otherwise they would wait
+    // forever.
+    std::exception_ptr exception;
+    if (rank == 0)
     {
-      grid_in_format = dealii::GridIn<dim>::Format::exodusii;
-    }
-    else
-    {
-      grid_in_format = dealii::GridIn<dim>::Format::Default;
+      try
+      {
+        dealii::Triangulation<dim> serial_triangulation;
+        if (mesh_cache_directory)
+        {
+          // The name of the cache contains a hash of the mesh file.
+          std::string const cache_file = get_mesh_cache_filename<dim>(
+              mesh_file, mesh_format, mesh_cache_directory.get());
+          if (std::filesystem::exists(cache_file))
+          {
+            std::ifstream file(cache_file, std::ios::binary);
+            boost::archive::binary_iarchive archive(file);
+            archive >> serial_triangulation;
+          }
+          else
+          {
+            read_mesh(mesh_file, mesh_format, serial_triangulation);
+            // Write to a temporary file first so that another simulation never
+            // reads a partial cache.
+            std::filesystem::create_directories(mesh_cache_directory.get());
+            std::string const tmp_file = cache_file + ".tmp";
+            {
+              std::ofstream file(tmp_file, std::ios::binary);
+              boost::archive::binary_oarchive archive(file);
+              archive << serial_triangulation;
+            }
+            std::filesystem::rename(tmp_file, cache_file);
+          }
+        }
+        else
+        {
+          read_mesh(mesh_file, mesh_format, serial_triangulation);
+        }
+        std::tie(vertices, cells, subcell_data) =
+            dealii::GridTools::get_coarse_mesh_description(
+                serial_triangulation);
+      }
+      catch (...)
+      {
+        exception = std::current_exception();
+      }
     }
-
-    grid_in.read(mesh_file, grid_in_format);
-    _triangulation.copy_triangulation(serial_triangulation);
+    bool const failed = dealii::Utilities::MPI::broadcast(
+        communicator, static_cast<bool>(exception), 0);
+    if (exception)
+      std::rethrow_exception(exception);
+    ASSERT_THROW(!failed,
+                 "Error: The mesh could not be read on the first processor.");
+    vertices = dealii::Utilities::MPI::broadcast(communicator, vertices, 0);
+    cells = dealii::Utilities::MPI::broadcast(communicator, cells, 0);
+    subcell_data.boundary_lines = dealii::Utilities::MPI::broadcast(
+        communicator, subcell_data.boundary_lines, 0);
+    subcell_data.boundary_quads = dealii::Utilities::MPI::broadcast(
+        communicator, subcell_data.boundary_quads, 0);
+    // The material ids are stored in the cell data.
+    _triangulation.create_triangulation(vertices, cells, subcell_data);
   }
   else
   {
@@ -110,15 +273,86 @@ Geometry<dim>::Geometry(MPI_Comm const &communicator,
     if (dim == 3)
       p2[axis<dim>::y] = database.get<double>("width");
 
-    // For now we assume that the geometry is very simple.
-    dealii::GridGenerator::subdivided_hyper_rectangle(
-        _triangulation, repetitions, p1, p2, true);
+    // When the scan path and the deposition are symmetric with respect to the
+    // plane y = width / 2, only the half of the domain below the plane is
+    // meshed.
+    // PropertyTreeInput geometry.symmetry
+    bool const symmetry = database.get("symmetry", false);
+    if (symmetry)
+    {
+      ASSERT_THROW(dim == 3, "Error: The symmetry plane requires dim = 3.");
+      p2[axis<dim>::y] /= 2.;
+      repetitions[axis<dim>::y] =
+          std::max(1u, (repetitions[axis<dim>::y] + 1) / 2);
+    }
+
+    // p4est only supports isotropic refinement. Since the deposited layers
+    // are thin, the coarse cells above the material height can be aligned
+    // with the layers instead. The cells are then flat and they stay flat
+    // when they are refined, so the thickness of the layers is resolved with
+    // fewer cells in the plane of the layers.
+    // PropertyTreeInput geometry.layer_aligned_mesh
+    bool const layer_aligned_mesh = database.get("layer_aligned_mesh", false);
+    if (layer_aligned_mesh)
+    {
+      // PropertyTreeInput geometry.material_height
+      double const material_height = database.get("material_height", 1e9);
+      // By default, the layers have the height of the material deposition
+      // boxes.
+      // PropertyTreeInput geometry.layer_thickness
+      boost::optional<double> layer_thickness_optional =
+          database.get_optional<double>("layer_thickness");
+      if (!layer_thickness_optional)
+      {
+        // PropertyTreeInput geometry.deposition_height
+        layer_thickness_optional =
+            database.get_optional<double>("deposition_height");
+      }
+      ASSERT_THROW(layer_thickness_optional,
+                   "Error: The layer thickness of the layer aligned mesh must "
+                   "be specified.");
+      double const layer_thickness = layer_thickness_optional.get();
+      ASSERT_THROW(layer_thickness > 0.,
+                   "Error: The layer thickness must be positive.");
+
+      std::vector<std::vector<double>> step_sizes(dim);
+      for (int d = 0; d < dim; ++d)
+      {
+        if (d == axis<dim>::z)
+        {
+          step_sizes[d] = compute_layer_aligned_step_sizes(
+              p2[d], repetitions[d], material_height, layer_thickness);
+        }
+        else
+        {
+          step_sizes[d].assign(repetitions[d], p2[d] / repetitions[d]);
+        }
+      }
+      dealii::GridGenerator::subdivided_hyper_rectangle(
+          _triangulation, step_sizes, p1, p2, true);
+    }
+    else
+    {
+      // For now we assume that the geometry is very simple.
+      dealii::GridGenerator::subdivided_hyper_rectangle(
+          _triangulation, repetitions, p1, p2, true);
+    }
 
     // Assign the MaterialID.
     for (auto cell : _triangulation.active_cell_iterators())
     {
       cell->set_material_id(0);
     }
+
+    // With colorize, the faces at y = width / 2 have the boundary id 3.
+    if (symmetry)
+    {
+      for (auto cell : _triangulation.active_cell_iterators())
+        for (auto const f : cell->face_indices())
+          if ((cell->face(f)->at_boundary()) &&
+              (cell->face(f)->boundary_id() == 3))
+            cell->face(f)->set_boundary_id(g_symmetry_boundary_id);
+    }
   }
 
   assign_material_state(database);
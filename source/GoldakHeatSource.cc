@@ -1,4 +1,4 @@
-/* Copyright (c) 2020 - 2022, the adamantine authors.
+/* Copyright (c) 2020 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -14,19 +14,35 @@ namespace adamantine
 
 template <int dim>
 GoldakHeatSource<dim>::GoldakHeatSource(
-    boost::property_tree::ptree const &database)
-    : HeatSource<dim>(database)
+    boost::property_tree::ptree const &database, MPI_Comm const &communicator)
+    : HeatSource<dim>(database, communicator)
 {
 }
 
 template <int dim>
 void GoldakHeatSource<dim>::update_time(double time)
 {
-  _beam_center = this->_scan_path.value(time);
-  double segment_power_modifier = this->_scan_path.get_power_modifier(time);
-  _alpha = 2.0 * this->_beam.absorption_efficiency * this->_beam.max_power *
-           segment_power_modifier /
-           (this->_beam.radius_squared * this->_beam.depth * _pi_over_3_to_1p5);
+  // When the source is averaged in time, the beam is sampled at several
+  // positions along the scan path and each sample carries its share of the
+  // power.
+  auto const sample_times = this->get_sample_times(time);
+  double const alpha =
+      2.0 * this->_beam.absorption_efficiency * this->_beam.max_power /
+      (this->_beam.radius_squared * this->_beam.depth * _pi_over_3_to_1p5 *
+       sample_times.size());
+  _beam_centers.clear();
+  _alphas.clear();
+  for (auto const sample_time : sample_times)
+  {
+    double segment_power_modifier =
+        this->_scan_path.get_power_modifier(sample_time);
+    // Skip the samples where the beam is off.
+    if (segment_power_modifier > 0.)
+    {
+      _beam_centers.push_back(this->_scan_path.value(sample_time));
+      _alphas.push_back(alpha * segment_power_modifier);
+    }
+  }
 }
 
 template <int dim>
@@ -40,18 +56,23 @@ double GoldakHeatSource<dim>::value(dealii::Point<dim> const &point,
   }
   else
   {
-    double xpy_squared =
-        std::pow(point[axis<dim>::x] - _beam_center[axis<dim>::x], 2);
-    if (dim == 3)
+    // Goldak heat source equation
+    double const distribution_z =
+        std::exp(-3.0 * std::pow(z / this->_beam.depth, 2));
+    double heat_source = 0.;
+    for (unsigned int i = 0; i < _alphas.size(); ++i)
     {
-      xpy_squared +=
-          std::pow(point[axis<dim>::y] - _beam_center[axis<dim>::y], 2);
+      double xpy_squared =
+          std::pow(point[axis<dim>::x] - _beam_centers[i][axis<dim>::x], 2);
+      if (dim == 3)
+      {
+        xpy_squared +=
+            std::pow(point[axis<dim>::y] - _beam_centers[i][axis<dim>::y], 2);
+      }
+      heat_source += _alphas[i] *
+                     std::exp(-3.0 * xpy_squared / this->_beam.radius_squared);
     }
-
-    // Goldak heat source equation
-    double heat_source =
-        _alpha * std::exp(-3.0 * xpy_squared / this->_beam.radius_squared +
-                          -3.0 * std::pow(z / this->_beam.depth, 2));
+    heat_source *= distribution_z;
 
     return heat_source;
   }
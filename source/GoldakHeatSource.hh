@@ -1,4 +1,4 @@
-/* Copyright (c) 2020 - 2022, the adamantine authors.
+/* Copyright (c) 2020 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -30,11 +30,15 @@ public:
    *   - <B>max_power</B>: double in \f$[0, \infty)\f$
    *   - <B>input_file</B>: name of the file that contains the scan path
    *     segments
+   * \param[in] communicator is the communicator of the processors that share
+   * the scan path
    */
-  GoldakHeatSource(boost::property_tree::ptree const &database);
+  GoldakHeatSource(boost::property_tree::ptree const &database,
+                   MPI_Comm const &communicator = MPI_COMM_SELF);
 
   /**
-   * Set the time variable.
+   * Set the time variable. If the source is averaged in time and @p time is
+   * in the averaging window, the source is averaged over the window.
    */
   void update_time(double time) final;
 
@@ -46,8 +50,14 @@ public:
                double const height) const final;
 
 private:
-  dealii::Point<3> _beam_center;
-  double _alpha;
+  /**
+   * Positions of the beam at the times where the source is sampled.
+   */
+  std::vector<dealii::Point<3>> _beam_centers;
+  /**
+   * Amplitude of the source at the times where it is sampled.
+   */
+  std::vector<double> _alphas;
   double const _pi_over_3_to_1p5 = std::pow(dealii::numbers::PI / 3.0, 1.5);
 };
 } // namespace adamantine
@@ -1,4 +1,4 @@
-/* Copyright (c) 2020 - 2021, the adamantine authors.
+/* Copyright (c) 2020 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -14,6 +14,8 @@
 
 #include <deal.II/base/point.h>
 
+#include <vector>
+
 namespace adamantine
 {
 /**
@@ -48,13 +50,21 @@ public:
    *   - <B>max_power</B>: double in \f$[0, \infty)\f$
    *   - <B>input_file</B>: name of the file that contains the scan path
    *     segments
+   * and optionally:
+   *   - <B>time_averaging_samples</B>: unsigned int in \f$[1,\infty)\f$
+   * \param[in] communicator is the communicator of the processors that share
+   * the scan path
    */
-  HeatSource(boost::property_tree::ptree const &database)
+  HeatSource(boost::property_tree::ptree const &database,
+             MPI_Comm const &communicator = MPI_COMM_SELF)
       : _beam(database),
         // PropertyTreeInput sources.beam_X.scan_path_file
         // PropertyTreeInput sources.beam_X.scan_path_format
         _scan_path(database.get<std::string>("scan_path_file"),
-                   database.get<std::string>("scan_path_file_format"))
+                   database.get<std::string>("scan_path_file_format"),
+                   communicator),
+        // PropertyTreeInput sources.beam_X.time_averaging_samples
+        _n_time_samples(database.get("time_averaging_samples", 1u))
   {
   }
 
@@ -91,16 +101,51 @@ public:
    */
   virtual void set_beam_properties(boost::property_tree::ptree const &database);
 
+  /**
+   * Set the window [start_time, start_time + interval] over which the source
+   * is averaged. When the number of time samples is larger than one,
+   * update_time(time) sets the source to its average over the window for
+   * every time in the window. This is usually the time step so that every
+   * stage of the step, including the end of the step used by the implicit
+   * methods, sees the energy deposited during the step.
+   */
+  void set_time_averaging_window(double const start_time,
+                                 double const interval);
+
 protected:
+  /**
+   * Return the times used to compute the average of the source over the
+   * averaging window with the midpoint rule. If the source is not averaged or
+   * if @p time is outside of the window, only @p time is returned.
+   */
+  std::vector<double> get_sample_times(double const time) const;
+
   /**
    * Structure of the physical properties of the beam heat source.
    */
   BeamHeatSourceProperties _beam;
 
   /**
-   * The scan path for the heat source.
+   * The scan path for the heat source. Its destruction is collective, see
+   * ScanPath.
    */
   ScanPath _scan_path;
+
+  /**
+   * Number of times at which the source is evaluated to compute its time
+   * average.
+   */
+  unsigned int _n_time_samples = 1;
+
+  /**
+   * Beginning of the window over which the source is averaged.
+   */
+  double _time_averaging_start = 0.;
+
+  /**
+   * Length of the window over which the source is averaged.
+   */
+  double _time_averaging_interval = 0.;
 };
 
 template <int dim>
@@ -122,6 +167,37 @@ inline void HeatSource<dim>::set_beam_properties(
   _beam.set_from_database(database);
 }
 
+template <int dim>
+inline void
+HeatSource<dim>::set_time_averaging_window(double const start_time,
+                                           double const interval)
+{
+  _time_averaging_start = start_time;
+  _time_averaging_interval = interval;
+}
+
+template <int dim>
+inline std::vector<double>
+HeatSource<dim>::get_sample_times(double const time) const
+{
+  if ((_n_time_samples <= 1) || (_time_averaging_interval <= 0.))
+    return {time};
+
+  // The stage times are computed from the beginning of the step and may be
+  // slightly outside of the window.
+  double const tolerance = 1e-12 * _time_averaging_interval;
+  if ((time < _time_averaging_start - tolerance) ||
+      (time > _time_averaging_start + _time_averaging_interval + tolerance))
+    return {time};
+
+  std::vector<double> sample_times(_n_time_samples);
+  double const sample_interval = _time_averaging_interval / _n_time_samples;
+  for (unsigned int i = 0; i < _n_time_samples; ++i)
+    sample_times[i] = _time_averaging_start + (i + 0.5) * sample_interval;
+
+  return sample_times;
+}
+
 } // namespace adamantine
 
 #endif
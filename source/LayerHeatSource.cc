@@ -0,0 +1,171 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <LayerHeatSource.hh>
+#include <instantiation.hh>
+#include <types.hh>
+#include <utils.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace adamantine
+{
+template <int dim>
+LayerHeatSource<dim>::LayerHeatSource(
+    boost::property_tree::ptree const &database, MPI_Comm const &communicator)
+    : HeatSource<dim>(database, communicator)
+{
+  compute_layers();
+}
+
+template <int dim>
+void LayerHeatSource<dim>::update_time(double time)
+{
+  // Find the first layer that is not done at the given time.
+  _current_layer =
+      std::lower_bound(_end_times.begin(), _end_times.end(), time) -
+      _end_times.begin();
+  if ((_current_layer < _start_times.size()) &&
+      (time < _start_times[_current_layer]))
+    _current_layer = _start_times.size();
+}
+
+template <int dim>
+double LayerHeatSource<dim>::value(dealii::Point<dim> const &point,
+                                   double const /*height*/) const
+{
+  if (_current_layer < _start_times.size())
+  {
+    for (int d = 0; d < dim; ++d)
+    {
+      if ((point[d] < _min_points[_current_layer][d]) ||
+          (point[d] > _max_points[_current_layer][d]))
+        return 0.;
+    }
+
+    return _power_densities[_current_layer];
+  }
+
+  return 0.;
+}
+
+template <int dim>
+void LayerHeatSource<dim>::set_beam_properties(
+    boost::property_tree::ptree const &database)
+{
+  this->_beam.set_from_database(database);
+  compute_layers();
+}
+
+template <int dim>
+void LayerHeatSource<dim>::compute_layers()
+{
+  _start_times.clear();
+  _end_times.clear();
+  _power_densities.clear();
+  _min_points.clear();
+  _max_points.clear();
+
+  auto const &segment_list = this->_scan_path.get_segment_list();
+  if (segment_list.size() == 0)
+    return;
+
+  double const eps = 1.0e-12;
+  double const radius = std::sqrt(this->_beam.radius_squared);
+  double const depth = this->_beam.depth;
+
+  // Quantities accumulated over the segments of the current layer.
+  double layer_height = segment_list.front().end_point[2];
+  double energy = 0.;
+  double start_time = std::numeric_limits<double>::max();
+  double end_time = std::numeric_limits<double>::lowest();
+  dealii::Point<3> lower(std::numeric_limits<double>::max(),
+                         std::numeric_limits<double>::max(), 0.);
+  dealii::Point<3> upper(std::numeric_limits<double>::lowest(),
+                         std::numeric_limits<double>::lowest(), 0.);
+  auto add_layer = [&]()
+  {
+    // Skip the layers where the beam is always off.
+    if ((energy > 0.) && (end_time > start_time))
+    {
+      dealii::Point<dim> min_point;
+      dealii::Point<dim> max_point;
+      min_point[axis<dim>::x] = lower[0] - radius;
+      max_point[axis<dim>::x] = upper[0] + radius;
+      double width = 2. * radius;
+      if constexpr (dim == 3)
+      {
+        min_point[axis<dim>::y] = lower[1] - radius;
+        max_point[axis<dim>::y] = upper[1] + radius;
+        width = max_point[axis<dim>::y] - min_point[axis<dim>::y];
+      }
+      min_point[axis<dim>::z] = layer_height - depth;
+      max_point[axis<dim>::z] = layer_height;
+      double const volume =
+          (max_point[axis<dim>::x] - min_point[axis<dim>::x]) * width * depth;
+      ASSERT_THROW(volume > 0.,
+                   "Error: The volume heated by the layer heat source is "
+                   "zero. Check the depth and the diameter of the beam.");
+
+      _start_times.push_back(start_time);
+      _end_times.push_back(end_time);
+      _power_densities.push_back(energy / ((end_time - start_time) * volume));
+      _min_points.push_back(min_point);
+      _max_points.push_back(max_point);
+    }
+
+    energy = 0.;
+    start_time = std::numeric_limits<double>::max();
+    end_time = std::numeric_limits<double>::lowest();
+    for (int d = 0; d < 2; ++d)
+    {
+      lower[d] = std::numeric_limits<double>::max();
+      upper[d] = std::numeric_limits<double>::lowest();
+    }
+  };
+
+  // The first segment starts at its end point at time zero, see
+  // ScanPath::update_current_segment_info.
+  double segment_start_time = 0.;
+  dealii::Point<3> segment_start_point = segment_list.front().end_point;
+  for (auto const &segment : segment_list)
+  {
+    // A new layer starts when the height of the scan path changes.
+    if (std::abs(segment.end_point[2] - layer_height) > eps)
+    {
+      add_layer();
+      layer_height = segment.end_point[2];
+    }
+
+    if (segment.power_modifier > eps)
+    {
+      double const duration = segment.end_time - segment_start_time;
+      energy += this->_beam.absorption_efficiency * this->_beam.max_power *
+                segment.power_modifier * duration;
+      start_time = std::min(start_time, segment_start_time);
+      end_time = std::max(end_time, segment.end_time);
+      for (int d = 0; d < 2; ++d)
+      {
+        lower[d] = std::min(
+            {lower[d], segment_start_point[d], segment.end_point[d]});
+        upper[d] = std::max(
+            {upper[d], segment_start_point[d], segment.end_point[d]});
+      }
+    }
+
+    segment_start_point = segment.end_point;
+    segment_start_time = segment.end_time;
+  }
+  add_layer();
+
+  _current_layer = _start_times.size();
+}
+} // namespace adamantine
+
+INSTANTIATE_DIM(LayerHeatSource)
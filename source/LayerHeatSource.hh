@@ -0,0 +1,101 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#ifndef LAYER_HEAT_SOURCE_HH
+#define LAYER_HEAT_SOURCE_HH
+
+#include <HeatSource.hh>
+
+#include <vector>
+
+namespace adamantine
+{
+/**
+ * Flash heating model of the deposition of a layer for part-scale
+ * simulations. The energy deposited by the beam while scanning a layer, i.e.,
+ * the integral of the power over the scan path segments of the layer, is
+ * spread uniformly over the volume of the layer and over the time it takes
+ * to scan the layer. The layers are the consecutive scan path segments with
+ * the same height. The volume of a layer is the bounding box of the segments
+ * where the beam is on, enlarged by the radius of the beam, times the depth.
+ * In 2D, the width of the layer is the diameter of the beam. Since the source
+ * does not follow the beam, the time step can be chosen based on the time it
+ * takes to scan a layer instead of the time it takes the beam to cross a
+ * cell.
+ */
+template <int dim>
+class LayerHeatSource final : public HeatSource<dim>
+{
+public:
+  /**
+   * Constructor.
+   * \param[in] database requires the following entries:
+   *   - <B>absorption_efficiency</B>: double in \f$[0,1]\f$
+   *   - <B>depth</B>: double in \f$[0,\infty)\f$
+   *   - <B>diameter</B>: double in \f$[0,\infty)\f$
+   *   - <B>max_power</B>: double in \f$[0, \infty)\f$
+   *   - <B>input_file</B>: name of the file that contains the scan path
+   *     segments
+   * \param[in] communicator is the communicator of the processors that share
+   * the scan path
+   */
+  LayerHeatSource(boost::property_tree::ptree const &database,
+                  MPI_Comm const &communicator = MPI_COMM_SELF);
+
+  /**
+   * Set the time variable.
+   */
+  void update_time(double time) final;
+
+  /**
+   * Return the value of the source for a given point and time. The height of
+   * the layer is used instead of @p height.
+   */
+  double value(dealii::Point<dim> const &point,
+               double const /*height*/) const final;
+
+  /**
+   * (Re)sets the BeamHeatSourceProperties member variable and recompute the
+   * power density of the layers.
+   */
+  void set_beam_properties(boost::property_tree::ptree const &database) final;
+
+private:
+  /**
+   * Compute the layers using the scan path and the properties of the beam.
+   */
+  void compute_layers();
+
+  /**
+   * Time when the beam starts scanning the layers.
+   */
+  std::vector<double> _start_times;
+  /**
+   * Time when the beam stops scanning the layers.
+   */
+  std::vector<double> _end_times;
+  /**
+   * Power per unit of volume deposited in the layers.
+   */
+  std::vector<double> _power_densities;
+  /**
+   * Lower corner of the region heated in the layers.
+   */
+  std::vector<dealii::Point<dim>> _min_points;
+  /**
+   * Upper corner of the region heated in the layers.
+   */
+  std::vector<dealii::Point<dim>> _max_points;
+  /**
+   * Index of the layer that is currently scanned. If no layer is scanned, the
+   * index is equal to the number of layers.
+   */
+  unsigned int _current_layer = 0;
+};
+} // namespace adamantine
+
+#endif
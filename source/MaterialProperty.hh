@@ -1,4 +1,4 @@
-/* Copyright (c) 2016 - 2022, the adamantine authors.
+/* Copyright (c) 2016 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -200,6 +200,11 @@ public:
     return _dofs_map;
   }
 
+  /**
+   * Return an estimate of the memory used by the material properties in bytes.
+   */
+  std::size_t memory_consumption() const;
+
   /**
    * Compute a property from a table given the temperature.
    */
@@ -259,6 +264,10 @@ private:
   /**
    * MemoryBlock that stores the thermal material properties which have been set
    * using polynomials.
+   *
+   * TODO Every processor stores a copy of the tables and of the polynomials.
+   * On the host, they could be shared by the processors of a node using
+   * SharedMemoryArray.
    */
   MemoryBlock<double, MemorySpaceType> _state_property_polynomials;
   /**
@@ -377,6 +386,21 @@ MaterialProperty<dim, MemorySpaceType>::get_dof_handler() const
 {
   return _mp_dof_handler;
 }
+
+template <int dim, typename MemorySpaceType>
+inline std::size_t
+MaterialProperty<dim, MemorySpaceType>::memory_consumption() const
+{
+  return _state_property_tables.memory_consumption() +
+         _state_property_polynomials.memory_consumption() +
+         _properties.memory_consumption() + _state.memory_consumption() +
+         _property_values.memory_consumption() +
+         _mechanical_properties_tables_host.memory_consumption() +
+         _mechanical_properties_polynomials_host.memory_consumption() +
+         _mechanical_properties_host.memory_consumption() +
+         _mp_dof_handler.memory_consumption() +
+         _dofs_map.size() * sizeof(typename decltype(_dofs_map)::value_type);
+}
 } // namespace adamantine
 
 #endif
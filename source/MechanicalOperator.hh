@@ -1,4 +1,4 @@
-/* Copyright (c) 2022, the adamantine authors.
+/* Copyright (c) 2022 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -12,6 +12,7 @@
 #include <MaterialProperty.hh>
 #include <Operator.hh>
 
+#include <deal.II/base/memory_consumption.h>
 #include <deal.II/base/memory_space.h>
 #include <deal.II/base/quadrature_lib.h>
 #include <deal.II/dofs/dof_handler.h>
@@ -85,6 +86,12 @@ public:
 
   dealii::TrilinosWrappers::SparseMatrix const &system_matrix() const;
 
+  /**
+   * Return an estimate of the memory used by the matrix and the vectors of the
+   * mechanical problem in bytes.
+   */
+  std::size_t memory_consumption() const;
+
 private:
   /**
    * Assemble the matrix and the right-hand-side.
@@ -173,5 +180,14 @@ MechanicalOperator<dim, MemorySpaceType>::system_matrix() const
 {
   return _system_matrix;
 }
+
+template <int dim, typename MemorySpaceType>
+inline std::size_t
+MechanicalOperator<dim, MemorySpaceType>::memory_consumption() const
+{
+  return _system_matrix.memory_consumption() +
+         _system_rhs.memory_consumption() + _temperature.memory_consumption() +
+         dealii::MemoryConsumption::memory_consumption(_has_melted);
+}
 } // namespace adamantine
 #endif
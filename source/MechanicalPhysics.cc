@@ -134,11 +134,22 @@ MechanicalPhysics<dim, MemorySpaceType>::solve()
   preconditioner.initialize(_mechanical_operator->system_matrix());
   cg.solve(_mechanical_operator->system_matrix(), solution,
            _mechanical_operator->rhs(), preconditioner);
+  _n_solver_iterations = solver_control.last_step();
   _affine_constraints.distribute(solution);
 
   return solution;
 }
 
+template <int dim, typename MemorySpaceType>
+std::size_t MechanicalPhysics<dim, MemorySpaceType>::memory_consumption() const
+{
+  std::size_t const operator_memory =
+      _mechanical_operator ? _mechanical_operator->memory_consumption() : 0;
+
+  return _dof_handler.memory_consumption() +
+         _affine_constraints.memory_consumption() + operator_memory;
+}
+
 } // namespace adamantine
 
 INSTANTIATE_DIM_HOST(MechanicalPhysics)
@@ -63,6 +63,17 @@ public:
    */
   dealii::AffineConstraints<double> &get_affine_constraints();
 
+  /**
+   * Return the number of CG iterations performed by the last call to solve().
+   */
+  unsigned int get_n_solver_iterations() const;
+
+  /**
+   * Return an estimate of the memory used by the DoFHandler, the
+   * AffineConstraints, and the MechanicalOperator in bytes.
+   */
+  std::size_t memory_consumption() const;
+
 private:
   /**
    * Associated Geometry.
@@ -97,6 +108,10 @@ private:
    * Whether to include a gravitional body force in the calculation.
    */
   bool _include_gravity;
+  /**
+   * Number of CG iterations performed by the last call to solve().
+   */
+  unsigned int _n_solver_iterations = 0;
 };
 
 template <int dim, typename MemorySpaceType>
@@ -113,6 +128,13 @@ MechanicalPhysics<dim, MemorySpaceType>::get_affine_constraints()
   return _affine_constraints;
 }
 
+template <int dim, typename MemorySpaceType>
+inline unsigned int
+MechanicalPhysics<dim, MemorySpaceType>::get_n_solver_iterations() const
+{
+  return _n_solver_iterations;
+}
+
 } // namespace adamantine
 
 #endif
@@ -1,4 +1,4 @@
-/* Copyright (c) 2021-2022, the adamantine authors.
+/* Copyright (c) 2021-2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -108,6 +108,11 @@ public:
    */
   Number *data() const;
 
+  /**
+   * Return the memory allocated by the memory block in bytes.
+   */
+  std::size_t memory_consumption() const;
+
 private:
   template <typename Number2, typename MemorySpaceType2>
   friend std::ostream &
@@ -270,6 +275,12 @@ Number *MemoryBlock<Number, MemorySpaceType>::data() const
   return _data;
 }
 
+template <typename Number, typename MemorySpaceType>
+std::size_t MemoryBlock<Number, MemorySpaceType>::memory_consumption() const
+{
+  return sizeof(*this) + static_cast<std::size_t>(_size) * sizeof(Number);
+}
+
 template <typename Number, typename MemorySpaceType>
 void MemoryBlock<Number, MemorySpaceType>::set_zero()
 {
@@ -0,0 +1,93 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <MemoryReport.hh>
+#include <utils.hh>
+
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+
+namespace adamantine
+{
+MemoryReport::MemoryReport(MPI_Comm const &communicator)
+    : _communicator(communicator), _subsystems{"Total"}, _bytes(1, 0.),
+      _high_water_marks(1, 0.)
+{
+}
+
+void MemoryReport::add(std::string const &subsystem, std::size_t bytes)
+{
+  _bytes[get_index(subsystem)] += static_cast<double>(bytes);
+}
+
+void MemoryReport::print(std::ostream &out, std::string const &event)
+{
+  unsigned int const n_subsystems = _subsystems.size();
+  _bytes.back() = std::accumulate(_bytes.begin(), _bytes.end() - 1, 0.);
+  std::vector<dealii::Utilities::MPI::MinMaxAvg> const min_max =
+      dealii::Utilities::MPI::min_max_avg(_bytes, _communicator);
+  for (unsigned int i = 0; i < n_subsystems; ++i)
+    _high_water_marks[i] = std::max(_high_water_marks[i], min_max[i].max);
+
+  if (dealii::Utilities::MPI::this_mpi_process(_communicator) == 0)
+  {
+    out << "Memory per processor " << event << " [MB]:" << std::endl;
+    out << std::setw(40) << std::left << "  Subsystem" << std::right
+        << std::setw(12) << "min" << std::setw(12) << "max" << std::endl;
+    for (unsigned int i = 0; i < n_subsystems; ++i)
+    {
+      out << std::setw(40) << std::left << "  " + _subsystems[i] << std::right
+          << std::fixed << std::setprecision(2) << std::setw(12)
+          << min_max[i].min / 1e6 << std::setw(12) << min_max[i].max / 1e6
+          << std::defaultfloat << std::endl;
+    }
+  }
+
+  std::fill(_bytes.begin(), _bytes.end(), 0.);
+}
+
+void MemoryReport::print_high_water_marks(std::ostream &out) const
+{
+  if (dealii::Utilities::MPI::this_mpi_process(_communicator) == 0)
+  {
+    out << "Memory high-water marks per processor [MB]:" << std::endl;
+    for (unsigned int i = 0; i < _subsystems.size(); ++i)
+    {
+      out << std::setw(40) << std::left << "  " + _subsystems[i] << std::right
+          << std::fixed << std::setprecision(2) << std::setw(12)
+          << _high_water_marks[i] / 1e6 << std::defaultfloat << std::endl;
+    }
+  }
+}
+
+double MemoryReport::get_high_water_mark(std::string const &subsystem) const
+{
+  auto const it = std::find(_subsystems.begin(), _subsystems.end(), subsystem);
+  ASSERT_THROW(it != _subsystems.end(),
+               "Error: Unknown subsystem " + subsystem + ".");
+
+  return _high_water_marks[it - _subsystems.begin()];
+}
+
+unsigned int MemoryReport::get_index(std::string const &subsystem)
+{
+  ASSERT(subsystem != "Total", "Error: Total is computed automatically.");
+  auto const it =
+      std::find(_subsystems.begin(), _subsystems.end() - 1, subsystem);
+  if (it != _subsystems.end() - 1)
+    return it - _subsystems.begin();
+
+  // Insert the new subsystem before the total.
+  unsigned int const index = _subsystems.size() - 1;
+  _subsystems.insert(_subsystems.begin() + index, subsystem);
+  _bytes.insert(_bytes.begin() + index, 0.);
+  _high_water_marks.insert(_high_water_marks.begin() + index, 0.);
+
+  return index;
+}
+} // namespace adamantine
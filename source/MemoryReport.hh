@@ -0,0 +1,89 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#ifndef MEMORY_REPORT_HH
+#define MEMORY_REPORT_HH
+
+#include <deal.II/base/mpi.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace adamantine
+{
+/**
+ * This class gathers the memory used by the different subsystems of the
+ * simulation (mesh, DoFHandler, MatrixFree, vectors, ...) and reports the
+ * minimum and the maximum over the processors. The high-water mark of every
+ * subsystem, i.e., the largest memory used by a processor during the
+ * simulation, is tracked. The subsystems must be added in the same order on
+ * every processor.
+ */
+class MemoryReport
+{
+public:
+  /**
+   * Constructor.
+   */
+  MemoryReport(MPI_Comm const &communicator);
+
+  /**
+   * Add @p bytes to the memory used by @p subsystem on this processor. The
+   * memory of a subsystem that is added several times (for instance once per
+   * ensemble member) is accumulated.
+   */
+  void add(std::string const &subsystem, std::size_t bytes);
+
+  /**
+   * Compute the minimum and the maximum over the processors of the memory used
+   * by every subsystem, update the high-water marks, and print the report on
+   * rank 0. The memory of the subsystems is then reset. This function is
+   * collective.
+   */
+  void print(std::ostream &out, std::string const &event);
+
+  /**
+   * Print the high-water marks on rank 0.
+   */
+  void print_high_water_marks(std::ostream &out) const;
+
+  /**
+   * Return the high-water mark of @p subsystem in bytes. The high-water mark
+   * of the total memory is obtained using "Total".
+   */
+  double get_high_water_mark(std::string const &subsystem) const;
+
+private:
+  /**
+   * Return the position of @p subsystem in _subsystems. The subsystem is
+   * created if it does not exist.
+   */
+  unsigned int get_index(std::string const &subsystem);
+
+  /**
+   * MPI communicator.
+   */
+  MPI_Comm _communicator;
+  /**
+   * Names of the subsystems in the order they were added. The last subsystem
+   * is always the total.
+   */
+  std::vector<std::string> _subsystems;
+  /**
+   * Memory in bytes used by every subsystem on this processor since the last
+   * report.
+   */
+  std::vector<double> _bytes;
+  /**
+   * Largest memory in bytes used by a processor for every subsystem.
+   */
+  std::vector<double> _high_water_marks;
+};
+} // namespace adamantine
+
+#endif
@@ -8,9 +8,11 @@
 #include <PostProcessor.hh>
 #include <instantiation.hh>
 
+#include <deal.II/base/work_stream.h>
 #include <deal.II/grid/filtered_iterator.h>
 
 #include <fstream>
+#include <functional>
 #include <unordered_map>
 
 namespace adamantine
@@ -217,19 +219,27 @@ void PostProcessor<dim>::material_dataout(
       static_cast<unsigned int>(MaterialState::liquid);
   unsigned int constexpr solid_index =
       static_cast<unsigned int>(MaterialState::solid);
-  auto mp_cell = material_dof_handler.begin_active();
-  auto mp_end_cell = material_dof_handler.end();
-  std::vector<dealii::types::global_dof_index> mp_dof_indices(1);
-  for (unsigned int i = 0; mp_cell != mp_end_cell; ++i, ++mp_cell)
-    if (mp_cell->is_locally_owned())
-    {
-      mp_cell->get_dof_indices(mp_dof_indices);
-      dealii::types::global_dof_index const mp_dof_index =
-          dofs_map.at(mp_dof_indices[0]);
-      powder[i] = state(powder_index, mp_dof_index);
-      liquid[i] = state(liquid_index, mp_dof_index);
-      solid[i] = state(solid_index, mp_dof_index);
-    }
+  // Every cell writes its own entries, so the cells are processed in parallel
+  // using threads and there is nothing to copy.
+  auto worker =
+      [&](typename dealii::DoFHandler<dim>::active_cell_iterator const &mp_cell,
+          std::vector<dealii::types::global_dof_index> &mp_dof_indices, int &)
+  {
+    mp_cell->get_dof_indices(mp_dof_indices);
+    dealii::types::global_dof_index const mp_dof_index =
+        dofs_map.at(mp_dof_indices[0]);
+    unsigned int const i = mp_cell->active_cell_index();
+    powder[i] = state(powder_index, mp_dof_index);
+    liquid[i] = state(liquid_index, mp_dof_index);
+    solid[i] = state(solid_index, mp_dof_index);
+  };
+  auto const locally_owned_cells =
+      dealii::filter_iterators(material_dof_handler.active_cell_iterators(),
+                               dealii::IteratorFilters::LocallyOwnedCell());
+  dealii::WorkStream::run(
+      locally_owned_cells.begin(), locally_owned_cells.end(), worker,
+      std::function<void(int const &)>(),
+      std::vector<dealii::types::global_dof_index>(1), 0);
   _data_out.add_data_vector(powder, "powder");
   _data_out.add_data_vector(liquid, "liquid");
   _data_out.add_data_vector(solid, "solid");
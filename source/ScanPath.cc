@@ -12,28 +12,40 @@
 
 namespace adamantine
 {
-ScanPath::ScanPath(std::string scan_path_file, std::string file_format)
+ScanPath::ScanPath(std::string scan_path_file, std::string file_format,
+                   MPI_Comm const &communicator)
 {
-  // Parse the scan path
-  wait_for_file(scan_path_file,
-                "Waiting for scan path file: " + scan_path_file);
-
-  if (file_format == "segment")
-  {
-    load_segment_scan_path(scan_path_file);
-  }
-  else if (file_format == "event_series")
-  {
-    load_event_series_scan_path(scan_path_file);
-  }
-  else
-  {
-    ASSERT_THROW(false, "Error: Format of scan path file not recognized.");
-  }
+  // Parse the scan path. Only the first processor of every node reads the
+  // file.
+  _segment_list = SharedMemoryArray<ScanPathSegment>(
+      communicator,
+      [&]()
+      {
+        wait_for_file(scan_path_file,
+                      "Waiting for scan path file: " + scan_path_file);
+
+        if (file_format == "segment")
+        {
+          return load_segment_scan_path(scan_path_file);
+        }
+        else if (file_format == "event_series")
+        {
+          return load_event_series_scan_path(scan_path_file);
+        }
+        else
+        {
+          ASSERT_THROW(false,
+                       "Error: Format of scan path file not recognized.");
+        }
+
+        return std::vector<ScanPathSegment>();
+      });
 }
 
-void ScanPath::load_segment_scan_path(std::string scan_path_file)
+std::vector<ScanPathSegment>
+ScanPath::load_segment_scan_path(std::string scan_path_file)
 {
+  std::vector<ScanPathSegment> segment_list;
   std::ifstream file;
   file.open(scan_path_file);
   std::string line;
@@ -60,7 +72,7 @@ void ScanPath::load_segment_scan_path(std::string scan_path_file)
     {
       // Check to make sure the segment isn't the first, if it is, throw an
       // exception (the first segment must be a point in the spec).
-      ASSERT_THROW(_segment_list.size() > 0,
+      ASSERT_THROW(segment_list.size() > 0,
                    "Error: Scan paths must begin with a 'point' segment.");
     }
     else if (split_line[0] == "1")
@@ -84,10 +96,10 @@ void ScanPath::load_segment_scan_path(std::string scan_path_file)
     // Set the velocity and end time
     if (segment_type == ScanPathSegmentType::point)
     {
-      if (_segment_list.size() > 0)
+      if (segment_list.size() > 0)
       {
         segment.end_time =
-            _segment_list.back().end_time + std::stod(split_line[5]);
+            segment_list.back().end_time + std::stod(split_line[5]);
       }
       else
       {
@@ -98,18 +110,22 @@ void ScanPath::load_segment_scan_path(std::string scan_path_file)
     {
       double velocity = std::stod(split_line[5]);
       double line_length =
-          segment.end_point.distance(_segment_list.back().end_point);
+          segment.end_point.distance(segment_list.back().end_point);
       segment.end_time =
-          _segment_list.back().end_time + std::abs(line_length / velocity);
+          segment_list.back().end_time + std::abs(line_length / velocity);
     }
-    _segment_list.push_back(segment);
+    segment_list.push_back(segment);
     data_index++;
   }
   file.close();
+
+  return segment_list;
 }
 
-void ScanPath::load_event_series_scan_path(std::string scan_path_file)
+std::vector<ScanPathSegment>
+ScanPath::load_event_series_scan_path(std::string scan_path_file)
 {
+  std::vector<ScanPathSegment> segment_list;
   std::ifstream file;
   file.open(scan_path_file);
   std::string line;
@@ -137,8 +153,10 @@ void ScanPath::load_event_series_scan_path(std::string scan_path_file)
     segment.power_modifier = last_power;
     last_power = std::stod(split_line[4]);
 
-    _segment_list.push_back(segment);
+    segment_list.push_back(segment);
   }
+
+  return segment_list;
 }
 
 void ScanPath::update_current_segment_info(
@@ -206,7 +224,27 @@ double ScanPath::get_power_modifier(double const &time) const
   return _segment_list[_current_segment].power_modifier;
 }
 
-std::vector<ScanPathSegment> ScanPath::get_segment_list() const
+dealii::Tensor<1, 3> ScanPath::velocity(double const &time) const
+{
+  if (time > _segment_list.back().end_time)
+    return dealii::Tensor<1, 3>();
+
+  // Get to the correct segment
+  dealii::Point<3> segment_start_point;
+  double segment_start_time = 0.0;
+  update_current_segment_info(time, segment_start_point, segment_start_time);
+
+  // A segment of zero duration does not move the beam.
+  double const segment_duration =
+      _segment_list[_current_segment].end_time - segment_start_time;
+  if (segment_duration <= 0.)
+    return dealii::Tensor<1, 3>();
+
+  return (_segment_list[_current_segment].end_point - segment_start_point) /
+         segment_duration;
+}
+
+SharedMemoryArray<ScanPathSegment> const &ScanPath::get_segment_list() const
 {
   return _segment_list;
 }
@@ -8,6 +8,8 @@
 #ifndef SCAN_PATH_HH
 #define SCAN_PATH_HH
 
+#include <SharedMemoryArray.hh>
+
 #include <deal.II/base/function.h>
 #include <deal.II/base/point.h>
 
@@ -54,7 +56,9 @@ class ScanPathTester;
 /**
  * This class calculates the position of the center of a heat source. It also
  * gives the power modifier for the current segment. It reads in the scan path
- * from a text file.
+ * from a text file. The segments are stored in a SharedMemoryArray so the
+ * destruction of the last copy of a ScanPath is collective over the processors
+ * of the node. All the processors must destroy their ScanPath together.
  */
 class ScanPath
 {
@@ -71,8 +75,12 @@ public:
    * \param[in] scan_path_file is the name of the text file containing the scan
    * path
    * \param[in] file_format is the format of the scan path file
+   * \param[in] communicator is the communicator of the processors that use the
+   * scan path. The file is read once per node and the segments are shared by
+   * the processors of the node. This function is collective.
    */
-  ScanPath(std::string scan_path_file, std::string file_format);
+  ScanPath(std::string scan_path_file, std::string file_format,
+           MPI_Comm const &communicator = MPI_COMM_SELF);
 
   /**
    * Calculates the location of the scan path at a given time for a single
@@ -86,15 +94,23 @@ public:
   double get_power_modifier(double const &time) const;
 
   /**
-   * Returns the scan path's list of segments
+   * Return the velocity of the scan path at a given time. The velocity is
+   * zero after the end of the scan path.
+   */
+  dealii::Tensor<1, 3> velocity(double const &time) const;
+
+  /**
+   * Returns the scan path's list of segments. The list is shared by the
+   * processors of the node, it is not copied.
    */
-  std::vector<ScanPathSegment> get_segment_list() const;
+  SharedMemoryArray<ScanPathSegment> const &get_segment_list() const;
 
 private:
   /**
-   * The list of information about each segment in the scan path.
+   * The list of information about each segment in the scan path. The list is
+   * shared by the processors of a node.
    */
-  std::vector<ScanPathSegment> _segment_list;
+  SharedMemoryArray<ScanPathSegment> _segment_list;
 
   /**
    * The index of the current segment in the scan path.
@@ -104,12 +120,14 @@ private:
   /**
    * Method to load a "segment" scan path file
    */
-  void load_segment_scan_path(std::string scan_path_file);
+  static std::vector<ScanPathSegment>
+  load_segment_scan_path(std::string scan_path_file);
 
   /**
    * Method to load an "event series" scan path file
    */
-  void load_event_series_scan_path(std::string scan_path_file);
+  static std::vector<ScanPathSegment>
+  load_event_series_scan_path(std::string scan_path_file);
 
   /**
    * Method to determine the current segment, its start point, and start time.
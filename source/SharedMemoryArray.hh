@@ -0,0 +1,282 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#ifndef SHARED_MEMORY_ARRAY_HH
+#define SHARED_MEMORY_ARRAY_HH
+
+#include <utils.hh>
+
+#include <deal.II/base/mpi.h>
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace adamantine
+{
+/**
+ * This class stores a read-only array that is shared by all the processors of
+ * a node. The array is allocated in an MPI-3 shared memory window owned by the
+ * first processor of the node, which is also the only processor that creates
+ * the data. The other processors access the memory of the window directly.
+ * Copies of the class are shallow. Since the window is freed when the last
+ * copy is destroyed, the destruction is collective over the processors of the
+ * node: every processor of the node must destroy its last copy at the same
+ * point of the program. A copy that outlives the other ones on some processors
+ * only, e.g. a copy stored in an object that is only created on some
+ * processors, makes the program hang.
+ */
+template <typename T>
+class SharedMemoryArray
+{
+  // The elements are built by one processor and read by the others. They
+  // cannot own memory outside of the window.
+  static_assert(std::is_trivially_destructible<T>::value,
+                "The elements of a SharedMemoryArray must be trivially "
+                "destructible.");
+
+public:
+  /**
+   * Default constructor. The array is empty.
+   */
+  SharedMemoryArray() = default;
+
+  /**
+   * Constructor. @p create_data is only called on the first processor of every
+   * node of @p communicator. If it throws, an exception is thrown on all the
+   * processors. This function is collective.
+   */
+  SharedMemoryArray(MPI_Comm const &communicator,
+                    std::function<std::vector<T>()> const &create_data);
+
+  /**
+   * Return the number of elements.
+   */
+  std::size_t size() const;
+
+  /**
+   * Return true if the array is empty.
+   */
+  bool empty() const;
+
+  /**
+   * Return the pointer to the first element.
+   */
+  T const *data() const;
+
+  /**
+   * Return the element @p i.
+   */
+  T const &operator[](std::size_t i) const;
+
+  /**
+   * Return the first element.
+   */
+  T const &front() const;
+
+  /**
+   * Return the last element.
+   */
+  T const &back() const;
+
+  /**
+   * Return an iterator to the first element.
+   */
+  T const *begin() const;
+
+  /**
+   * Return an iterator past the last element.
+   */
+  T const *end() const;
+
+  /**
+   * Copy the elements in a std::vector.
+   */
+  std::vector<T> to_vector() const;
+
+  /**
+   * Return the memory allocated by this processor in bytes. Only the first
+   * processor of every node allocates the memory of the window.
+   */
+  std::size_t memory_consumption() const;
+
+  /**
+   * Return the shared memory window. The memory of the array is the segment of
+   * the processor 0 of the window.
+   */
+  MPI_Win get_window() const;
+
+private:
+  /**
+   * Shared memory window and communicator of the node. They are freed when the
+   * last copy of the array is destroyed.
+   */
+  struct Window
+  {
+    ~Window();
+
+    MPI_Comm node_communicator = MPI_COMM_NULL;
+    MPI_Win window = MPI_WIN_NULL;
+  };
+
+  std::shared_ptr<Window> _window;
+  std::size_t _size = 0;
+  std::size_t _local_size = 0;
+  T const *_data = nullptr;
+};
+
+template <typename T>
+SharedMemoryArray<T>::Window::~Window()
+{
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+  if (finalized)
+    return;
+
+  if (window != MPI_WIN_NULL)
+    MPI_Win_free(&window);
+  if (node_communicator != MPI_COMM_NULL)
+    MPI_Comm_free(&node_communicator);
+}
+
+template <typename T>
+SharedMemoryArray<T>::SharedMemoryArray(
+    MPI_Comm const &communicator,
+    std::function<std::vector<T>()> const &create_data)
+    : _window(std::make_shared<Window>())
+{
+  MPI_Comm_split_type(communicator, MPI_COMM_TYPE_SHARED,
+                      dealii::Utilities::MPI::this_mpi_process(communicator),
+                      MPI_INFO_NULL, &_window->node_communicator);
+  bool const node_leader = dealii::Utilities::MPI::this_mpi_process(
+                               _window->node_communicator) == 0;
+
+  // Create the data on the first processor of the node. The status is
+  // communicated to the other processors so that an error does not leave them
+  // waiting.
+  std::vector<T> local_data;
+  std::exception_ptr exception;
+  if (node_leader)
+  {
+    try
+    {
+      local_data = create_data();
+    }
+    catch (...)
+    {
+      exception = std::current_exception();
+    }
+  }
+  unsigned long long sizes[2] = {exception ? 1ULL : 0ULL, local_data.size()};
+  MPI_Bcast(sizes, 2, MPI_UNSIGNED_LONG_LONG, 0, _window->node_communicator);
+  if (exception)
+    std::rethrow_exception(exception);
+  ASSERT_THROW(sizes[0] == 0,
+               "Error: The creation of the shared data failed on another "
+               "processor.");
+  _size = sizes[1];
+  _local_size = node_leader ? _size : 0;
+
+  // Only the first processor allocates memory. The other processors query the
+  // address of its segment.
+  T *data = nullptr;
+  MPI_Win_allocate_shared(_local_size * sizeof(T), sizeof(T), MPI_INFO_NULL,
+                          _window->node_communicator, &data,
+                          &_window->window);
+  if (!node_leader)
+  {
+    MPI_Aint segment_size = 0;
+    int displacement_unit = 0;
+    MPI_Win_shared_query(_window->window, 0, &segment_size, &displacement_unit,
+                         &data);
+  }
+
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, _window->window);
+  if (node_leader)
+    std::uninitialized_copy(local_data.begin(), local_data.end(), data);
+  MPI_Win_sync(_window->window);
+  MPI_Barrier(_window->node_communicator);
+  MPI_Win_sync(_window->window);
+  MPI_Win_unlock_all(_window->window);
+
+  _data = data;
+}
+
+template <typename T>
+inline std::size_t SharedMemoryArray<T>::size() const
+{
+  return _size;
+}
+
+template <typename T>
+inline bool SharedMemoryArray<T>::empty() const
+{
+  return _size == 0;
+}
+
+template <typename T>
+inline T const *SharedMemoryArray<T>::data() const
+{
+  return _data;
+}
+
+template <typename T>
+inline T const &SharedMemoryArray<T>::operator[](std::size_t i) const
+{
+  ASSERT(i < _size, "Out-of-bound access.");
+  return _data[i];
+}
+
+template <typename T>
+inline T const &SharedMemoryArray<T>::front() const
+{
+  ASSERT(_size > 0, "The array is empty.");
+  return _data[0];
+}
+
+template <typename T>
+inline T const &SharedMemoryArray<T>::back() const
+{
+  ASSERT(_size > 0, "The array is empty.");
+  return _data[_size - 1];
+}
+
+template <typename T>
+inline T const *SharedMemoryArray<T>::begin() const
+{
+  return _data;
+}
+
+template <typename T>
+inline T const *SharedMemoryArray<T>::end() const
+{
+  return _data + _size;
+}
+
+template <typename T>
+inline std::vector<T> SharedMemoryArray<T>::to_vector() const
+{
+  return std::vector<T>(begin(), end());
+}
+
+template <typename T>
+inline std::size_t SharedMemoryArray<T>::memory_consumption() const
+{
+  return _local_size * sizeof(T);
+}
+
+template <typename T>
+inline MPI_Win SharedMemoryArray<T>::get_window() const
+{
+  return _window ? _window->window : MPI_WIN_NULL;
+}
+} // namespace adamantine
+
+#endif
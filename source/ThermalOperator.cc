@@ -1,4 +1,4 @@
-/* Copyright (c) 2016 - 2022, the adamantine authors.
+/* Copyright (c) 2016 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -11,6 +11,7 @@
 
 #include <deal.II/base/aligned_vector.h>
 #include <deal.II/base/index_set.h>
+#include <deal.II/base/parallel.h>
 #include <deal.II/base/types.h>
 #include <deal.II/base/vectorization.h>
 #include <deal.II/dofs/dof_tools.h>
@@ -19,6 +20,8 @@
 #include <deal.II/hp/fe_values.h>
 #include <deal.II/matrix_free/fe_evaluation.h>
 
+#include <limits>
+
 namespace adamantine
 {
 
@@ -26,7 +29,8 @@ template <int dim, int fe_degree, typename MemorySpaceType>
 ThermalOperator<dim, fe_degree, MemorySpaceType>::ThermalOperator(
     MPI_Comm const &communicator, BoundaryType boundary_type,
     MaterialProperty<dim, MemorySpaceType> &material_properties,
-    std::vector<std::shared_ptr<HeatSource<dim>>> const &heat_sources)
+    std::vector<std::shared_ptr<HeatSource<dim>>> const &heat_sources,
+    bool const refinement_indicator)
     : _communicator(communicator), _boundary_type(boundary_type),
       _material_properties(material_properties), _heat_sources(heat_sources),
       _inverse_mass_matrix(
@@ -39,6 +43,11 @@ ThermalOperator<dim, fe_degree, MemorySpaceType>::ThermalOperator(
       dealii::update_JxW_values | dealii::update_quadrature_points;
   _matrix_free_data.mapping_update_flags_inner_faces =
       dealii::update_values | dealii::update_JxW_values;
+  // The gradients on the inner faces are only used by the refinement
+  // indicator.
+  if (refinement_indicator)
+    _matrix_free_data.mapping_update_flags_inner_faces |=
+        dealii::update_gradients | dealii::update_normal_vectors;
   _matrix_free_data.mapping_update_flags_boundary_faces =
       dealii::update_values | dealii::update_JxW_values;
 }
@@ -52,6 +61,9 @@ void ThermalOperator<dim, fe_degree, MemorySpaceType>::reinit(
   _matrix_free.reinit(dealii::StaticMappingQ1<dim>::mapping, dof_handler,
                       affine_constraints, q_collection, _matrix_free_data);
   _affine_constraints = &affine_constraints;
+  // The numbering of the batches has changed.
+  _cell_batch_mask.clear();
+  _face_batch_mask.clear();
 
   // Compute mapping between DoFHandler cells and the MatrixFree cells
   _cell_it_to_mf_cell_map.clear();
@@ -154,6 +166,194 @@ void ThermalOperator<dim, fe_degree, MemorySpaceType>::clear()
   _inverse_mass_matrix->reinit(0);
 }
 
+template <int dim, int fe_degree, typename MemorySpaceType>
+std::size_t ThermalOperator<dim, fe_degree,
+                            MemorySpaceType>::matrix_free_memory_consumption()
+    const
+{
+  return _matrix_free.memory_consumption();
+}
+
+template <int dim, int fe_degree, typename MemorySpaceType>
+std::size_t
+ThermalOperator<dim, fe_degree, MemorySpaceType>::memory_consumption() const
+{
+  return _thermal_conductivity.memory_consumption() +
+         _liquid_ratio.memory_consumption() +
+         _powder_ratio.memory_consumption() +
+         _face_powder_ratio.memory_consumption() +
+         _material_id.memory_consumption() +
+         _face_material_id.memory_consumption() +
+         _face_condensed.memory_consumption() +
+         _face_far_field.memory_consumption() +
+         _face_symmetry.memory_consumption() +
+         _deposition_cos.memory_consumption() +
+         _deposition_sin.memory_consumption() +
+         _inverse_mass_matrix->memory_consumption() +
+         _cell_it_to_mf_cell_map.size() *
+             sizeof(typename decltype(_cell_it_to_mf_cell_map)::value_type);
+}
+
+template <int dim, int fe_degree, typename MemorySpaceType>
+dealii::Vector<float>
+ThermalOperator<dim, fe_degree, MemorySpaceType>::compute_refinement_indicator(
+    dealii::LA::distributed::Vector<double, MemorySpaceType> const &temperature,
+    double const min_temperature) const
+{
+  ASSERT_THROW(_matrix_free_data.mapping_update_flags_inner_faces &
+                   dealii::update_gradients,
+               "Error: The refinement indicator was not enabled when the "
+               "thermal operator was created.");
+
+  auto const &triangulation =
+      _matrix_free.get_dof_handler().get_triangulation();
+  // Every inner face is treated by a single processor but the indicator is
+  // needed on both cells sharing the face. The contributions to the ghost
+  // cells are sent to their owner using the global active cell index.
+  dealii::LA::distributed::Vector<float, dealii::MemorySpace::Host>
+      indicator_squared(
+          triangulation.global_active_cell_index_partitioner().lock());
+
+  bool const has_ghost_elements = temperature.has_ghost_elements();
+  if (!has_ghost_elements)
+    temperature.update_ghost_values();
+
+  dealii::FEFaceEvaluation<dim, fe_degree, fe_degree + 1, 1, double>
+      fe_face_eval_m(_matrix_free, true);
+  dealii::FEFaceEvaluation<dim, fe_degree, fe_degree + 1, 1, double>
+      fe_face_eval_p(_matrix_free, false);
+  unsigned int const n_inner_faces = _matrix_free.n_inner_face_batches();
+  for (unsigned int face = 0; face < n_inner_faces; ++face)
+  {
+    // Only the faces between two activated cells are used.
+    auto const adjacent_cells_fe_index =
+        _matrix_free.get_face_range_category(std::make_pair(face, face + 1));
+    if ((adjacent_cells_fe_index.first != 0) ||
+        (adjacent_cells_fe_index.second != 0))
+      continue;
+
+    // Skip the faces that are colder than min_temperature before computing
+    // the gradients.
+    fe_face_eval_m.reinit(face);
+    fe_face_eval_m.read_dof_values(temperature);
+    fe_face_eval_m.evaluate(dealii::EvaluationFlags::values |
+                            dealii::EvaluationFlags::gradients);
+    auto face_temperature = dealii::make_vectorized_array<double>(
+        std::numeric_limits<double>::lowest());
+    for (unsigned int q = 0; q < fe_face_eval_m.n_q_points; ++q)
+      face_temperature =
+          std::max(face_temperature, fe_face_eval_m.get_value(q));
+    unsigned int const n_faces =
+        _matrix_free.n_active_entries_per_face_batch(face);
+    bool hot_face = false;
+    for (unsigned int i = 0; i < n_faces; ++i)
+      if (face_temperature[i] >= min_temperature)
+        hot_face = true;
+    if (!hot_face)
+      continue;
+
+    fe_face_eval_p.reinit(face);
+    fe_face_eval_p.read_dof_values(temperature);
+    fe_face_eval_p.evaluate(dealii::EvaluationFlags::gradients);
+    auto jump_squared = dealii::make_vectorized_array<double>(0.);
+    for (unsigned int q = 0; q < fe_face_eval_m.n_q_points; ++q)
+    {
+      auto const jump = fe_face_eval_m.get_normal_derivative(q) -
+                        fe_face_eval_p.get_normal_derivative(q);
+      jump_squared += jump * jump * fe_face_eval_m.JxW(q);
+    }
+
+    for (unsigned int i = 0; i < n_faces; ++i)
+    {
+      if (face_temperature[i] < min_temperature)
+        continue;
+      auto const [cell_m, face_m] = _matrix_free.get_face_iterator(face, i);
+      auto const cell_p = _matrix_free.get_face_iterator(face, i, false).first;
+      // Use the same scaling as the Kelly error estimator.
+      float const contribution = static_cast<float>(
+          cell_m->face(face_m)->diameter() / 24. * jump_squared[i]);
+      indicator_squared(cell_m->global_active_cell_index()) += contribution;
+      indicator_squared(cell_p->global_active_cell_index()) += contribution;
+    }
+  }
+  indicator_squared.compress(dealii::VectorOperation::add);
+
+  if (!has_ghost_elements)
+    temperature.zero_out_ghost_values();
+
+  dealii::Vector<float> indicator(triangulation.n_active_cells());
+  for (auto const &cell : triangulation.active_cell_iterators())
+    if (cell->is_locally_owned())
+      indicator[cell->active_cell_index()] =
+          std::sqrt(indicator_squared(cell->global_active_cell_index()));
+
+  return indicator;
+}
+
+template <int dim, int fe_degree, typename MemorySpaceType>
+void ThermalOperator<dim, fe_degree, MemorySpaceType>::compute_cell_diagnostics(
+    dealii::LA::distributed::Vector<double, MemorySpaceType> const &temperature,
+    CellDiagnostics<dim> &diagnostics) const
+{
+  diagnostics.reset(
+      _matrix_free.get_dof_handler().get_triangulation().n_active_cells());
+
+  bool const has_ghost_elements = temperature.has_ghost_elements();
+  if (!has_ghost_elements)
+    temperature.update_ghost_values();
+
+  // Only the cells associated with the fe index 0 are activated.
+  std::pair<unsigned int, unsigned int> const cell_subrange =
+      _matrix_free.create_cell_subrange_hp_by_index(
+          std::make_pair(0U, _matrix_free.n_cell_batches()), 0);
+  dealii::FEEvaluation<dim, fe_degree, fe_degree + 1, 1, double> fe_eval(
+      _matrix_free);
+  for (unsigned int cell = cell_subrange.first; cell < cell_subrange.second;
+       ++cell)
+  {
+    fe_eval.reinit(cell);
+    fe_eval.read_dof_values(temperature);
+
+    // The extrema are computed using the values at the nodes.
+    auto min_temperature = dealii::make_vectorized_array<double>(
+        std::numeric_limits<double>::max());
+    auto max_temperature = dealii::make_vectorized_array<double>(
+        std::numeric_limits<double>::lowest());
+    for (unsigned int i = 0; i < fe_eval.dofs_per_cell; ++i)
+    {
+      auto const dof_value = fe_eval.begin_dof_values()[i];
+      min_temperature = std::min(min_temperature, dof_value);
+      max_temperature = std::max(max_temperature, dof_value);
+    }
+
+    fe_eval.evaluate(dealii::EvaluationFlags::values);
+    auto integral = dealii::make_vectorized_array<double>(0.);
+    auto volume = dealii::make_vectorized_array<double>(0.);
+    for (unsigned int q = 0; q < fe_eval.n_q_points; ++q)
+    {
+      integral += fe_eval.get_value(q) * fe_eval.JxW(q);
+      volume += fe_eval.JxW(q);
+    }
+
+    for (unsigned int i = 0;
+         i < _matrix_free.n_active_entries_per_cell_batch(cell); ++i)
+    {
+      typename CellDiagnostics<dim>::CellValues cell_values;
+      cell_values.cell = _matrix_free.get_cell_iterator(cell, i);
+      cell_values.average_temperature = integral[i] / volume[i];
+      cell_values.min_temperature = min_temperature[i];
+      cell_values.max_temperature = max_temperature[i];
+      cell_values.volume = volume[i];
+      diagnostics.add_cell(cell_values);
+    }
+  }
+
+  if (!has_ghost_elements)
+    temperature.zero_out_ghost_values();
+
+  diagnostics.reduce(_communicator);
+}
+
 template <int dim, int fe_degree, typename MemorySpaceType>
 void ThermalOperator<dim, fe_degree, MemorySpaceType>::vmult(
     dealii::LA::distributed::Vector<double, MemorySpaceType> &dst,
@@ -179,9 +379,10 @@ void ThermalOperator<dim, fe_degree, MemorySpaceType>::vmult_add(
 {
   // Execute the matrix-free matrix-vector multiplication
 
-  // If we use adiabatic boundary condition, we have nothing to do on the faces
-  // of the cell
-  if (_boundary_type & BoundaryType::adiabatic)
+  // If we use adiabatic boundary condition and no material has been
+  // condensed, we have nothing to do on the faces of the cell
+  if ((_boundary_type & BoundaryType::adiabatic) &&
+      (_condensation_heat_transfer_coef == 0.))
   {
     _matrix_free.cell_loop(&ThermalOperator::cell_local_apply, this, dst, src);
   }
@@ -208,6 +409,48 @@ void ThermalOperator<dim, fe_degree, MemorySpaceType>::vmult_add(
     dst.local_element(dof) += scaling * src.local_element(dof);
 }
 
+template <int dim, int fe_degree, typename MemorySpaceType>
+void ThermalOperator<dim, fe_degree, MemorySpaceType>::set_cell_mask(
+    std::vector<bool> const &cell_mask)
+{
+  _cell_batch_mask.clear();
+  _face_batch_mask.clear();
+  if (cell_mask.empty())
+    return;
+
+  // A batch is applied if at least one of its cells is flagged.
+  unsigned int const n_cells = _matrix_free.n_cell_batches();
+  _cell_batch_mask.resize(n_cells, false);
+  for (unsigned int cell = 0; cell < n_cells; ++cell)
+    for (unsigned int i = 0;
+         i < _matrix_free.n_active_entries_per_cell_batch(cell); ++i)
+      if (cell_mask[_matrix_free.get_cell_iterator(cell, i)
+                        ->active_cell_index()])
+        _cell_batch_mask[cell] = true;
+
+  // A face batch is applied if at least one of the cells on either side of
+  // its faces is flagged.
+  unsigned int const n_inner_faces = _matrix_free.n_inner_face_batches();
+  unsigned int const n_faces =
+      n_inner_faces + _matrix_free.n_boundary_face_batches();
+  _face_batch_mask.resize(n_faces, false);
+  for (unsigned int face = 0; face < n_faces; ++face)
+    for (unsigned int i = 0;
+         i < _matrix_free.n_active_entries_per_face_batch(face); ++i)
+    {
+      auto const cell_1 = _matrix_free.get_face_iterator(face, i, true).first;
+      if (cell_mask[cell_1->active_cell_index()])
+        _face_batch_mask[face] = true;
+      if (face < n_inner_faces)
+      {
+        auto const cell_2 =
+            _matrix_free.get_face_iterator(face, i, false).first;
+        if (cell_mask[cell_2->active_cell_index()])
+          _face_batch_mask[face] = true;
+      }
+    }
+}
+
 template <int dim, int fe_degree, typename MemorySpaceType>
 void ThermalOperator<dim, fe_degree, MemorySpaceType>::Tvmult_add(
     dealii::LA::distributed::Vector<double, MemorySpaceType> &dst,
@@ -402,6 +645,9 @@ void ThermalOperator<dim, fe_degree, MemorySpaceType>::cell_local_apply(
   for (unsigned int cell = cell_subrange.first; cell < cell_subrange.second;
        ++cell)
   {
+    // Skip the cells that are not in the mask
+    if ((!_cell_batch_mask.empty()) && (!_cell_batch_mask[cell]))
+      continue;
     // Reinit fe_eval on the current cell
     fe_eval.reinit(cell);
     // Store in a local vector the local values of src
@@ -428,6 +674,13 @@ void ThermalOperator<dim, fe_degree, MemorySpaceType>::cell_local_apply(
                                        temperature_powers);
       auto th_conductivity_grad = fe_eval.get_gradient(q);
 
+      // In a frame moving with the beam, the material moves with the opposite
+      // velocity and the advection term is added to the time derivative.
+      dealii::VectorizedArray<double> advection = 0.;
+      for (unsigned int d = 0; d < dim; ++d)
+        if (_advection_velocity[d] != 0.)
+          advection += _advection_velocity[d] * th_conductivity_grad[d];
+
       // In 2D we only use x and z, and there are no deposition angle
       if constexpr (dim == 2)
       {
@@ -504,7 +757,7 @@ void ThermalOperator<dim, fe_degree, MemorySpaceType>::cell_local_apply(
       }
       quad_pt_source *= inv_rho_cp;
 
-      fe_eval.submit_value(quad_pt_source, q);
+      fe_eval.submit_value(quad_pt_source + advection, q);
     }
     // Sum over the quadrature points.
     fe_eval.integrate(dealii::EvaluationFlags::values |
@@ -566,6 +819,9 @@ void ThermalOperator<dim, fe_degree, MemorySpaceType>::face_local_apply(
   // Loop over the faces
   for (unsigned int face = face_range.first; face < face_range.second; ++face)
   {
+    // Skip the faces that are not in the mask
+    if ((face < _face_batch_mask.size()) && (!_face_batch_mask[face]))
+      continue;
     // Reinit fe_face_eval on the current face
     fe_face_eval.reinit(face);
     // Store in a local vector the local values of src
@@ -627,7 +883,40 @@ void ThermalOperator<dim, fe_degree, MemorySpaceType>::face_local_apply(
           -inv_rho_cp *
           (conv_heat_transfer_coef * (temperature - conv_temperature_infty) +
            rad_heat_transfer_coef * (temperature - rad_temperature_infty));
-      fe_face_eval.submit_value(boundary_val * fe_face_eval.get_value(q), q);
+      auto face_val = boundary_val * fe_face_eval.get_value(q);
+      if (_boundary_type & BoundaryType::far_field)
+      {
+        // The far-field faces are replaced by the conduction in a
+        // semi-infinite body whose surface temperature changes suddenly. The
+        // heat flux is k (T - T_far) / sqrt(pi alpha t) with alpha = k /
+        // (rho cp).
+        auto const far_field = _face_far_field[face];
+        auto const thermal_conductivity =
+            _material_properties.compute_material_property(
+                StateProperty::thermal_conductivity_z, material_id.data(),
+                face_state_ratios.data(), temperature, temperature_powers);
+        auto const far_field_heat_transfer_coef =
+            std::sqrt(thermal_conductivity /
+                      (inv_rho_cp * dealii::numbers::PI *
+                       (_time + _far_field_time_offset)));
+        face_val = (1. - far_field) * face_val -
+                   far_field * inv_rho_cp * far_field_heat_transfer_coef *
+                       (temperature - _far_field_temperature);
+      }
+      if (_condensation_heat_transfer_coef > 0.)
+      {
+        // The faces shared with the condensed material are not part of the
+        // boundary of the part. Only the heat exchanged with the condensed
+        // material is used.
+        auto const condensed = _face_condensed[face];
+        face_val = (1. - condensed) * face_val -
+                   condensed * inv_rho_cp * _condensation_heat_transfer_coef *
+                       (temperature - _condensation_temperature);
+      }
+      // The faces on the symmetry plane are adiabatic.
+      if (_boundary_type & BoundaryType::symmetry)
+        face_val = (1. - _face_symmetry[face]) * face_val;
+      fe_face_eval.submit_value(face_val, q);
     }
     // Sum over the quadrature points
     fe_face_eval.integrate(dealii::EvaluationFlags::values);
@@ -665,9 +954,10 @@ void ThermalOperator<dim, fe_degree,
         _material_id(cell, q)[i] = cell_tria->material_id();
       }
 
-  // If we are using boundary conditions other than adiabatic, we also need to
-  // update the face variables
-  if (!(_boundary_type & BoundaryType::adiabatic))
+  // If we are using boundary conditions other than adiabatic or if some
+  // material has been condensed, we also need to update the face variables
+  if (!(_boundary_type & BoundaryType::adiabatic) ||
+      (_condensation_heat_transfer_coef > 0.))
   {
     unsigned int const n_inner_faces = _matrix_free.n_inner_face_batches();
     unsigned int const n_boundary_faces =
@@ -678,6 +968,12 @@ void ThermalOperator<dim, fe_degree,
 
     _face_powder_ratio.reinit(n_faces, fe_face_eval.n_q_points);
     _face_material_id.reinit(n_faces, fe_face_eval.n_q_points);
+    _face_condensed.resize_fast(n_faces);
+    _face_condensed.fill(dealii::make_vectorized_array<double>(0.));
+    _face_far_field.resize_fast(n_faces);
+    _face_far_field.fill(dealii::make_vectorized_array<double>(0.));
+    _face_symmetry.resize_fast(n_faces);
+    _face_symmetry.fill(dealii::make_vectorized_array<double>(0.));
 
     for (unsigned int face = 0; face < n_inner_faces; ++face)
       for (unsigned int q = 0; q < fe_face_eval.n_q_points; ++q)
@@ -707,6 +1003,11 @@ void ThermalOperator<dim, fe_degree,
                                                      MaterialState::powder);
             _face_material_id(face, q)[i] = cell_tria->material_id();
           }
+          // The material below the condensation height that is not activated
+          // has been condensed.
+          auto const &cell_nothing = (active_fe_index_1 == 0) ? cell_2 : cell_1;
+          if (cell_nothing->center()[axis<dim>::z] < _condensation_height)
+            _face_condensed[face][i] = 1.;
         }
 
     for (unsigned int face = n_inner_faces; face < n_faces; ++face)
@@ -721,6 +1022,12 @@ void ThermalOperator<dim, fe_degree,
           {
             continue;
           }
+          if ((_boundary_type & BoundaryType::far_field) &&
+              (cell->face(face_)->center()[axis<dim>::z] < _far_field_height))
+            _face_far_field[face][i] = 1.;
+          if ((_boundary_type & BoundaryType::symmetry) &&
+              (cell->face(face_)->boundary_id() == g_symmetry_boundary_id))
+            _face_symmetry[face][i] = 1.;
           // We need the cell that has FE_Q not the one that has FE_Nothing
           // Cast to Triangulation<dim>::cell_iterator to access the material_id
           typename dealii::Triangulation<dim>::active_cell_iterator cell_tria(
@@ -772,20 +1079,31 @@ void ThermalOperator<dim, fe_degree, MemorySpaceType>::
   ASSERT((pos == 0) || (pos - 1 < deposition_cos.size()),
          "Out-of-bound access.");
 
-  for (unsigned int cell = 0; cell < n_cells; ++cell)
-    for (unsigned int q = 0; q < fe_eval.n_q_points; ++q)
-      for (unsigned int i = 0;
-           i < _matrix_free.n_active_entries_per_cell_batch(cell); ++i)
+  // The cell batches are independent, so they are filled in parallel using
+  // threads.
+  unsigned int const n_q_points = fe_eval.n_q_points;
+  dealii::parallel::apply_to_subranges(
+      0U, n_cells,
+      [&](unsigned int const begin, unsigned int const end)
       {
-        dof_cell_iterator cell_it = _matrix_free.get_cell_iterator(cell, i);
-
-        if (cell_it->active_fe_index() == 0)
-        {
-          unsigned int const j = cell_mapping[cell_it];
-          _deposition_cos(cell, q)[i] = deposition_cos[j];
-          _deposition_sin(cell, q)[i] = deposition_sin[j];
-        }
-      }
+        for (unsigned int cell = begin; cell < end; ++cell)
+          for (unsigned int i = 0;
+               i < _matrix_free.n_active_entries_per_cell_batch(cell); ++i)
+          {
+            dof_cell_iterator cell_it = _matrix_free.get_cell_iterator(cell, i);
+
+            if (cell_it->active_fe_index() == 0)
+            {
+              unsigned int const j = cell_mapping.at(cell_it);
+              for (unsigned int q = 0; q < n_q_points; ++q)
+              {
+                _deposition_cos(cell, q)[i] = deposition_cos[j];
+                _deposition_sin(cell, q)[i] = deposition_sin[j];
+              }
+            }
+          }
+      },
+      16);
 }
 
 } // namespace adamantine
@@ -1,4 +1,4 @@
-/* Copyright (c) 2016 - 2022, the adamantine authors.
+/* Copyright (c) 2016 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -16,6 +16,8 @@
 #include <deal.II/base/vectorization.h>
 #include <deal.II/matrix_free/matrix_free.h>
 
+#include <limits>
+
 namespace adamantine
 {
 /**
@@ -26,10 +28,16 @@ template <int dim, int fe_degree, typename MemorySpaceType>
 class ThermalOperator final : public ThermalOperatorBase<dim, MemorySpaceType>
 {
 public:
+  /**
+   * Constructor. The gradients on the inner faces, which are only needed by
+   * compute_refinement_indicator(), are computed if @p refinement_indicator
+   * is true.
+   */
   ThermalOperator(
       MPI_Comm const &communicator, BoundaryType boundary_type,
       MaterialProperty<dim, MemorySpaceType> &material_properties,
-      std::vector<std::shared_ptr<HeatSource<dim>>> const &heat_sources);
+      std::vector<std::shared_ptr<HeatSource<dim>>> const &heat_sources,
+      bool const refinement_indicator = false);
 
   /**
    * Associate the AffineConstraints<double> and the MatrixFree objects to the
@@ -52,6 +60,20 @@ public:
    */
   void clear() override;
 
+  std::size_t matrix_free_memory_consumption() const override;
+
+  std::size_t memory_consumption() const override;
+
+  dealii::Vector<float> compute_refinement_indicator(
+      dealii::LA::distributed::Vector<double, MemorySpaceType> const
+          &temperature,
+      double const min_temperature) const override;
+
+  void compute_cell_diagnostics(
+      dealii::LA::distributed::Vector<double, MemorySpaceType> const
+          &temperature,
+      CellDiagnostics<dim> &diagnostics) const override;
+
   dealii::types::global_dof_index m() const override;
 
   dealii::types::global_dof_index n() const override;
@@ -106,6 +128,16 @@ public:
 
   void set_time_and_source_height(double t, double height) override;
 
+  void set_cell_mask(std::vector<bool> const &cell_mask) override;
+
+  void set_condensation(double height, double heat_transfer_coef,
+                        double temperature) override;
+
+  void set_far_field(double height, double temperature,
+                     double time_offset) override;
+
+  void set_advection_velocity(dealii::Tensor<1, dim> const &velocity) override;
+
 private:
   /**
    * Update the ratios of the material state.
@@ -179,6 +211,10 @@ private:
    * Current height of the heat sources.
    */
   double _current_source_height = 0.;
+  /**
+   * Current time.
+   */
+  double _time = 0.;
   /**
    * Data to configure the MatrixFree object.
    */
@@ -199,6 +235,62 @@ private:
    * Underlying MatrixFree object.
    */
   dealii::MatrixFree<dim, double> _matrix_free;
+  /**
+   * Flags of the cell batches on which the operator is applied. If the vector
+   * is empty, the operator is applied on all the cell batches.
+   */
+  std::vector<bool> _cell_batch_mask;
+  /**
+   * Flags of the face batches on which the operator is applied. If the vector
+   * is empty, the operator is applied on all the face batches.
+   */
+  std::vector<bool> _face_batch_mask;
+  /**
+   * Height below which the material has been condensed.
+   */
+  double _condensation_height = std::numeric_limits<double>::lowest();
+  /**
+   * Heat transfer coefficient between the activated domain and the condensed
+   * material. If the value is zero, there is no condensed material.
+   */
+  double _condensation_heat_transfer_coef = 0.;
+  /**
+   * Temperature of the condensed material.
+   */
+  double _condensation_temperature = 0.;
+  /**
+   * For every face batch, the lanes are one if the face is shared with the
+   * condensed material and zero otherwise.
+   */
+  dealii::AlignedVector<dealii::VectorizedArray<double>> _face_condensed;
+  /**
+   * Height below which the faces of the boundary of the mesh use the
+   * far-field boundary condition.
+   */
+  double _far_field_height = std::numeric_limits<double>::lowest();
+  /**
+   * Temperature far from the far-field boundary.
+   */
+  double _far_field_temperature = 0.;
+  /**
+   * Time added to the current time when computing the heat transfer
+   * coefficient of the far-field boundary condition.
+   */
+  double _far_field_time_offset = 0.;
+  /**
+   * For every face batch, the lanes are one if the face uses the far-field
+   * boundary condition and zero otherwise.
+   */
+  dealii::AlignedVector<dealii::VectorizedArray<double>> _face_far_field;
+  /**
+   * For every face batch, the lanes are one if the face is on the symmetry
+   * plane and zero otherwise.
+   */
+  dealii::AlignedVector<dealii::VectorizedArray<double>> _face_symmetry;
+  /**
+   * Velocity of the frame in which the heat equation is written.
+   */
+  dealii::Tensor<1, dim> _advection_velocity;
   /**
    * Non-owning pointer to the AffineConstraints from ThermalPhysics.
    */
@@ -300,11 +392,38 @@ ThermalOperator<dim, fe_degree, MemorySpaceType>::initialize_dof_vector(
   _matrix_free.initialize_dof_vector(vector);
 }
 
+template <int dim, int fe_degree, typename MemorySpaceType>
+inline void ThermalOperator<dim, fe_degree, MemorySpaceType>::set_condensation(
+    double height, double heat_transfer_coef, double temperature)
+{
+  _condensation_height = height;
+  _condensation_heat_transfer_coef = heat_transfer_coef;
+  _condensation_temperature = temperature;
+}
+
+template <int dim, int fe_degree, typename MemorySpaceType>
+inline void ThermalOperator<dim, fe_degree, MemorySpaceType>::set_far_field(
+    double height, double temperature, double time_offset)
+{
+  _far_field_height = height;
+  _far_field_temperature = temperature;
+  _far_field_time_offset = time_offset;
+}
+
+template <int dim, int fe_degree, typename MemorySpaceType>
+inline void
+ThermalOperator<dim, fe_degree, MemorySpaceType>::set_advection_velocity(
+    dealii::Tensor<1, dim> const &velocity)
+{
+  _advection_velocity = velocity;
+}
+
 template <int dim, int fe_degree, typename MemorySpaceType>
 inline void
 ThermalOperator<dim, fe_degree, MemorySpaceType>::set_time_and_source_height(
     double t, double height)
 {
+  _time = t;
   _current_source_height = height;
   for (auto &beam : _heat_sources)
     beam->update_time(t);
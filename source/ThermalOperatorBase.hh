@@ -1,4 +1,4 @@
-/* Copyright (c) 2016 - 2022, the adamantine authors.
+/* Copyright (c) 2016 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -8,11 +8,14 @@
 #ifndef THERMAL_OPERATOR_BASE_HH
 #define THERMAL_OPERATOR_BASE_HH
 
+#include <CellDiagnostics.hh>
 #include <Operator.hh>
 
+#include <deal.II/base/tensor.h>
 #include <deal.II/dofs/dof_handler.h>
 #include <deal.II/hp/q_collection.h>
 #include <deal.II/lac/affine_constraints.h>
+#include <deal.II/lac/vector.h>
 
 namespace adamantine
 {
@@ -43,6 +46,38 @@ public:
 
   virtual void clear() = 0;
 
+  /**
+   * Return the memory used by the underlying MatrixFree object in bytes.
+   */
+  virtual std::size_t matrix_free_memory_consumption() const = 0;
+
+  /**
+   * Return the memory used by the data stored at the quadrature points and by
+   * the inverse of the mass matrix in bytes.
+   */
+  virtual std::size_t memory_consumption() const = 0;
+
+  /**
+   * Return a refinement indicator, indexed by the active cell index, based on
+   * the jump of the normal gradient of @p temperature across the faces inside
+   * the activated domain. The faces where the temperature is less than @p
+   * min_temperature are skipped.
+   */
+  virtual dealii::Vector<float> compute_refinement_indicator(
+      dealii::LA::distributed::Vector<double, MemorySpaceType> const
+          &temperature,
+      double const min_temperature) const = 0;
+
+  /**
+   * Compute the average, the extrema, and the volume of every activated cell
+   * reading @p temperature once, add them to @p diagnostics, and reduce the
+   * diagnostics over the processors.
+   */
+  virtual void compute_cell_diagnostics(
+      dealii::LA::distributed::Vector<double, MemorySpaceType> const
+          &temperature,
+      CellDiagnostics<dim> &diagnostics) const = 0;
+
   virtual void get_state_from_material_properties() = 0;
 
   virtual void set_state_to_material_properties() = 0;
@@ -52,6 +87,45 @@ public:
       std::vector<double> const &deposition_sin) = 0;
 
   virtual void set_time_and_source_height(double, double) = 0;
+
+  /**
+   * Restrict the application of the operator to the cells flagged in @p
+   * cell_mask, which is indexed by the active cell index. The cells that are
+   * not flagged may be skipped, so the result is only meaningful for the dofs
+   * whose cells are all flagged. An empty mask removes the restriction.
+   */
+  virtual void set_cell_mask(std::vector<bool> const &cell_mask) = 0;
+
+  /**
+   * Replace the material below @p height, which has been removed from the
+   * activated domain, by a Robin boundary condition on the faces it shares
+   * with the activated domain. The heat transfer coefficient of the boundary
+   * condition is @p heat_transfer_coef and the temperature of the removed
+   * material is @p temperature. The faces are found when
+   * get_state_from_material_properties() is called. If @p heat_transfer_coef
+   * is zero, the faces are treated like the other boundaries of the activated
+   * domain.
+   */
+  virtual void set_condensation(double height, double heat_transfer_coef,
+                                double temperature) = 0;
+
+  /**
+   * Set the parameters of the far-field boundary condition. The condition is
+   * applied on the faces of the boundary of the mesh whose center is below @p
+   * height. The temperature far from the boundary is @p temperature and @p
+   * time_offset is added to the time when computing the heat transfer
+   * coefficient.
+   */
+  virtual void set_far_field(double height, double temperature,
+                             double time_offset) = 0;
+
+  /**
+   * Add the advection term @p velocity \f$\cdot \nabla T\f$ to the operator.
+   * This term appears when the heat equation is written in a frame moving
+   * with the velocity @p velocity. A zero velocity removes the term.
+   */
+  virtual void
+  set_advection_velocity(dealii::Tensor<1, dim> const &velocity) = 0;
 };
 } // namespace adamantine
 #endif
@@ -1,4 +1,4 @@
-/* Copyright (c) 2016 - 2022, the adamantine authors.
+/* Copyright (c) 2016 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -504,6 +504,60 @@ void ThermalOperatorDevice<dim, fe_degree, MemorySpaceType>::clear()
   _inverse_mass_matrix->reinit(0);
 }
 
+template <int dim, int fe_degree, typename MemorySpaceType>
+std::size_t
+ThermalOperatorDevice<dim, fe_degree,
+                      MemorySpaceType>::matrix_free_memory_consumption() const
+{
+  return _matrix_free.memory_consumption();
+}
+
+template <int dim, int fe_degree, typename MemorySpaceType>
+std::size_t
+ThermalOperatorDevice<dim, fe_degree, MemorySpaceType>::memory_consumption()
+    const
+{
+  std::size_t cell_it_to_mf_pos_memory = 0;
+  for (auto const &pos : _cell_it_to_mf_pos)
+    cell_it_to_mf_pos_memory +=
+        sizeof(pos) + pos.second.size() * sizeof(unsigned int);
+
+  return _liquid_ratio.memory_consumption() +
+         _powder_ratio.memory_consumption() +
+         _material_id.memory_consumption() +
+         _inv_rho_cp.memory_consumption() +
+         _deposition_cos.memory_consumption() +
+         _deposition_sin.memory_consumption() +
+         _inverse_mass_matrix->memory_consumption() + cell_it_to_mf_pos_memory +
+         _inv_rho_cp_cells.size() *
+             sizeof(typename decltype(_inv_rho_cp_cells)::value_type);
+}
+
+template <int dim, int fe_degree, typename MemorySpaceType>
+dealii::Vector<float>
+ThermalOperatorDevice<dim, fe_degree, MemorySpaceType>::
+    compute_refinement_indicator(
+        dealii::LA::distributed::Vector<double, MemorySpaceType> const &,
+        double const) const
+{
+  // CUDAWrappers::MatrixFree does not support loops over the faces.
+  ASSERT_THROW(false, "Error: The gradient jump refinement indicator is not "
+                      "implemented on the device. Use the Kelly error "
+                      "estimator instead.");
+
+  return dealii::Vector<float>();
+}
+
+template <int dim, int fe_degree, typename MemorySpaceType>
+void ThermalOperatorDevice<dim, fe_degree, MemorySpaceType>::
+    compute_cell_diagnostics(
+        dealii::LA::distributed::Vector<double, MemorySpaceType> const &,
+        CellDiagnostics<dim> &) const
+{
+  ASSERT_THROW(false, "Error: The cell diagnostics are not implemented on the "
+                      "device.");
+}
+
 template <int dim, int fe_degree, typename MemorySpaceType>
 void ThermalOperatorDevice<dim, fe_degree, MemorySpaceType>::vmult(
     dealii::LA::distributed::Vector<double, MemorySpaceType> &dst,
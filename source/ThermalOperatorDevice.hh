@@ -1,4 +1,4 @@
-/* Copyright (c) 2016 - 2022, the adamantine authors.
+/* Copyright (c) 2016 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -35,6 +35,20 @@ public:
 
   void clear() override;
 
+  std::size_t matrix_free_memory_consumption() const override;
+
+  std::size_t memory_consumption() const override;
+
+  dealii::Vector<float> compute_refinement_indicator(
+      dealii::LA::distributed::Vector<double, MemorySpaceType> const
+          &temperature,
+      double const min_temperature) const override;
+
+  void compute_cell_diagnostics(
+      dealii::LA::distributed::Vector<double, MemorySpaceType> const
+          &temperature,
+      CellDiagnostics<dim> &diagnostics) const override;
+
   dealii::types::global_dof_index m() const override;
 
   dealii::types::global_dof_index n() const override;
@@ -89,6 +103,27 @@ public:
     // TODO
   }
 
+  void set_cell_mask(std::vector<bool> const &) override
+  {
+    // The mask is only an optimization. The operator is always applied on all
+    // the cells.
+  }
+
+  void set_condensation(double, double, double) override
+  {
+    // TODO
+  }
+
+  void set_far_field(double, double, double) override
+  {
+    // TODO
+  }
+
+  void set_advection_velocity(dealii::Tensor<1, dim> const &) override
+  {
+    // TODO
+  }
+
   /**
    * Update \f$ \frac{1}{\rho C_p} \f$ on the cells using the values computed at
    * the quadrature points.
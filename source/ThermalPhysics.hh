@@ -21,6 +21,9 @@
 
 #include <boost/property_tree/ptree.hpp>
 
+#include <functional>
+#include <limits>
+#include <map>
 #include <memory>
 
 namespace adamantine
@@ -57,6 +60,34 @@ public:
       dealii::LA::distributed::Vector<double, MemorySpaceType> &solution)
       override;
 
+  /**
+   * The cells of the activated domain whose top is below
+   * refinement.condensation.depth under the heat sources are deactivated if
+   * their temperature and the rate of change of their temperature are less
+   * than the thresholds. The material below the condensation height, which
+   * only decreases, is represented by its average temperature. The heat
+   * transfer coefficient between the activated domain and the condensed
+   * material is the one of a slab, i.e., twice the thermal conductivity
+   * divided by the thickness of the condensed material.
+   */
+  bool condense_cooled_material(
+      double const t,
+      dealii::LA::distributed::Vector<double, MemorySpaceType> &solution,
+      std::vector<Timer> &timers) override;
+
+  /**
+   * The velocity of the frame is the velocity of the heat sources, which must
+   * all move together. The nonlinear problem is solved using Newton's method
+   * with a line search. The Jacobian is applied using finite differences and
+   * it is inverted using GMRES. The temperature of the faces of the activated
+   * domain through which the material enters the frame is kept at its initial
+   * value.
+   */
+  unsigned int solve_quasi_steady_state(
+      double const t,
+      dealii::LA::distributed::Vector<double, MemorySpaceType> &solution,
+      std::vector<Timer> &timers) override;
+
   /**
    * For ThermalPhysics, update_physics_parameters is used to modify the heat
    * sources in the middle of a simulation, e.g. for data assimilation with an
@@ -102,6 +133,10 @@ public:
                        dealii::LA::distributed::Vector<double, MemorySpaceType>
                            &temperature) override;
 
+  void compute_cell_diagnostics(
+      dealii::LA::distributed::Vector<double, MemorySpaceType> &temperature,
+      CellDiagnostics<dim> &diagnostics) override;
+
   std::vector<bool> get_has_melted_vector() const override;
 
   void set_has_melted_vector(std::vector<bool> const &has_melted) override;
@@ -116,6 +151,14 @@ public:
 
   unsigned int get_fe_degree() const override;
 
+  Counters &get_counters() override;
+
+  void add_memory_consumption(MemoryReport &memory_report) const override;
+
+  dealii::Vector<float> compute_refinement_indicator(
+      dealii::LA::distributed::Vector<double, MemorySpaceType> const &solution,
+      double const min_temperature) const override;
+
   /**
    * Return the current height of the heat source.
    */
@@ -138,6 +181,43 @@ private:
                                    LA_Vector const &y,
                                    std::vector<Timer> &timers) const;
 
+  /**
+   * Evolve the solution from @p t to @p t + @p delta_t using two scales. The
+   * dofs outside of a window around the beams are advanced with a single time
+   * step while the dofs in the window are frozen. The dofs in the window are
+   * then advanced with _n_sub_steps sub-steps, the operator being only
+   * applied on the cells of the window. During the sub-steps, the dofs on the
+   * boundary of the window vary linearly between their values at the
+   * beginning and at the end of the time step.
+   */
+  double evolve_one_two_scale_time_step(double const t, double const delta_t,
+                                        LA_Vector &solution,
+                                        std::vector<Timer> &timers);
+
+  /**
+   * Return the flags, indexed by the active cell index, of the cells in the
+   * window around the path followed by the beams between @p t and @p t + @p
+   * delta_t.
+   */
+  std::vector<bool> compute_window_cells(double const t,
+                                         double const delta_t) const;
+
+  /**
+   * Change the active finite element of some cells and transfer the solution,
+   * the direction of deposition, the melting indicator, and the material
+   * state to the new mesh. @p set_future_fe_indices sets the future fe index
+   * of the cells that change. It can also modify the data transferred, which
+   * is indexed by the position of the cell in the active cell iterators. The
+   * dofs that did not exist are set to @p new_material_temperature.
+   */
+  void transfer_material(
+      std::function<void(
+          std::map<typename dealii::DoFHandler<dim>::active_cell_iterator,
+                   int> &cell_to_id,
+          std::vector<std::vector<double>> &data_to_transfer)> const
+          &set_future_fe_indices,
+      double const new_material_temperature, LA_Vector &solution);
+
   /**
    * This flag is true if the time stepping method is embedded.
    */
@@ -167,6 +247,63 @@ private:
    * Tolerance to inverte the ImplicitOperator.
    */
   double _tolerance;
+  /**
+   * Number of sub-steps taken in the window around the beams during one time
+   * step. If the value is one, the two-scale time stepping is not used.
+   */
+  unsigned int _n_sub_steps = 1;
+  /**
+   * Distance between the path of the beams and the boundary of the window.
+   */
+  double _window_margin = 0.;
+  /**
+   * Depth below the heat sources under which the cells can be condensed. If
+   * the value is negative, the material is never condensed.
+   */
+  double _condensation_depth = -1.;
+  /**
+   * The cells are condensed only if their temperature is less than this
+   * value.
+   */
+  double _condensation_temperature_threshold = 0.;
+  /**
+   * The cells are condensed only if the absolute value of the rate of change
+   * of their temperature is less than this value.
+   */
+  double _condensation_rate_threshold = 0.;
+  /**
+   * Thermal conductivity of the condensed material.
+   */
+  double _condensation_thermal_conductivity = 0.;
+  /**
+   * Height below which the material has been condensed.
+   */
+  double _condensation_height = std::numeric_limits<double>::lowest();
+  /**
+   * Volume of the condensed material.
+   */
+  double _condensed_volume = 0.;
+  /**
+   * Average temperature of the condensed material.
+   */
+  double _condensed_temperature = 0.;
+  /**
+   * Maximum number of Newton iterations of the quasi-steady solver.
+   */
+  unsigned int _quasi_steady_newton_max_iter = 20;
+  /**
+   * Tolerance of the quasi-steady solver relative to the initial residual.
+   */
+  double _quasi_steady_newton_tolerance = 1e-6;
+  /**
+   * Maximum number of GMRES iterations per Newton iteration of the
+   * quasi-steady solver.
+   */
+  unsigned int _quasi_steady_max_iter = 1000;
+  /**
+   * Maximum number of temporary vectors of GMRES in the quasi-steady solver.
+   */
+  unsigned int _quasi_steady_n_tmp_vectors = 30;
   /**
    * Current height of the object.
    */
@@ -234,6 +371,11 @@ private:
    * Shared pointer to the underlying time stepping scheme.
    */
   std::unique_ptr<dealii::TimeStepping::RungeKutta<LA_Vector>> _time_stepping;
+  /**
+   * Solver and throughput counters. The counters are mutable because they are
+   * updated in the const functions called by the time stepping scheme.
+   */
+  mutable Counters _counters;
 };
 
 template <int dim, int fe_degree, typename MemorySpaceType,
@@ -346,6 +488,14 @@ ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::get_fe_degree()
   return fe_degree;
 }
 
+template <int dim, int fe_degree, typename MemorySpaceType,
+          typename QuadratureType>
+inline Counters &
+ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::get_counters()
+{
+  return _counters;
+}
+
 template <int dim, int fe_degree, typename MemorySpaceType,
           typename QuadratureType>
 inline double ThermalPhysics<dim, fe_degree, MemorySpaceType,
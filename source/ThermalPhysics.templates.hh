@@ -18,11 +18,14 @@
 #include <CubeHeatSource.hh>
 #include <ElectronBeamHeatSource.hh>
 #include <GoldakHeatSource.hh>
+#include <LayerHeatSource.hh>
 #include <ThermalPhysics.hh>
 #include <Timer.hh>
 
+#include <deal.II/base/bounding_box.h>
 #include <deal.II/base/geometry_info.h>
 #include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/work_stream.h>
 #include <deal.II/distributed/cell_data_transfer.templates.h>
 #include <deal.II/dofs/dof_tools.h>
 #include <deal.II/fe/fe_nothing.h>
@@ -39,12 +42,38 @@
 #endif
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
 #include <memory>
 
 namespace adamantine
 {
 namespace
 {
+/**
+ * Wrap a function applying a linear operator so that it can be inverted by the
+ * deal.II solvers.
+ */
+template <typename VectorType>
+class FunctionOperator
+{
+public:
+  FunctionOperator(
+      std::function<void(VectorType &, VectorType const &)> const &vmult)
+      : _vmult(vmult)
+  {
+  }
+
+  void vmult(VectorType &dst, VectorType const &src) const
+  {
+    _vmult(dst, src);
+  }
+
+private:
+  std::function<void(VectorType &, VectorType const &)> _vmult;
+};
+
 template <int dim, int fe_degree, typename MemorySpaceType,
           std::enable_if_t<
               std::is_same<MemorySpaceType, dealii::MemorySpace::Host>::value,
@@ -54,7 +83,7 @@ evaluate_thermal_physics_impl(
     std::shared_ptr<ThermalOperatorBase<dim, MemorySpaceType>> thermal_operator,
     double const t, double const current_source_height,
     dealii::LA::distributed::Vector<double, MemorySpaceType> const &y,
-    std::vector<Timer> &timers)
+    std::vector<Timer> &timers, Counters &counters)
 {
   timers[evol_time_eval_th_ph].start();
   thermal_operator->set_time_and_source_height(t, current_source_height);
@@ -63,7 +92,11 @@ evaluate_thermal_physics_impl(
       y.get_partitioner());
   value = 0.;
   // Apply the Thermal Operator.
+  auto const vmult_start = std::chrono::steady_clock::now();
   thermal_operator->vmult_add(value, y);
+  std::chrono::duration<double> const vmult_time =
+      std::chrono::steady_clock::now() - vmult_start;
+  counters.add_vmult(y.size(), vmult_time.count());
 
   // Multiply by the inverse of the mass matrix.
   value.scale(*thermal_operator->get_inverse_mass_matrix());
@@ -102,7 +135,7 @@ evaluate_thermal_physics_impl(
     MaterialProperty<dim, MemorySpaceType> &material_properties,
     dealii::AffineConstraints<double> const &affine_constraints,
     dealii::LA::distributed::Vector<double, MemorySpaceType> const &y,
-    std::vector<Timer> &timers)
+    std::vector<Timer> &timers, Counters &counters)
 {
   auto thermal_operator_dev = std::dynamic_pointer_cast<
       ThermalOperatorDevice<dim, fe_degree, MemorySpaceType>>(thermal_operator);
@@ -116,7 +149,11 @@ evaluate_thermal_physics_impl(
       y.get_partitioner());
 
   // Apply the Thermal Operator.
+  auto const vmult_start = std::chrono::steady_clock::now();
   thermal_operator_dev->vmult(value_dev, y);
+  std::chrono::duration<double> const vmult_time =
+      std::chrono::steady_clock::now() - vmult_start;
+  counters.add_vmult(y.size(), vmult_time.count());
 
   // Compute the source term.
   // TODO do this on the GPU
@@ -133,31 +170,55 @@ evaluate_thermal_physics_impl(
   dealii::hp::QCollection<dim> source_q_collection;
   source_q_collection.push_back(dealii::QGauss<dim>(fe_degree + 1));
   source_q_collection.push_back(dealii::QGauss<dim>(1));
-  dealii::hp::FEValues<dim> hp_fe_values(fe_collection, source_q_collection,
-                                         dealii::update_quadrature_points |
-                                             dealii::update_values |
-                                             dealii::update_JxW_values);
   unsigned int const dofs_per_cell = fe_collection.max_dofs_per_cell();
   unsigned int const n_q_points = source_q_collection.max_n_quadrature_points();
-  std::vector<dealii::types::global_dof_index> local_dof_indices(dofs_per_cell);
   dealii::QGauss<dim - 1> face_quadrature(fe_degree + 1);
-  dealii::FEFaceValues<dim> fe_face_values(
-      fe_collection[0], face_quadrature,
-      dealii::update_values | dealii::update_quadrature_points |
-          dealii::update_JxW_values);
   unsigned int const n_face_q_points = face_quadrature.size();
-  dealii::Vector<double> cell_source(dofs_per_cell);
 
-  // Loop over the locally owned cells with an active FE index of zero
-  for (auto const &cell : dealii::filter_iterators(
-           dof_handler.active_cell_iterators(),
-           dealii::IteratorFilters::LocallyOwnedCell(),
-           dealii::IteratorFilters::ActiveFEIndexEqualTo(0)))
+  // The cells are assembled in parallel using threads. Every thread uses its
+  // own FEValues objects.
+  struct ScratchData
+  {
+    ScratchData(dealii::hp::FECollection<dim> const &fe_collection,
+                dealii::hp::QCollection<dim> const &q_collection,
+                dealii::Quadrature<dim - 1> const &face_quadrature)
+        : hp_fe_values(fe_collection, q_collection,
+                       dealii::update_quadrature_points |
+                           dealii::update_values | dealii::update_JxW_values),
+          fe_face_values(fe_collection[0], face_quadrature,
+                         dealii::update_values |
+                             dealii::update_quadrature_points |
+                             dealii::update_JxW_values)
+    {
+    }
+
+    ScratchData(ScratchData const &other)
+        : ScratchData(other.hp_fe_values.get_fe_collection(),
+                      other.hp_fe_values.get_quadrature_collection(),
+                      other.fe_face_values.get_quadrature())
+    {
+    }
+
+    dealii::hp::FEValues<dim> hp_fe_values;
+    dealii::FEFaceValues<dim> fe_face_values;
+  };
+
+  struct CopyData
   {
-    cell_source = 0.;
-    hp_fe_values.reinit(cell);
+    dealii::Vector<double> cell_source;
+    std::vector<dealii::types::global_dof_index> local_dof_indices;
+  };
+
+  auto worker = [&](typename dealii::DoFHandler<dim>::active_cell_iterator const
+                        &cell,
+                    ScratchData &scratch_data, CopyData &copy_data)
+  {
+    dealii::Vector<double> &cell_source = copy_data.cell_source;
+    cell_source.reinit(dofs_per_cell);
+    scratch_data.hp_fe_values.reinit(cell);
     dealii::FEValues<dim> const &fe_values =
-        hp_fe_values.get_present_fe_values();
+        scratch_data.hp_fe_values.get_present_fe_values();
+    dealii::FEFaceValues<dim> &fe_face_values = scratch_data.fe_face_values;
 
     for (unsigned int i = 0; i < dofs_per_cell; ++i)
     {
@@ -224,10 +285,24 @@ evaluate_thermal_physics_impl(
         }
       }
     }
-    cell->get_dof_indices(local_dof_indices);
-    affine_constraints.distribute_local_to_global(cell_source,
-                                                  local_dof_indices, source);
-  }
+    copy_data.local_dof_indices.resize(dofs_per_cell);
+    cell->get_dof_indices(copy_data.local_dof_indices);
+  };
+  auto copier = [&](CopyData const &copy_data)
+  {
+    affine_constraints.distribute_local_to_global(
+        copy_data.cell_source, copy_data.local_dof_indices, source);
+  };
+
+  // Loop over the locally owned cells with an active FE index of zero
+  auto const filtered_cells = dealii::filter_iterators(
+      dof_handler.active_cell_iterators(),
+      dealii::IteratorFilters::LocallyOwnedCell(),
+      dealii::IteratorFilters::ActiveFEIndexEqualTo(0));
+  dealii::WorkStream::run(
+      filtered_cells.begin(), filtered_cells.end(), worker, copier,
+      ScratchData(fe_collection, source_q_collection, face_quadrature),
+      CopyData());
   source.compress(dealii::VectorOperation::add);
 
   // Add source
@@ -298,17 +373,23 @@ ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::ThermalPhysics(
     std::string type = beam_database.get<std::string>("type");
     if (type == "goldak")
     {
-      _heat_sources[i] = std::make_shared<GoldakHeatSource<dim>>(beam_database);
+      _heat_sources[i] =
+          std::make_shared<GoldakHeatSource<dim>>(beam_database, communicator);
     }
     else if (type == "electron_beam")
     {
-      _heat_sources[i] =
-          std::make_shared<ElectronBeamHeatSource<dim>>(beam_database);
+      _heat_sources[i] = std::make_shared<ElectronBeamHeatSource<dim>>(
+          beam_database, communicator);
     }
     else if (type == "cube")
     {
       _heat_sources[i] = std::make_shared<CubeHeatSource<dim>>(beam_database);
     }
+    else if (type == "layer")
+    {
+      _heat_sources[i] =
+          std::make_shared<LayerHeatSource<dim>>(beam_database, communicator);
+    }
     else
     {
       ASSERT_THROW(false, "Error: Beam type '" +
@@ -340,6 +421,10 @@ ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::ThermalPhysics(
       {
         _boundary_type |= BoundaryType::convective;
       }
+      else if (boundary == "far_field")
+      {
+        _boundary_type |= BoundaryType::far_field;
+      }
       else
       {
         ASSERT_THROW(false, "Unknown boundary type.");
@@ -353,12 +438,30 @@ ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::ThermalPhysics(
     boundary_type_str.erase(0, pos_str + delimiter.length());
   }
   parse_boundary_type(boundary_type_str);
+  // The faces on the symmetry plane of a half domain are adiabatic. There is
+  // nothing to do if all the faces are adiabatic.
+  // PropertyTreeInput geometry.symmetry
+  if (database.get("geometry.symmetry", false) &&
+      !(_boundary_type & BoundaryType::adiabatic))
+  {
+    ASSERT_THROW(
+        (std::is_same<MemorySpaceType, dealii::MemorySpace::Host>::value),
+        "Error: The symmetry plane is not implemented on the device with "
+        "non-adiabatic boundary conditions.");
+    _boundary_type |= BoundaryType::symmetry;
+  }
 
-  // Create the thermal operator
+  // Create the thermal operator. The gradients on the inner faces are only
+  // computed if the gradient jump indicator is used.
+  // PropertyTreeInput refinement.error_estimator
+  bool const refinement_indicator =
+      database.get<std::string>("refinement.error_estimator", "kelly") ==
+      "gradient_jump";
   if (std::is_same<MemorySpaceType, dealii::MemorySpace::Host>::value)
     _thermal_operator =
         std::make_shared<ThermalOperator<dim, fe_degree, MemorySpaceType>>(
-            communicator, _boundary_type, _material_properties, _heat_sources);
+            communicator, _boundary_type, _material_properties, _heat_sources,
+            refinement_indicator);
 #if defined(ADAMANTINE_HAVE_CUDA) && defined(__CUDACC__)
   else
     _thermal_operator = std::make_shared<
@@ -366,6 +469,27 @@ ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::ThermalPhysics(
         communicator, _boundary_type, _material_properties);
 #endif
 
+  if (_boundary_type & BoundaryType::far_field)
+  {
+    ASSERT_THROW(
+        (std::is_same<MemorySpaceType, dealii::MemorySpace::Host>::value),
+        "Error: The far-field boundary condition is not implemented on the "
+        "device.");
+    // PropertyTreeInput boundary.far_field_height
+    double const far_field_height = database.get(
+        "boundary.far_field_height",
+        database.get("geometry.material_height", 1e9));
+    // PropertyTreeInput boundary.far_field_temperature
+    double const far_field_temperature =
+        database.get("boundary.far_field_temperature",
+                     database.get("materials.initial_temperature", 300.));
+    // PropertyTreeInput boundary.far_field_time_offset
+    double const far_field_time_offset =
+        database.get("boundary.far_field_time_offset", 1e-3);
+    _thermal_operator->set_far_field(far_field_height, far_field_temperature,
+                                     far_field_time_offset);
+  }
+
   // Create the time stepping scheme
   boost::property_tree::ptree const &time_stepping_database =
       database.get_child("time_stepping");
@@ -505,6 +629,59 @@ ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::ThermalPhysics(
         _thermal_operator, jfnk);
   }
 
+  // PropertyTreeInput time_stepping.two_scale.n_sub_steps
+  _n_sub_steps = time_stepping_database.get("two_scale.n_sub_steps", 1u);
+  if (_n_sub_steps > 1)
+  {
+    // PropertyTreeInput time_stepping.two_scale.window_margin
+    _window_margin =
+        time_stepping_database.get<double>("two_scale.window_margin");
+    ASSERT_THROW((_embedded_method == false) && (_implicit_method == false),
+                 "Error: The two-scale time stepping requires an explicit "
+                 "method with a constant time step.");
+    ASSERT_THROW(
+        (std::is_same<MemorySpaceType, dealii::MemorySpace::Host>::value),
+        "Error: The two-scale time stepping is not implemented on the device.");
+  }
+
+  boost::optional<boost::property_tree::ptree const &> condensation_database =
+      database.get_child_optional("refinement.condensation");
+  if (condensation_database)
+  {
+    // PropertyTreeInput refinement.condensation.depth
+    _condensation_depth = condensation_database->get<double>("depth");
+    // PropertyTreeInput refinement.condensation.temperature
+    _condensation_temperature_threshold =
+        condensation_database->get<double>("temperature");
+    // PropertyTreeInput refinement.condensation.temperature_rate
+    _condensation_rate_threshold = condensation_database->get(
+        "temperature_rate", std::numeric_limits<double>::infinity());
+    // PropertyTreeInput refinement.condensation.thermal_conductivity
+    _condensation_thermal_conductivity =
+        condensation_database->get<double>("thermal_conductivity");
+    ASSERT_THROW(
+        (std::is_same<MemorySpaceType, dealii::MemorySpace::Host>::value),
+        "Error: The condensation of the cooled material is not implemented on "
+        "the device.");
+  }
+
+  boost::optional<boost::property_tree::ptree const &> quasi_steady_database =
+      database.get_child_optional("time_stepping.quasi_steady");
+  if (quasi_steady_database)
+  {
+    // PropertyTreeInput time_stepping.quasi_steady.newton_max_iteration
+    _quasi_steady_newton_max_iter =
+        quasi_steady_database->get("newton_max_iteration", 20u);
+    // PropertyTreeInput time_stepping.quasi_steady.newton_tolerance
+    _quasi_steady_newton_tolerance =
+        quasi_steady_database->get("newton_tolerance", 1e-6);
+    // PropertyTreeInput time_stepping.quasi_steady.max_iteration
+    _quasi_steady_max_iter = quasi_steady_database->get("max_iteration", 1000u);
+    // PropertyTreeInput time_stepping.quasi_steady.n_tmp_vectors
+    _quasi_steady_n_tmp_vectors =
+        quasi_steady_database->get("n_tmp_vectors", 30u);
+  }
+
   // Set material on part of the domain
   // PropertyTreeInput geometry.material_height
   double const material_height = database.get("geometry.material_height", 1e9);
@@ -555,6 +732,48 @@ void ThermalPhysics<dim, fe_degree, MemorySpaceType,
   _affine_constraints.close();
 
   _thermal_operator->reinit(_dof_handler, _affine_constraints, _q_collection);
+
+  // Update the size of the problem in the counters.
+  unsigned int n_local_active_cells = 0;
+  for (auto const &cell :
+       dealii::filter_iterators(_dof_handler.active_cell_iterators(),
+                                dealii::IteratorFilters::LocallyOwnedCell()))
+  {
+    if (cell->active_fe_index() == 0)
+      ++n_local_active_cells;
+  }
+  _counters.set(n_active_dofs, _dof_handler.n_dofs());
+  _counters.set(n_active_cells,
+                dealii::Utilities::MPI::sum(
+                    static_cast<unsigned long long>(n_local_active_cells),
+                    _dof_handler.get_communicator()));
+}
+
+template <int dim, int fe_degree, typename MemorySpaceType,
+          typename QuadratureType>
+void ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
+    add_memory_consumption(MemoryReport &memory_report) const
+{
+  memory_report.add("Thermal DoFHandler", _dof_handler.memory_consumption());
+  memory_report.add("Thermal AffineConstraints",
+                    _affine_constraints.memory_consumption());
+  memory_report.add("Thermal MatrixFree",
+                    _thermal_operator->matrix_free_memory_consumption());
+  memory_report.add("Thermal quadrature data",
+                    _thermal_operator->memory_consumption());
+}
+
+template <int dim, int fe_degree, typename MemorySpaceType,
+          typename QuadratureType>
+dealii::Vector<float>
+ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
+    compute_refinement_indicator(
+        dealii::LA::distributed::Vector<double, MemorySpaceType> const
+            &solution,
+        double const min_temperature) const
+{
+  return _thermal_operator->compute_refinement_indicator(solution,
+                                                         min_temperature);
 }
 
 template <int dim, int fe_degree, typename MemorySpaceType,
@@ -579,12 +798,11 @@ void ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
   temperature.update_ghost_values();
   auto dofs_per_cell = _dof_handler.get_fe().dofs_per_cell;
 
-  dealii::hp::FEValues<dim> hp_fe_values(
-      _dof_handler.get_fe_collection(), _q_collection,
-      dealii::UpdateFlags::update_values |
-          dealii::UpdateFlags::update_JxW_values);
-
-  unsigned int const n_q_points = _q_collection.max_n_quadrature_points();
+  // Collect the cells that have not melted yet with their position in
+  // _has_melted. The average temperature of these cells is then computed in
+  // parallel using threads.
+  using cell_iterator = typename dealii::DoFHandler<dim>::active_cell_iterator;
+  std::vector<std::pair<cell_iterator, unsigned int>> cells;
   unsigned int cell_id = 0;
   for (auto const &cell : dealii::filter_iterators(
            _dof_handler.active_cell_iterators(),
@@ -592,35 +810,86 @@ void ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
            dealii::IteratorFilters::ActiveFEIndexEqualTo(0)))
   {
     if (!_has_melted[cell_id])
-    {
-      hp_fe_values.reinit(cell);
-      dealii::FEValues<dim> const &fe_values =
-          hp_fe_values.get_present_fe_values();
+      cells.emplace_back(cell, cell_id);
+    ++cell_id;
+  }
 
-      std::vector<dealii::types::global_dof_index> local_dof_indices(
-          fe_values.dofs_per_cell);
-      cell->get_dof_indices(local_dof_indices);
+  dealii::hp::FEValues<dim> hp_fe_values(
+      _dof_handler.get_fe_collection(), _q_collection,
+      dealii::UpdateFlags::update_values |
+          dealii::UpdateFlags::update_JxW_values);
 
-      double cell_temperature = 0.0;
-      double cell_volume = 0.0;
-      for (unsigned int i = 0; i < dofs_per_cell; ++i)
-      {
-        for (unsigned int q = 0; q < n_q_points; ++q)
-        {
-          cell_temperature += fe_values.shape_value(i, q) *
-                              temperature(local_dof_indices[i]) *
-                              fe_values.JxW(q);
-          cell_volume += fe_values.shape_value(i, q) * fe_values.JxW(q);
-        }
-      }
-      cell_temperature /= cell_volume;
+  unsigned int const n_q_points = _q_collection.max_n_quadrature_points();
+  // The copy data is the position of the cell in _has_melted and a flag set if
+  // the cell has melted. std::vector<bool> cannot be written by several
+  // threads, so _has_melted is only updated by the copier.
+  using CopyData = std::pair<unsigned int, bool>;
+  auto worker = [&](typename std::vector<
+                        std::pair<cell_iterator, unsigned int>>::const_iterator
+                        const &cell_pair,
+                    dealii::hp::FEValues<dim> &scratch_fe_values,
+                    CopyData &copy_data)
+  {
+    scratch_fe_values.reinit(cell_pair->first);
+    dealii::FEValues<dim> const &fe_values =
+        scratch_fe_values.get_present_fe_values();
+
+    std::vector<dealii::types::global_dof_index> local_dof_indices(
+        fe_values.dofs_per_cell);
+    cell_pair->first->get_dof_indices(local_dof_indices);
 
-      // Set the indicator that this cell has melted
-      if (cell_temperature > threshold_temperature)
+    double cell_temperature = 0.0;
+    double cell_volume = 0.0;
+    for (unsigned int i = 0; i < dofs_per_cell; ++i)
+    {
+      for (unsigned int q = 0; q < n_q_points; ++q)
       {
-        _has_melted[cell_id] = true;
+        cell_temperature += fe_values.shape_value(i, q) *
+                            temperature(local_dof_indices[i]) *
+                            fe_values.JxW(q);
+        cell_volume += fe_values.shape_value(i, q) * fe_values.JxW(q);
       }
     }
+    cell_temperature /= cell_volume;
+
+    copy_data.first = cell_pair->second;
+    copy_data.second = cell_temperature > threshold_temperature;
+  };
+  auto copier = [&](CopyData const &copy_data)
+  {
+    // Set the indicator that this cell has melted
+    if (copy_data.second)
+      _has_melted[copy_data.first] = true;
+  };
+  dealii::WorkStream::run(cells.cbegin(), cells.cend(), worker, copier,
+                          hp_fe_values, CopyData(0, false));
+}
+
+template <int dim, int fe_degree, typename MemorySpaceType,
+          typename QuadratureType>
+void ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
+    compute_cell_diagnostics(
+        dealii::LA::distributed::Vector<double, MemorySpaceType> &temperature,
+        CellDiagnostics<dim> &diagnostics)
+{
+  ASSERT_THROW(
+      (std::is_same<MemorySpaceType, dealii::MemorySpace::Host>::value),
+      "Error: The cell diagnostics are only available on the host.");
+
+  _thermal_operator->compute_cell_diagnostics(temperature, diagnostics);
+
+  // _has_melted is indexed by the position of the cell among the locally owned
+  // activated cells. Only the cell iterators are traversed here, the
+  // temperature has already been read.
+  std::vector<bool> const &melted_cells = diagnostics.get_melted_cells();
+  unsigned int cell_id = 0;
+  for (auto const &cell : dealii::filter_iterators(
+           _dof_handler.active_cell_iterators(),
+           dealii::IteratorFilters::LocallyOwnedCell(),
+           dealii::IteratorFilters::ActiveFEIndexEqualTo(0)))
+  {
+    if (melted_cells[cell->active_cell_index()])
+      _has_melted[cell_id] = true;
     ++cell_id;
   }
 }
@@ -643,6 +912,51 @@ void ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
   CALI_CXX_MARK_FUNCTION;
 #endif
 
+  // Activate elements by updating the fe_index
+  auto activate_elements =
+      [&](std::map<typename dealii::DoFHandler<dim>::active_cell_iterator,
+                   int> &cell_to_id,
+          std::vector<std::vector<double>> &data_to_transfer)
+  {
+    unsigned int const n_dofs_per_cell =
+        _dof_handler.get_fe().n_dofs_per_cell();
+    unsigned int const direction_data_size = 2;
+    for (unsigned int i = activation_start; i < activation_end; ++i)
+    {
+      for (auto const &cell : elements_to_activate[i])
+      {
+        if (cell->active_fe_index() != 0)
+        {
+          cell->set_future_fe_index(0);
+          data_to_transfer[cell_to_id[cell]][n_dofs_per_cell] =
+              new_deposition_cos[i];
+          data_to_transfer[cell_to_id[cell]][n_dofs_per_cell + 1] =
+              new_deposition_sin[i];
+
+          if (data_to_transfer[cell_to_id[cell]]
+                              [n_dofs_per_cell + direction_data_size] > 0.5)
+            new_has_melted[i] = true;
+          else
+            new_has_melted[i] = false;
+        }
+      }
+    }
+  };
+
+  transfer_material(activate_elements, new_material_temperature, solution);
+}
+
+template <int dim, int fe_degree, typename MemorySpaceType,
+          typename QuadratureType>
+void ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
+    transfer_material(
+        std::function<void(
+            std::map<typename dealii::DoFHandler<dim>::active_cell_iterator,
+                     int> &,
+            std::vector<std::vector<double>> &)> const &set_future_fe_indices,
+        double const new_material_temperature,
+        dealii::LA::distributed::Vector<double, MemorySpaceType> &solution)
+{
   // Update the material state from the ThermalOperator to MaterialProperty
   // because, for now, we need to use state from MaterialProperty to perform the
   // transfer to the refined mesh.
@@ -732,27 +1046,7 @@ void ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
     ++active_cell_id;
   }
 
-  // Activate elements by updating the fe_index
-  for (unsigned int i = activation_start; i < activation_end; ++i)
-  {
-    for (auto const &cell : elements_to_activate[i])
-    {
-      if (cell->active_fe_index() != 0)
-      {
-        cell->set_future_fe_index(0);
-        data_to_transfer[cell_to_id[cell]][n_dofs_per_cell] =
-            new_deposition_cos[i];
-        data_to_transfer[cell_to_id[cell]][n_dofs_per_cell + 1] =
-            new_deposition_sin[i];
-
-        if (data_to_transfer[cell_to_id[cell]]
-                            [n_dofs_per_cell + direction_data_size] > 0.5)
-          new_has_melted[i] = true;
-        else
-          new_has_melted[i] = false;
-      }
-    }
-  }
+  set_future_fe_indices(cell_to_id, data_to_transfer);
 
   dealii::parallel::distributed::Triangulation<dim> &triangulation =
       dynamic_cast<dealii::parallel::distributed::Triangulation<dim> &>(
@@ -804,8 +1098,10 @@ void ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
   {
     if (cell->is_locally_owned())
     {
-      if (transferred_data[active_cell_id][0] !=
-          std::numeric_limits<double>::infinity())
+      // The cells that have been deactivated do not have dofs anymore.
+      if ((cell->active_fe_index() == 0) &&
+          (transferred_data[active_cell_id][0] !=
+           std::numeric_limits<double>::infinity()))
       {
         std::copy(transferred_data[active_cell_id].begin(),
                   transferred_data[active_cell_id].begin() + n_dofs_per_cell,
@@ -863,6 +1159,304 @@ void ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
   solution.import(rw_solution, dealii::VectorOperation::insert);
 }
 
+template <int dim, int fe_degree, typename MemorySpaceType,
+          typename QuadratureType>
+bool ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
+    condense_cooled_material(
+        double const t,
+        dealii::LA::distributed::Vector<double, MemorySpaceType> &solution,
+        std::vector<Timer> &timers)
+{
+  if (_condensation_depth < 0.)
+    return false;
+
+#ifdef ADAMANTINE_WITH_CALIPER
+  CALI_CXX_MARK_FUNCTION;
+#endif
+
+  dealii::LA::distributed::Vector<double, dealii::MemorySpace::Host>
+      solution_host(solution.get_partitioner());
+  solution_host.import(solution, dealii::VectorOperation::insert);
+  solution_host.update_ghost_values();
+  // The rate of change of the temperature is only computed if it is used.
+  bool const use_rate = std::isfinite(_condensation_rate_threshold);
+  dealii::LA::distributed::Vector<double, dealii::MemorySpace::Host> rate_host;
+  if (use_rate)
+  {
+    rate_host.reinit(solution.get_partitioner());
+    rate_host.import(evaluate_thermal_physics(t, solution, timers),
+                     dealii::VectorOperation::insert);
+    rate_host.update_ghost_values();
+  }
+
+  // The condensation height is lowered below the cells that are too hot or
+  // that cool down too fast.
+  double new_height = _current_source_height - _condensation_depth;
+  double domain_bottom = std::numeric_limits<double>::max();
+  std::vector<dealii::types::global_dof_index> dof_indices;
+  for (auto const &cell : dealii::filter_iterators(
+           _dof_handler.active_cell_iterators(),
+           dealii::IteratorFilters::LocallyOwnedCell()))
+  {
+    double const cell_bottom =
+        cell->bounding_box().get_boundary_points().first[axis<dim>::z];
+    domain_bottom = std::min(domain_bottom, cell_bottom);
+    if ((cell->active_fe_index() != 0) || (cell_bottom >= new_height))
+      continue;
+
+    dof_indices.resize(cell->get_fe().n_dofs_per_cell());
+    cell->get_dof_indices(dof_indices);
+    for (auto const index : dof_indices)
+    {
+      if ((solution_host(index) >= _condensation_temperature_threshold) ||
+          (use_rate &&
+           (std::abs(rate_host(index)) >= _condensation_rate_threshold)))
+      {
+        new_height = cell_bottom;
+        break;
+      }
+    }
+  }
+  MPI_Comm const communicator = _dof_handler.get_communicator();
+  new_height = dealii::Utilities::MPI::min(new_height, communicator);
+  domain_bottom = dealii::Utilities::MPI::min(domain_bottom, communicator);
+  if (new_height <= _condensation_height)
+    return false;
+
+  // Compute the volume and the average temperature of the cells that are
+  // entirely below the new condensation height.
+  auto is_condensed = [&](auto const &cell)
+  {
+    return (cell->active_fe_index() == 0) &&
+           (cell->bounding_box().get_boundary_points().second[axis<dim>::z] <=
+            new_height);
+  };
+  double volume = 0.;
+  double integrated_temperature = 0.;
+  for (auto const &cell : dealii::filter_iterators(
+           _dof_handler.active_cell_iterators(),
+           dealii::IteratorFilters::LocallyOwnedCell()))
+  {
+    if (!is_condensed(cell))
+      continue;
+
+    dof_indices.resize(cell->get_fe().n_dofs_per_cell());
+    cell->get_dof_indices(dof_indices);
+    double cell_temperature = 0.;
+    for (auto const index : dof_indices)
+      cell_temperature += solution_host(index);
+    cell_temperature /= dof_indices.size();
+    volume += cell->measure();
+    integrated_temperature += cell->measure() * cell_temperature;
+  }
+  volume = dealii::Utilities::MPI::sum(volume, communicator);
+  if (volume == 0.)
+    return false;
+  integrated_temperature =
+      dealii::Utilities::MPI::sum(integrated_temperature, communicator);
+
+  _condensed_temperature =
+      (_condensed_volume * _condensed_temperature + integrated_temperature) /
+      (_condensed_volume + volume);
+  _condensed_volume += volume;
+  _condensation_height = new_height;
+  double const heat_transfer_coef = 2. * _condensation_thermal_conductivity /
+                                    (_condensation_height - domain_bottom);
+  _thermal_operator->set_condensation(_condensation_height, heat_transfer_coef,
+                                      _condensed_temperature);
+
+  // Deactivate the condensed cells. Their data does not need to be modified.
+  auto deactivate_cells =
+      [&](std::map<typename dealii::DoFHandler<dim>::active_cell_iterator,
+                   int> &,
+          std::vector<std::vector<double>> &)
+  {
+    for (auto const &cell : dealii::filter_iterators(
+             _dof_handler.active_cell_iterators(),
+             dealii::IteratorFilters::LocallyOwnedCell()))
+      if (is_condensed(cell))
+        cell->set_future_fe_index(1);
+  };
+  transfer_material(deactivate_cells, _condensed_temperature, solution);
+
+  return true;
+}
+
+template <int dim, int fe_degree, typename MemorySpaceType,
+          typename QuadratureType>
+unsigned int ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
+    solve_quasi_steady_state(
+        double const t,
+        dealii::LA::distributed::Vector<double, MemorySpaceType> &solution,
+        std::vector<Timer> &timers)
+{
+#ifdef ADAMANTINE_WITH_CALIPER
+  CALI_CXX_MARK_FUNCTION;
+#endif
+
+  ASSERT_THROW(
+      (std::is_same<MemorySpaceType, dealii::MemorySpace::Host>::value),
+      "Error: The quasi-steady solver is not implemented on the device.");
+  ASSERT_THROW(_heat_sources.size() > 0,
+               "Error: The quasi-steady solver requires a heat source.");
+
+  unsigned int n_newton_iterations = 0;
+  if constexpr (std::is_same<MemorySpaceType, dealii::MemorySpace::Host>::value)
+  {
+    timers[evol_time].start();
+
+    // The frame moves with the heat sources. The heat sources do not move
+    // along the z axis during a layer.
+    dealii::Tensor<1, 3> const source_velocity =
+        _heat_sources[0]->get_scan_path().velocity(t);
+    for (auto const &source : _heat_sources)
+      ASSERT_THROW((source->get_scan_path().velocity(t) - source_velocity)
+                           .norm() <= 1e-12 * source_velocity.norm(),
+                   "Error: The heat sources must move together in the "
+                   "quasi-steady solver.");
+    dealii::Tensor<1, dim> velocity;
+    velocity[axis<dim>::x] = source_velocity[axis<dim>::x];
+    if constexpr (dim == 3)
+      velocity[axis<dim>::y] = source_velocity[axis<dim>::y];
+
+    // The temperature is fixed on the faces of the activated domain through
+    // which the material enters the frame, i.e., the faces in front of the
+    // heat sources, and on the constrained dofs. Since the cells are boxes,
+    // the direction of the outward normal is given by the center of the face.
+    LA_Vector fixed_dofs(solution.get_partitioner());
+    std::vector<dealii::types::global_dof_index> face_dof_indices(
+        _fe_collection[0].n_dofs_per_face());
+    for (auto const &cell : dealii::filter_iterators(
+             _dof_handler.active_cell_iterators(),
+             dealii::IteratorFilters::LocallyOwnedCell(),
+             dealii::IteratorFilters::ActiveFEIndexEqualTo(0)))
+    {
+      for (auto const f : cell->face_indices())
+      {
+        bool const domain_boundary =
+            cell->face(f)->at_boundary() ||
+            ((!cell->neighbor(f)->has_children()) &&
+             (cell->neighbor(f)->active_fe_index() != 0));
+        if (domain_boundary &&
+            ((cell->face(f)->center() - cell->center()) * velocity > 0.))
+        {
+          cell->face(f)->get_dof_indices(face_dof_indices, 0);
+          for (auto const dof : face_dof_indices)
+            fixed_dofs(dof) = 1.;
+        }
+      }
+    }
+    fixed_dofs.compress(dealii::VectorOperation::add);
+    dealii::IndexSet const locally_owned_dofs =
+        solution.locally_owned_elements();
+    for (unsigned int i = 0; i < solution.locally_owned_size(); ++i)
+      if (_affine_constraints.is_constrained(
+              locally_owned_dofs.nth_index_in_set(i)))
+        fixed_dofs.local_element(i) = 1.;
+
+    _thermal_operator->set_time_and_source_height(t, _current_source_height);
+    _thermal_operator->set_advection_velocity(velocity);
+
+    // The residual is the time derivative of the temperature in the moving
+    // frame.
+    auto compute_residual = [&](LA_Vector const &y, LA_Vector &residual)
+    {
+      _thermal_operator->vmult(residual, y);
+      residual.scale(*_thermal_operator->get_inverse_mass_matrix());
+      for (unsigned int i = 0; i < residual.locally_owned_size(); ++i)
+        if (fixed_dofs.local_element(i) > 0.)
+          residual.local_element(i) = 0.;
+      _counters.increment(operator_applications);
+    };
+
+    LA_Vector residual(solution.get_partitioner());
+    LA_Vector perturbed_solution(solution.get_partitioner());
+    compute_residual(solution, residual);
+    // The Jacobian is applied using a finite difference of the residual.
+    FunctionOperator<LA_Vector> const jacobian(
+        [&](LA_Vector &dst, LA_Vector const &src)
+        {
+          double const src_norm = src.l2_norm();
+          if (src_norm == 0.)
+          {
+            dst = 0.;
+            return;
+          }
+          double const epsilon = 1e-7 * (1. + solution.l2_norm()) / src_norm;
+          perturbed_solution = solution;
+          perturbed_solution.add(epsilon, src);
+          compute_residual(perturbed_solution, dst);
+          dst.add(-1., residual);
+          dst /= epsilon;
+          for (unsigned int i = 0; i < dst.locally_owned_size(); ++i)
+            if (fixed_dofs.local_element(i) > 0.)
+              dst.local_element(i) = src.local_element(i);
+        });
+
+    double const initial_residual_norm = residual.l2_norm();
+    double residual_norm = initial_residual_norm;
+    LA_Vector newton_step(solution.get_partitioner());
+    LA_Vector rhs(solution.get_partitioner());
+    LA_Vector new_solution(solution.get_partitioner());
+    LA_Vector new_residual(solution.get_partitioner());
+    while ((n_newton_iterations < _quasi_steady_newton_max_iter) &&
+           (residual_norm >
+            _quasi_steady_newton_tolerance * initial_residual_norm))
+    {
+      // Far from the solution, an inexact Newton step is sufficient.
+      rhs.equ(-1., residual);
+      newton_step = 0.;
+      dealii::SolverControl solver_control(_quasi_steady_max_iter,
+                                           1e-2 * residual_norm);
+      typename dealii::SolverGMRES<LA_Vector>::AdditionalData additional_data(
+          _quasi_steady_n_tmp_vectors);
+      dealii::SolverGMRES<LA_Vector> solver(solver_control, additional_data);
+      try
+      {
+        solver.solve(jacobian, newton_step, rhs,
+                     dealii::PreconditionIdentity());
+      }
+      catch (dealii::SolverControl::NoConvergence const &)
+      {
+        // Use the approximate step computed by GMRES.
+      }
+      _counters.increment(gmres_iterations, solver_control.last_step());
+      // GMRES only solves the fixed rows approximately.
+      for (unsigned int i = 0; i < newton_step.locally_owned_size(); ++i)
+        if (fixed_dofs.local_element(i) > 0.)
+          newton_step.local_element(i) = 0.;
+
+      // Backtracking line search
+      double alpha = 1.;
+      double new_residual_norm = residual_norm;
+      while (alpha > 1e-6)
+      {
+        new_solution = solution;
+        new_solution.add(alpha, newton_step);
+        compute_residual(new_solution, new_residual);
+        new_residual_norm = new_residual.l2_norm();
+        if (new_residual_norm < residual_norm)
+          break;
+        alpha /= 2.;
+      }
+      ++n_newton_iterations;
+      _counters.increment(newton_iterations);
+      // Stop if the line search fails to improve the solution.
+      if (new_residual_norm >= residual_norm)
+        break;
+      solution.swap(new_solution);
+      residual.swap(new_residual);
+      residual_norm = new_residual_norm;
+    }
+
+    _thermal_operator->set_advection_velocity(dealii::Tensor<1, dim>());
+
+    timers[evol_time].stop();
+  }
+
+  return n_newton_iterations;
+}
+
 template <int dim, int fe_degree, typename MemorySpaceType,
           typename QuadratureType>
 void ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
@@ -903,6 +1497,8 @@ double ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
   for (auto const &source : _heat_sources)
   {
     temp_height = std::max(temp_height, source->get_current_height(t));
+    // The sources that are averaged in time are averaged over the time step.
+    source->set_time_averaging_window(t, delta_t);
   }
   _current_source_height = temp_height;
 
@@ -911,8 +1507,11 @@ double ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
   auto id_m_Jinv = [&](double const t, double const tau, LA_Vector const &y)
   { return id_minus_tau_J_inverse(t, tau, y, timers); };
 
-  double time = _time_stepping->evolve_one_time_step(eval, id_m_Jinv, t,
-                                                     delta_t, solution);
+  double time =
+      (_n_sub_steps > 1)
+          ? evolve_one_two_scale_time_step(t, delta_t, solution, timers)
+          : _time_stepping->evolve_one_time_step(eval, id_m_Jinv, t, delta_t,
+                                                 solution);
 
   // If the method is embedded, get the next time step. Otherwise, just use the
   // current time step.
@@ -924,7 +1523,20 @@ double ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
         static_cast<
             dealii::TimeStepping::EmbeddedExplicitRungeKutta<LA_Vector> *>(
             _time_stepping.get());
-    _delta_t_guess = embedded_rk->get_status().delta_t_guess;
+    auto const &status = embedded_rk->get_status();
+    _delta_t_guess = status.delta_t_guess;
+    // Every iteration but the last one corresponds to a rejected step.
+    if (status.n_iterations > 0)
+      _counters.increment(rejected_steps, status.n_iterations - 1);
+  }
+
+  if (_implicit_method == true)
+  {
+    dealii::TimeStepping::ImplicitRungeKutta<LA_Vector> *implicit_rk =
+        static_cast<dealii::TimeStepping::ImplicitRungeKutta<LA_Vector> *>(
+            _time_stepping.get());
+    _counters.increment(newton_iterations,
+                        implicit_rk->get_status().n_iterations);
   }
 
   // Return the time at the end of the time step. This may be different than
@@ -932,6 +1544,190 @@ double ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
   return time;
 }
 
+template <int dim, int fe_degree, typename MemorySpaceType,
+          typename QuadratureType>
+double ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
+    evolve_one_two_scale_time_step(
+        double const t, double const delta_t,
+        dealii::LA::distributed::Vector<double, MemorySpaceType> &solution,
+        std::vector<Timer> &timers)
+{
+  auto eval = [&](double const t, LA_Vector const &y)
+  { return evaluate_thermal_physics(t, y, timers); };
+  auto id_m_Jinv = [&](double const t, double const tau, LA_Vector const &y)
+  { return id_minus_tau_J_inverse(t, tau, y, timers); };
+
+  // Flag the locally owned dofs that are only shared by cells in the window.
+  // The constrained dofs and the dofs of the cells outside of the window,
+  // including the dofs these cells see through the constraints, are advanced
+  // with the time step.
+  std::vector<bool> const window_cells = compute_window_cells(t, delta_t);
+  dealii::IndexSet const &locally_owned_dofs =
+      _dof_handler.locally_owned_dofs();
+  unsigned int const n_local_dofs = locally_owned_dofs.n_elements();
+  std::vector<bool> window_dofs(n_local_dofs, false);
+  std::vector<bool> outside_dofs(n_local_dofs, false);
+  auto flag_dof = [&](std::vector<bool> &flags,
+                      dealii::types::global_dof_index const dof)
+  {
+    if (locally_owned_dofs.is_element(dof))
+      flags[locally_owned_dofs.index_within_set(dof)] = true;
+  };
+  std::vector<dealii::types::global_dof_index> dof_indices;
+  for (auto const &cell : dealii::filter_iterators(
+           _dof_handler.active_cell_iterators(),
+           dealii::IteratorFilters::ActiveFEIndexEqualTo(0)))
+  {
+    if (cell->is_artificial())
+      continue;
+    dof_indices.resize(cell->get_fe().n_dofs_per_cell());
+    cell->get_dof_indices(dof_indices);
+    bool const in_window = window_cells[cell->active_cell_index()];
+    for (auto const dof : dof_indices)
+    {
+      if (_affine_constraints.is_constrained(dof))
+      {
+        flag_dof(outside_dofs, dof);
+        if (!in_window)
+          for (auto const &entry :
+               *_affine_constraints.get_constraint_entries(dof))
+            flag_dof(outside_dofs, entry.first);
+      }
+      else
+      {
+        flag_dof(in_window ? window_dofs : outside_dofs, dof);
+      }
+    }
+  }
+  unsigned int n_window_dofs = 0;
+  for (unsigned int i = 0; i < n_local_dofs; ++i)
+  {
+    window_dofs[i] = window_dofs[i] && !outside_dofs[i];
+    if (window_dofs[i])
+      ++n_window_dofs;
+  }
+
+  // If the beams are off, there is nothing to sub-step.
+  if (dealii::Utilities::MPI::sum(n_window_dofs,
+                                  _dof_handler.get_communicator()) == 0)
+    return _time_stepping->evolve_one_time_step(eval, id_m_Jinv, t, delta_t,
+                                                solution);
+
+  // Advance the dofs outside of the window, the dofs in the window being
+  // frozen.
+  LA_Vector const old_solution(solution);
+  auto outside_eval = [&](double const t, LA_Vector const &y)
+  {
+    LA_Vector value = evaluate_thermal_physics(t, y, timers);
+    for (unsigned int i = 0; i < n_local_dofs; ++i)
+      if (window_dofs[i])
+        value.local_element(i) = 0.;
+    return value;
+  };
+  _time_stepping->evolve_one_time_step(outside_eval, id_m_Jinv, t, delta_t,
+                                       solution);
+
+  // Advance the dofs in the window with the sub-steps. The dofs outside of
+  // the window follow a straight line to their new values so that the window
+  // sees a boundary condition consistent with the time step.
+  LA_Vector slope(solution);
+  slope.sadd(1. / delta_t, -1. / delta_t, old_solution);
+  auto window_eval = [&](double const t, LA_Vector const &y)
+  {
+    LA_Vector value = evaluate_thermal_physics(t, y, timers);
+    for (unsigned int i = 0; i < n_local_dofs; ++i)
+      if (!window_dofs[i])
+        value.local_element(i) = slope.local_element(i);
+    return value;
+  };
+  double const sub_step = delta_t / _n_sub_steps;
+  _thermal_operator->set_cell_mask(window_cells);
+  LA_Vector window_solution(old_solution);
+  double time = t;
+  for (unsigned int i = 0; i < _n_sub_steps; ++i)
+  {
+    for (auto const &source : _heat_sources)
+      source->set_time_averaging_window(time, sub_step);
+    time = _time_stepping->evolve_one_time_step(window_eval, id_m_Jinv, time,
+                                                sub_step, window_solution);
+  }
+  _thermal_operator->set_cell_mask({});
+  for (auto const &source : _heat_sources)
+    source->set_time_averaging_window(t, delta_t);
+
+  for (unsigned int i = 0; i < n_local_dofs; ++i)
+    if (window_dofs[i])
+      solution.local_element(i) = window_solution.local_element(i);
+
+  return t + delta_t;
+}
+
+template <int dim, int fe_degree, typename MemorySpaceType,
+          typename QuadratureType>
+std::vector<bool>
+ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
+    compute_window_cells(double const t, double const delta_t) const
+{
+  // Build one box per beam that encloses the positions of the beam at the
+  // beginning and at the end of every sub-step, enlarged by the margin. The
+  // box extends to the top of the domain. The beams that are off do not have
+  // a window.
+  std::vector<dealii::BoundingBox<dim>> windows;
+  for (auto const &source : _heat_sources)
+  {
+    ScanPath const &scan_path = source->get_scan_path();
+    dealii::Point<dim> lower;
+    dealii::Point<dim> upper;
+    bool beam_on = false;
+    for (unsigned int i = 0; i <= _n_sub_steps; ++i)
+    {
+      double const sample_time = t + i * delta_t / _n_sub_steps;
+      if (scan_path.get_power_modifier(sample_time) == 0.)
+        continue;
+      dealii::Point<3> const position = scan_path.value(sample_time);
+      dealii::Point<dim> point;
+      point[axis<dim>::x] = position[0];
+      if constexpr (dim == 3)
+        point[axis<dim>::y] = position[1];
+      point[axis<dim>::z] = position[2];
+      for (int d = 0; d < dim; ++d)
+      {
+        lower[d] = beam_on ? std::min(lower[d], point[d]) : point[d];
+        upper[d] = beam_on ? std::max(upper[d], point[d]) : point[d];
+      }
+      beam_on = true;
+    }
+    if (beam_on)
+    {
+      for (int d = 0; d < dim; ++d)
+      {
+        lower[d] -= _window_margin;
+        upper[d] += _window_margin;
+      }
+      upper[axis<dim>::z] = std::numeric_limits<double>::max();
+      windows.emplace_back(std::make_pair(lower, upper));
+    }
+  }
+
+  std::vector<bool> window_cells(
+      _dof_handler.get_triangulation().n_active_cells(), false);
+  for (auto const &cell : _dof_handler.active_cell_iterators())
+  {
+    if (cell->is_artificial())
+      continue;
+    dealii::BoundingBox<dim> const cell_box = cell->bounding_box();
+    for (auto const &window : windows)
+      if (window.get_neighbor_type(cell_box) !=
+          dealii::NeighborType::not_neighbors)
+      {
+        window_cells[cell->active_cell_index()] = true;
+        break;
+      }
+  }
+
+  return window_cells;
+}
+
 template <int dim, int fe_degree, typename MemorySpaceType,
           typename QuadratureType>
 void ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
@@ -982,17 +1778,19 @@ ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
 #ifdef ADAMANTINE_WITH_CALIPER
   CALI_CXX_MARK_FUNCTION;
 #endif
+  _counters.increment(rk_stages);
+  _counters.increment(operator_applications);
   if constexpr (std::is_same<MemorySpaceType, dealii::MemorySpace::Host>::value)
   {
     return evaluate_thermal_physics_impl<dim, fe_degree, MemorySpaceType>(
-        _thermal_operator, t, _current_source_height, y, timers);
+        _thermal_operator, t, _current_source_height, y, timers, _counters);
   }
   else
   {
     return evaluate_thermal_physics_impl<dim, fe_degree, MemorySpaceType>(
         _thermal_operator, _fe_collection, t, _dof_handler, _heat_sources,
         _current_source_height, _boundary_type, _material_properties,
-        _affine_constraints, y, timers);
+        _affine_constraints, y, timers, _counters);
   }
 
   // Dummy to silence warning
@@ -1025,6 +1823,10 @@ ThermalPhysics<dim, fe_degree, MemorySpaceType, QuadratureType>::
   dealii::SolverGMRES<dealii::LA::distributed::Vector<double, MemorySpaceType>>
       solver(solver_control, additional_data);
   solver.solve(*_implicit_operator, solution, y, preconditioner);
+  // GMRES applies the operator once per iteration plus once to compute the
+  // initial residual.
+  _counters.increment(gmres_iterations, solver_control.last_step());
+  _counters.increment(operator_applications, solver_control.last_step() + 1);
 
   timers[evol_time_J_inv].stop();
 
@@ -8,12 +8,16 @@
 #ifndef THERMAL_PHYSICS_INTERFACE_HH
 #define THERMAL_PHYSICS_INTERFACE_HH
 
+#include <CellDiagnostics.hh>
+#include <Counters.hh>
 #include <MaterialProperty.hh>
+#include <MemoryReport.hh>
 #include <types.hh>
 
 #include <deal.II/dofs/dof_handler.h>
 #include <deal.II/lac/affine_constraints.h>
 #include <deal.II/lac/la_parallel_vector.h>
+#include <deal.II/lac/vector.h>
 
 namespace adamantine
 {
@@ -61,6 +65,27 @@ public:
       unsigned int const activation_end, double const initial_temperature,
       dealii::LA::distributed::Vector<double, MemorySpaceType> &solution) = 0;
 
+  /**
+   * Deactivate the material that is deep below the heat sources and that has
+   * cooled down. The deactivated material is replaced by a boundary condition
+   * on the faces it shares with the activated domain. Return true if the mesh
+   * has changed.
+   */
+  virtual bool condense_cooled_material(
+      double const t,
+      dealii::LA::distributed::Vector<double, MemorySpaceType> &solution,
+      std::vector<Timer> &timers) = 0;
+
+  /**
+   * Replace @p solution by the steady state of the heat equation written in a
+   * frame moving with the heat sources at time @p t. Return the number of
+   * Newton iterations.
+   */
+  virtual unsigned int solve_quasi_steady_state(
+      double const t,
+      dealii::LA::distributed::Vector<double, MemorySpaceType> &solution,
+      std::vector<Timer> &timers) = 0;
+
   /**
    * Public interface for modifying the private state of the Physics object. One
    * use of this is to modify nominally constant parameters in the middle of a
@@ -145,6 +170,16 @@ public:
                   dealii::LA::distributed::Vector<double, MemorySpaceType>
                       &temperature) = 0;
 
+  /**
+   * Compute the per-cell diagnostics of @p temperature in a single pass over
+   * the activated cells. The cells whose average temperature is larger than
+   * the melting temperature of @p diagnostics are marked as melted. Only
+   * available on the host.
+   */
+  virtual void compute_cell_diagnostics(
+      dealii::LA::distributed::Vector<double, MemorySpaceType> &temperature,
+      CellDiagnostics<dim> &diagnostics) = 0;
+
   /**
    * Returns _has_melted
    */
@@ -179,6 +214,27 @@ public:
    * Return the degree of the finite element.
    */
   virtual unsigned int get_fe_degree() const = 0;
+
+  /**
+   * Return the solver and throughput counters.
+   */
+  virtual Counters &get_counters() = 0;
+
+  /**
+   * Add the memory used by the DoFHandler, the AffineConstraints, the
+   * MatrixFree object, and the data stored at the quadrature points to @p
+   * memory_report.
+   */
+  virtual void add_memory_consumption(MemoryReport &memory_report) const = 0;
+
+  /**
+   * Return the refinement indicator based on the jump of the normal gradient
+   * of @p solution across the faces. The faces where the temperature is less
+   * than @p min_temperature are skipped.
+   */
+  virtual dealii::Vector<float> compute_refinement_indicator(
+      dealii::LA::distributed::Vector<double, MemorySpaceType> const &solution,
+      double const min_temperature) const = 0;
 };
 } // namespace adamantine
 #endif
@@ -9,6 +9,7 @@
 #include <utils.hh>
 
 #include <deal.II/arborx/bvh.h>
+#include <deal.II/base/work_stream.h>
 #include <deal.II/dofs/dof_handler.h>
 #include <deal.II/fe/mapping_q1.h>
 #include <deal.II/grid/filtered_iterator.h>
@@ -34,34 +35,70 @@ get_dof_to_support_mapping(dealii::DoFHandler<dim> const &dof_handler)
   // that doesn't currently work with FE_Nothing
   const dealii::FiniteElement<dim> &fe = dof_handler.get_fe(0);
 
-  dealii::FEValues<dim, dim> fe_values(fe, fe.get_unit_support_points(),
-                                       dealii::update_quadrature_points);
-
-  std::vector<dealii::types::global_dof_index> local_dof_indices(
-      fe.n_dofs_per_cell());
+  dealii::Quadrature<dim> const support_quadrature(
+      fe.get_unit_support_points());
   auto locally_owned_dofs = dof_handler.locally_owned_dofs();
 
-  for (auto const &cell : dealii::filter_iterators(
-           dof_handler.active_cell_iterators(),
-           dealii::IteratorFilters::ActiveFEIndexEqualTo(0, true)))
+  // The support points of the cells are computed in parallel using threads.
+  // Every thread uses its own FEValues. The copier is called in the order of
+  // the cells, so the result does not depend on the number of threads.
+  struct ScratchData
+  {
+    ScratchData(dealii::FiniteElement<dim> const &fe,
+                dealii::Quadrature<dim> const &quadrature)
+        : fe_values(fe, quadrature, dealii::update_quadrature_points)
+    {
+    }
+
+    ScratchData(ScratchData const &other)
+        : ScratchData(other.fe_values.get_fe(),
+                      other.fe_values.get_quadrature())
+    {
+    }
+
+    dealii::FEValues<dim, dim> fe_values;
+  };
+
+  struct CopyData
+  {
+    std::vector<dealii::types::global_dof_index> local_dof_indices;
+    std::vector<dealii::Point<dim>> points;
+  };
+
+  auto worker = [&](typename dealii::DoFHandler<dim>::active_cell_iterator const
+                        &cell,
+                    ScratchData &scratch_data, CopyData &copy_data)
+  {
+    scratch_data.fe_values.reinit(cell);
+    copy_data.local_dof_indices.resize(fe.n_dofs_per_cell());
+    cell->get_dof_indices(copy_data.local_dof_indices);
+    copy_data.points = scratch_data.fe_values.get_quadrature_points();
+  };
+
+  auto copier = [&](CopyData const &copy_data)
   {
-    fe_values.reinit(cell);
-    cell->get_dof_indices(local_dof_indices);
-    const std::vector<dealii::Point<dim>> &points =
-        fe_values.get_quadrature_points();
     for (unsigned int i = 0; i < fe.n_dofs_per_cell(); ++i)
     {
+      dealii::types::global_dof_index const dof_index =
+          copy_data.local_dof_indices[i];
       // Skip duplicate points like vertices and indices that correspond to
       // ghosted elements
-      if ((visited_dof_indices.count(local_dof_indices[i]) == 0) &&
-          (locally_owned_dofs.is_element(local_dof_indices[i])))
+      if ((visited_dof_indices.count(dof_index) == 0) &&
+          (locally_owned_dofs.is_element(dof_index)))
       {
-        dof_indices.push_back(local_dof_indices[i]);
-        support_points.push_back(points[i]);
-        visited_dof_indices.insert(local_dof_indices[i]);
+        dof_indices.push_back(dof_index);
+        support_points.push_back(copy_data.points[i]);
+        visited_dof_indices.insert(dof_index);
       }
     }
-  }
+  };
+
+  auto const filtered_cells = dealii::filter_iterators(
+      dof_handler.active_cell_iterators(),
+      dealii::IteratorFilters::ActiveFEIndexEqualTo(0, true));
+  dealii::WorkStream::run(filtered_cells.begin(), filtered_cells.end(), worker,
+                          copier, ScratchData(fe, support_quadrature),
+                          CopyData());
 
   return {dof_indices, support_points};
 }
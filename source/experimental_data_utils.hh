@@ -19,6 +19,9 @@ namespace adamantine
 /**
  * Structure to encapsulate a point cloud and the values associated to each
  * point.
+ *
+ * TODO Every processor stores a copy of the frames. They could be shared by
+ * the processors of a node using SharedMemoryArray like the scan path segments.
  */
 template <int dim>
 struct PointsValues
@@ -5,6 +5,7 @@
  * for the text and further information on this license.
  */
 
+#include <CartesianIndex.hh>
 #include <material_deposition.hh>
 #include <utils.hh>
 
@@ -12,9 +13,13 @@
 #include <deal.II/grid/filtered_iterator.h>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/serialization/vector.hpp>
 
 #include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <limits>
+#include <map>
 #include <tuple>
 
 namespace adamantine
@@ -36,9 +41,12 @@ create_material_deposition_boxes(
   std::string method =
       geometry_database.get<std::string>("material_deposition_method");
 
+  std::tuple<std::vector<dealii::BoundingBox<dim>>, std::vector<double>,
+             std::vector<double>, std::vector<double>>
+      deposition;
   if (method == "file")
   {
-    return read_material_deposition<dim>(geometry_database);
+    deposition = read_material_deposition<dim>(geometry_database);
   }
   else
   {
@@ -52,8 +60,47 @@ create_material_deposition_boxes(
           geometry_database, source->get_scan_path()));
     }
 
-    return merge_deposition_paths<dim>(deposition_paths);
+    deposition = merge_deposition_paths<dim>(deposition_paths);
   }
+
+  // PropertyTreeInput geometry.lumped_layers
+  // PropertyTreeInput geometry.lumped_height
+  if ((geometry_database.count("lumped_layers") != 0) ||
+      (geometry_database.count("lumped_height") != 0))
+    return lump_material_deposition<dim>(geometry_database, deposition);
+
+  return deposition;
+}
+
+template <int dim>
+std::tuple<SharedMemoryArray<dealii::BoundingBox<dim>>, std::vector<double>,
+           std::vector<double>, std::vector<double>>
+create_material_deposition_boxes(
+    MPI_Comm const &communicator,
+    boost::property_tree::ptree const &geometry_database,
+    std::vector<std::shared_ptr<HeatSource<dim>>> &heat_sources)
+{
+  // The deposition times and angles are needed by every processor. They are
+  // created with the boxes and broadcast from the first processor, which is
+  // also the first processor of its node.
+  std::vector<std::vector<double>> deposition_data(3);
+  SharedMemoryArray<dealii::BoundingBox<dim>> material_deposition_boxes(
+      communicator,
+      [&]()
+      {
+        auto [boxes, deposition_times, deposition_cos, deposition_sin] =
+            create_material_deposition_boxes<dim>(geometry_database,
+                                                  heat_sources);
+        deposition_data = {std::move(deposition_times),
+                           std::move(deposition_cos),
+                           std::move(deposition_sin)};
+        return boxes;
+      });
+  deposition_data =
+      dealii::Utilities::MPI::broadcast(communicator, deposition_data, 0);
+
+  return std::make_tuple(material_deposition_boxes, deposition_data[0],
+                         deposition_data[1], deposition_data[2]);
 }
 
 template <int dim>
@@ -157,10 +204,11 @@ deposition_along_scan_path(boost::property_tree::ptree const &geometry_database,
   double lead_time = geometry_database.get<double>("deposition_lead_time");
 
   // Loop through the scan path segements, adding boxes inside each one
-  std::vector<ScanPathSegment> segment_list = scan_path.get_segment_list();
+  auto const &segment_list = scan_path.get_segment_list();
+  ASSERT_THROW(!segment_list.empty(), "Error: The scan path is empty.");
   double segment_start_time = 0.0;
-  dealii::Point<3> segment_start_point = segment_list.at(0).end_point;
-  for (ScanPathSegment segment : segment_list)
+  dealii::Point<3> segment_start_point = segment_list.front().end_point;
+  for (ScanPathSegment const &segment : segment_list)
   {
     // Only add material if the power is on
     double const eps = 1.0e-12;
@@ -304,17 +352,120 @@ merge_deposition_paths(
                          permutated_cos, permutated_sin);
 }
 
+template <int dim>
+std::tuple<std::vector<dealii::BoundingBox<dim>>, std::vector<double>,
+           std::vector<double>, std::vector<double>>
+lump_material_deposition(
+    boost::property_tree::ptree const &geometry_database,
+    std::tuple<std::vector<dealii::BoundingBox<dim>>, std::vector<double>,
+               std::vector<double>, std::vector<double>> const &deposition)
+{
+  auto [bounding_boxes, time, cos, sin] = deposition;
+  unsigned int const n_boxes = bounding_boxes.size();
+  if (n_boxes == 0)
+    return deposition;
+
+  // PropertyTreeInput geometry.lumped_layers
+  unsigned int const lumped_layers =
+      geometry_database.get("lumped_layers", 1u);
+  // PropertyTreeInput geometry.lumped_height
+  double const lumped_height = geometry_database.get("lumped_height", 0.);
+  ASSERT_THROW(lumped_layers > 0,
+               "Error: The number of lumped layers must be positive.");
+  ASSERT_THROW(lumped_height >= 0.,
+               "Error: The lumped height must be non-negative.");
+
+  // Find the bottom of the layers. Boxes whose bottoms are closer than a
+  // fraction of the thinnest box belong to the same layer.
+  std::vector<double> box_bottoms(n_boxes);
+  double min_box_height = std::numeric_limits<double>::max();
+  for (unsigned int i = 0; i < n_boxes; ++i)
+  {
+    box_bottoms[i] = bounding_boxes[i].lower_bound(axis<dim>::z);
+    min_box_height =
+        std::min(min_box_height, bounding_boxes[i].side_length(axis<dim>::z));
+  }
+  double const tolerance = 1e-3 * min_box_height;
+  std::vector<double> layer_bottoms = box_bottoms;
+  std::sort(layer_bottoms.begin(), layer_bottoms.end());
+  layer_bottoms.erase(std::unique(layer_bottoms.begin(), layer_bottoms.end(),
+                                  [&](double a, double b)
+                                  { return b - a <= tolerance; }),
+                      layer_bottoms.end());
+
+  // Compute the lumped layer of every box. If the lumped height is given, it
+  // takes precedence over the number of lumped layers.
+  std::vector<unsigned int> lumped_layer(n_boxes);
+  for (unsigned int i = 0; i < n_boxes; ++i)
+  {
+    if (lumped_height > 0.)
+    {
+      lumped_layer[i] = static_cast<unsigned int>(std::floor(
+          (box_bottoms[i] - layer_bottoms.front() + tolerance) /
+          lumped_height));
+    }
+    else
+    {
+      unsigned int const layer =
+          std::lower_bound(layer_bottoms.begin(), layer_bottoms.end(),
+                           box_bottoms[i] - tolerance) -
+          layer_bottoms.begin();
+      lumped_layer[i] = layer / lumped_layers;
+    }
+  }
+
+  // All the boxes of a lumped layer are deposited when the first box of the
+  // lumped layer is deposited.
+  std::map<unsigned int, double> lumped_layer_time;
+  for (unsigned int i = 0; i < n_boxes; ++i)
+  {
+    auto [it, inserted] = lumped_layer_time.emplace(lumped_layer[i], time[i]);
+    if (!inserted)
+      it->second = std::min(it->second, time[i]);
+  }
+  for (unsigned int i = 0; i < n_boxes; ++i)
+    time[i] = lumped_layer_time[lumped_layer[i]];
+
+  return merge_deposition_paths<dim>(
+      {std::make_tuple(bounding_boxes, time, cos, sin)});
+}
+
 template <int dim>
 std::vector<std::vector<typename dealii::DoFHandler<dim>::active_cell_iterator>>
 get_elements_to_activate(
     dealii::DoFHandler<dim> const &dof_handler,
-    std::vector<dealii::BoundingBox<dim>> const &material_deposition_boxes)
+    dealii::ArrayView<dealii::BoundingBox<dim> const> const
+        &material_deposition_boxes)
 {
   // Exit early if we can
   if (material_deposition_boxes.size() == 0)
     return std::vector<
         std::vector<typename dealii::DoFHandler<dim>::active_cell_iterator>>();
 
+  unsigned int const n_queries = material_deposition_boxes.size();
+  std::vector<
+      std::vector<typename dealii::DoFHandler<dim>::active_cell_iterator>>
+      elements_to_activate(n_queries);
+
+  // If the coarse cells form a Cartesian lattice, the cells are found by
+  // descending the refinement trees of the coarse cells intersecting the box.
+  // This avoids building a bounding volume hierarchy every time.
+  CartesianIndex<dim> cartesian_index(dof_handler);
+  if (cartesian_index.is_cartesian())
+  {
+    for (unsigned int i = 0; i < n_queries; ++i)
+    {
+      for (auto const &cell :
+           cartesian_index.intersect(material_deposition_boxes[i]))
+      {
+        if (cell->is_locally_owned() && (cell->active_fe_index() == 1))
+          elements_to_activate[i].push_back(cell);
+      }
+    }
+
+    return elements_to_activate;
+  }
+
   // We activate the cells that intersect a box. To do that we use ArborX.
   // First, we create the bounding boxes of all the non-activated cells.
   std::vector<dealii::BoundingBox<dim>> bounding_boxes;
@@ -329,16 +480,14 @@ get_elements_to_activate(
     cell_iterators.push_back(cell);
   }
 
-  // Perform the search
+  // Perform the search. ArborX requires the boxes to be stored in a
+  // std::vector.
   dealii::ArborXWrappers::BVH bvh(bounding_boxes);
   dealii::ArborXWrappers::BoundingBoxIntersectPredicate bb_intersect(
-      material_deposition_boxes);
+      std::vector<dealii::BoundingBox<dim>>(material_deposition_boxes.begin(),
+                                            material_deposition_boxes.end()));
   auto [indices, offset] = bvh.query(bb_intersect);
 
-  unsigned int const n_queries = material_deposition_boxes.size();
-  std::vector<
-      std::vector<typename dealii::DoFHandler<dim>::active_cell_iterator>>
-      elements_to_activate(n_queries);
   for (unsigned int i = 0; i < n_queries; ++i)
   {
     for (int j = offset[i]; j < offset[i + 1]; ++j)
@@ -349,6 +498,54 @@ get_elements_to_activate(
 
   return elements_to_activate;
 }
+
+template <int dim>
+void check_symmetry_plane(
+    boost::property_tree::ptree const &geometry_database,
+    std::vector<std::shared_ptr<HeatSource<dim>>> const &heat_sources,
+    dealii::ArrayView<dealii::BoundingBox<dim> const> const
+        &material_deposition_boxes)
+{
+  // PropertyTreeInput geometry.symmetry
+  if ((dim != 3) || !geometry_database.get("symmetry", false))
+    return;
+
+  // PropertyTreeInput geometry.width
+  double const width = geometry_database.get<double>("width");
+  double const plane = 0.5 * width;
+  double const tolerance = 1e-6 * width;
+
+  // The beams must move on the symmetry plane when they are on. The sources
+  // are densities so the half domain receives half of the power of a beam
+  // centered on the plane and the power does not need to be rescaled.
+  for (auto const &source : heat_sources)
+  {
+    auto const &segment_list = source->get_scan_path().get_segment_list();
+    for (unsigned int i = 0; i < segment_list.size(); ++i)
+    {
+      if (segment_list[i].power_modifier == 0.)
+        continue;
+      bool on_plane =
+          std::abs(segment_list[i].end_point[1] - plane) < tolerance;
+      if (i > 0)
+        on_plane = on_plane &&
+                   (std::abs(segment_list[i - 1].end_point[1] - plane) <
+                    tolerance);
+      ASSERT_THROW(on_plane, "Error: The scan path is not on the symmetry "
+                             "plane y = " +
+                                 std::to_string(plane) + ".");
+    }
+  }
+
+  // The material must be deposited symmetrically with respect to the plane.
+  for (auto const &box : material_deposition_boxes)
+  {
+    ASSERT_THROW(std::abs(box.center()[axis<dim>::y] - plane) < tolerance,
+                 "Error: The material deposition is not symmetric with "
+                 "respect to the plane y = " +
+                     std::to_string(plane) + ".");
+  }
+}
 } // namespace adamantine
 
 //-------------------- Explicit Instantiations --------------------//
@@ -364,6 +561,20 @@ template std::tuple<std::vector<dealii::BoundingBox<3>>, std::vector<double>,
 create_material_deposition_boxes(
     boost::property_tree::ptree const &geometry_database,
     std::vector<std::shared_ptr<HeatSource<3>>> &heat_sources);
+template std::tuple<SharedMemoryArray<dealii::BoundingBox<2>>,
+                    std::vector<double>, std::vector<double>,
+                    std::vector<double>>
+create_material_deposition_boxes(
+    MPI_Comm const &communicator,
+    boost::property_tree::ptree const &geometry_database,
+    std::vector<std::shared_ptr<HeatSource<2>>> &heat_sources);
+template std::tuple<SharedMemoryArray<dealii::BoundingBox<3>>,
+                    std::vector<double>, std::vector<double>,
+                    std::vector<double>>
+create_material_deposition_boxes(
+    MPI_Comm const &communicator,
+    boost::property_tree::ptree const &geometry_database,
+    std::vector<std::shared_ptr<HeatSource<3>>> &heat_sources);
 
 template std::tuple<std::vector<dealii::BoundingBox<2>>, std::vector<double>,
                     std::vector<double>, std::vector<double>>
@@ -372,14 +583,40 @@ template std::tuple<std::vector<dealii::BoundingBox<3>>, std::vector<double>,
                     std::vector<double>, std::vector<double>>
 read_material_deposition(boost::property_tree::ptree const &geometry_database);
 
+template std::tuple<std::vector<dealii::BoundingBox<2>>, std::vector<double>,
+                    std::vector<double>, std::vector<double>>
+lump_material_deposition(
+    boost::property_tree::ptree const &geometry_database,
+    std::tuple<std::vector<dealii::BoundingBox<2>>, std::vector<double>,
+               std::vector<double>, std::vector<double>> const &deposition);
+template std::tuple<std::vector<dealii::BoundingBox<3>>, std::vector<double>,
+                    std::vector<double>, std::vector<double>>
+lump_material_deposition(
+    boost::property_tree::ptree const &geometry_database,
+    std::tuple<std::vector<dealii::BoundingBox<3>>, std::vector<double>,
+               std::vector<double>, std::vector<double>> const &deposition);
+
 template std::vector<
     std::vector<typename dealii::DoFHandler<2>::active_cell_iterator>>
 get_elements_to_activate(
     dealii::DoFHandler<2> const &dof_handler,
-    std::vector<dealii::BoundingBox<2>> const &material_deposition_boxes);
+    dealii::ArrayView<dealii::BoundingBox<2> const> const
+        &material_deposition_boxes);
 template std::vector<
     std::vector<typename dealii::DoFHandler<3>::active_cell_iterator>>
 get_elements_to_activate(
     dealii::DoFHandler<3> const &dof_handler,
-    std::vector<dealii::BoundingBox<3>> const &material_deposition_boxes);
+    dealii::ArrayView<dealii::BoundingBox<3> const> const
+        &material_deposition_boxes);
+
+template void check_symmetry_plane(
+    boost::property_tree::ptree const &geometry_database,
+    std::vector<std::shared_ptr<HeatSource<2>>> const &heat_sources,
+    dealii::ArrayView<dealii::BoundingBox<2> const> const
+        &material_deposition_boxes);
+template void check_symmetry_plane(
+    boost::property_tree::ptree const &geometry_database,
+    std::vector<std::shared_ptr<HeatSource<3>>> const &heat_sources,
+    dealii::ArrayView<dealii::BoundingBox<3> const> const
+        &material_deposition_boxes);
 } // namespace adamantine
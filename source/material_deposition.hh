@@ -1,4 +1,4 @@
-/* Copyright (c) 2021, the adamantine authors.
+/* Copyright (c) 2021 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -9,7 +9,9 @@
 #define MATERIAL_DEPOSITION_HH
 
 #include <HeatSource.hh>
+#include <SharedMemoryArray.hh>
 
+#include <deal.II/base/array_view.h>
 #include <deal.II/base/bounding_box.h>
 #include <deal.II/dofs/dof_handler.h>
 
@@ -27,6 +29,20 @@ std::tuple<std::vector<dealii::BoundingBox<dim>>, std::vector<double>,
 create_material_deposition_boxes(
     boost::property_tree::ptree const &geometry_database,
     std::vector<std::shared_ptr<HeatSource<dim>>> &heat_sources);
+/**
+ * Same as above but the bounding boxes are shared by the processors of a node.
+ * They are only created by the first processor of every node of @p
+ * communicator and the deposition times and angles are broadcast to the other
+ * processors. This function is collective. The destruction of the last copy
+ * of the boxes is also collective, see SharedMemoryArray.
+ */
+template <int dim>
+std::tuple<SharedMemoryArray<dealii::BoundingBox<dim>>, std::vector<double>,
+           std::vector<double>, std::vector<double>>
+create_material_deposition_boxes(
+    MPI_Comm const &communicator,
+    boost::property_tree::ptree const &geometry_database,
+    std::vector<std::shared_ptr<HeatSource<dim>>> &heat_sources);
 /**
  * Read the material deposition file and return the bounding boxes, the
  * deposition times, the cosine of the deposition angles, and the sine of the
@@ -57,6 +73,21 @@ merge_deposition_paths(
     std::vector<std::tuple<std::vector<dealii::BoundingBox<dim>>,
                            std::vector<double>, std::vector<double>,
                            std::vector<double>>> const &bounding_box_lists);
+/**
+ * Merge the deposition of several consecutive layers into a single deposition
+ * event. The layers are identified by the bottom of the boxes. All the boxes
+ * of a lumped layer are deposited at the earliest deposition time of the
+ * lumped layer. The bounding boxes, the deposition times, the cosine of the
+ * deposition angles, and the sine of the deposition angles are returned
+ * sorted by deposition time.
+ */
+template <int dim>
+std::tuple<std::vector<dealii::BoundingBox<dim>>, std::vector<double>,
+           std::vector<double>, std::vector<double>>
+lump_material_deposition(
+    boost::property_tree::ptree const &geometry_database,
+    std::tuple<std::vector<dealii::BoundingBox<dim>>, std::vector<double>,
+               std::vector<double>, std::vector<double>> const &deposition);
 /**
  * Return a vector of cells to activate for each time deposition.
  */
@@ -64,7 +95,73 @@ template <int dim>
 std::vector<std::vector<typename dealii::DoFHandler<dim>::active_cell_iterator>>
 get_elements_to_activate(
     dealii::DoFHandler<dim> const &dof_handler,
-    std::vector<dealii::BoundingBox<dim>> const &material_deposition_boxes);
+    dealii::ArrayView<dealii::BoundingBox<dim> const> const
+        &material_deposition_boxes);
+/**
+ * Same as above for boxes stored in a std::vector.
+ */
+template <int dim>
+std::vector<std::vector<typename dealii::DoFHandler<dim>::active_cell_iterator>>
+get_elements_to_activate(
+    dealii::DoFHandler<dim> const &dof_handler,
+    std::vector<dealii::BoundingBox<dim>> const &material_deposition_boxes)
+{
+  return get_elements_to_activate(
+      dof_handler, dealii::make_array_view(material_deposition_boxes));
+}
+/**
+ * Same as above for boxes shared by the processors of a node.
+ */
+template <int dim>
+std::vector<std::vector<typename dealii::DoFHandler<dim>::active_cell_iterator>>
+get_elements_to_activate(
+    dealii::DoFHandler<dim> const &dof_handler,
+    SharedMemoryArray<dealii::BoundingBox<dim>> const
+        &material_deposition_boxes)
+{
+  return get_elements_to_activate(
+      dof_handler, dealii::ArrayView<dealii::BoundingBox<dim> const>(
+                       material_deposition_boxes.data(),
+                       material_deposition_boxes.size()));
+}
+/**
+ * If the geometry uses a symmetry plane, check that the scan paths of @p
+ * heat_sources and the @p material_deposition_boxes are symmetric with respect
+ * to the plane y = width / 2. Otherwise, do nothing.
+ */
+template <int dim>
+void check_symmetry_plane(
+    boost::property_tree::ptree const &geometry_database,
+    std::vector<std::shared_ptr<HeatSource<dim>>> const &heat_sources,
+    dealii::ArrayView<dealii::BoundingBox<dim> const> const
+        &material_deposition_boxes);
+/**
+ * Same as above for boxes stored in a std::vector.
+ */
+template <int dim>
+void check_symmetry_plane(
+    boost::property_tree::ptree const &geometry_database,
+    std::vector<std::shared_ptr<HeatSource<dim>>> const &heat_sources,
+    std::vector<dealii::BoundingBox<dim>> const &material_deposition_boxes)
+{
+  check_symmetry_plane(geometry_database, heat_sources,
+                       dealii::make_array_view(material_deposition_boxes));
+}
+/**
+ * Same as above for boxes shared by the processors of a node.
+ */
+template <int dim>
+void check_symmetry_plane(
+    boost::property_tree::ptree const &geometry_database,
+    std::vector<std::shared_ptr<HeatSource<dim>>> const &heat_sources,
+    SharedMemoryArray<dealii::BoundingBox<dim>> const
+        &material_deposition_boxes)
+{
+  check_symmetry_plane(geometry_database, heat_sources,
+                       dealii::ArrayView<dealii::BoundingBox<dim> const>(
+                           material_deposition_boxes.data(),
+                           material_deposition_boxes.size()));
+}
 } // namespace adamantine
 
 #endif
@@ -153,6 +153,22 @@ enum Timing
   n_timers
 };
 
+/**
+ * Enum on the possible counters.
+ */
+enum Counting
+{
+  operator_applications,
+  rk_stages,
+  newton_iterations,
+  gmres_iterations,
+  cg_iterations,
+  rejected_steps,
+  n_active_dofs,
+  n_active_cells,
+  n_counters
+};
+
 /**
  * Structure that stores constants.
  */
@@ -200,8 +216,17 @@ enum BoundaryType
   adiabatic = 0x1,
   radiative = 0x2,
   convective = 0x4,
+  far_field = 0x8,
+  symmetry = 0x10,
 };
 
+/**
+ * Boundary id of the faces on the symmetry plane of a half domain. These faces
+ * are adiabatic whatever the type of boundary condition. The boundary ids 0 to
+ * 5 are used by the faces of the generated box.
+ */
+static unsigned int constexpr g_symmetry_boundary_id = 6;
+
 /**
  * Global operator which returns an object in which all bits are set which are
  * either set in the first or the second argument. This operator exists since if
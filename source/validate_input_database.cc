@@ -1,4 +1,4 @@
-/* Copyright (c) 2021, the adamantine authors.
+/* Copyright (c) 2021 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -57,6 +57,10 @@ void validate_input_database(boost::property_tree::ptree &database)
       {
         boundary_type |= BoundaryType::convective;
       }
+      else if (boundary == "far_field")
+      {
+        boundary_type |= BoundaryType::far_field;
+      }
       else
       {
         ASSERT_THROW(false, "Error: Unknown boundary type.");
@@ -71,6 +75,13 @@ void validate_input_database(boost::property_tree::ptree &database)
   }
   parse_boundary_type(boundary_type_str);
 
+  if (boundary_type & BoundaryType::far_field)
+  {
+    ASSERT_THROW(database.get("boundary.far_field_time_offset", 1e-3) > 0.,
+                 "Error: The time offset of the far-field boundary condition "
+                 "must be positive.");
+  }
+
   // Tree: discretization.thermal
   if (use_thermal_physics)
   {
@@ -187,6 +198,15 @@ void validate_input_database(boost::property_tree::ptree &database)
     }
   }
 
+  if (database.get("geometry.symmetry", false))
+  {
+    ASSERT_THROW((dim == 3) && !import_mesh,
+                 "Error: The symmetry plane requires a generated mesh in 3D.");
+    ASSERT_THROW(!use_mechanical_physics,
+                 "Error: The symmetry plane is not implemented for the "
+                 "mechanical simulation.");
+  }
+
   // Tree: materials
   unsigned int n_materials =
       database.get<unsigned int>("materials.n_materials");
@@ -330,6 +350,68 @@ void validate_input_database(boost::property_tree::ptree &database)
                  "Error: The refinement beam cutoff must be non-negative.");
   }
 
+  std::string const error_estimator =
+      database.get<std::string>("refinement.error_estimator", "kelly");
+  ASSERT_THROW(error_estimator == "kelly" || error_estimator == "gradient_jump",
+               "Error: Error estimator, '" + error_estimator +
+                   "', is not recognized. Valid options are: 'kelly' and "
+                   "'gradient_jump'.");
+
+  boost::optional<double> beam_travel_distance_optional =
+      database.get_optional<double>("refinement.beam_travel_distance");
+  if (beam_travel_distance_optional)
+  {
+    double const beam_travel_distance = beam_travel_distance_optional.get();
+    ASSERT_THROW(
+        beam_travel_distance > 0.0,
+        "Error: The refinement beam travel distance must be positive.");
+    ASSERT_THROW(database.get("refinement.lookahead_distance",
+                              2. * beam_travel_distance) >=
+                     beam_travel_distance,
+                 "Error: The refinement lookahead distance must be greater or "
+                 "equal than the beam travel distance.");
+  }
+
+  boost::optional<boost::property_tree::ptree const &>
+      progressive_coarsening_optional =
+          database.get_child_optional("refinement.progressive_coarsening");
+  if (progressive_coarsening_optional)
+  {
+    ASSERT_THROW(progressive_coarsening_optional.get().count("temperature") !=
+                     0,
+                 "Error: The temperature below which the cells are coarsened "
+                 "must be specified.");
+    ASSERT_THROW(
+        progressive_coarsening_optional.get().get("layer_thickness", 0.) > 0.,
+        "Error: The layer thickness used by the progressive coarsening must "
+        "be positive.");
+  }
+
+  boost::optional<boost::property_tree::ptree const &> condensation_optional =
+      database.get_child_optional("refinement.condensation");
+  if (condensation_optional)
+  {
+    ASSERT_THROW(condensation_optional.get().get("depth", -1.) >= 0.,
+                 "Error: The depth below which the material is condensed must "
+                 "be non-negative.");
+    ASSERT_THROW(condensation_optional.get().count("temperature") != 0,
+                 "Error: The temperature below which the material is "
+                 "condensed must be specified.");
+    ASSERT_THROW(
+        condensation_optional.get().get("thermal_conductivity", 0.) > 0.,
+        "Error: The thermal conductivity of the condensed material must be "
+        "positive.");
+    ASSERT_THROW(database.get("ensemble.ensemble_simulation", false) == false,
+                 "Error: The condensation of the material cannot be used with "
+                 "ensemble simulations.");
+    // The mechanical problem is activated using the thermal fe indices. The
+    // condensed cells, which hold the mechanical Dirichlet condition, would
+    // be removed from the mechanical problem.
+    ASSERT_THROW(!use_mechanical_physics,
+                 "Error: The condensation of the material cannot be used with "
+                 "the mechanical physics.");
+  }
+
   // Tree: sources
   unsigned int n_beams = database.get<unsigned int>("sources.n_beams");
   for (unsigned int beam_index = 0; beam_index < n_beams; ++beam_index)
@@ -338,10 +420,11 @@ void validate_input_database(boost::property_tree::ptree &database)
         "sources.beam_" + std::to_string(beam_index) + ".type");
     ASSERT_THROW(boost::iequals(beam_type, "goldak") ||
                      boost::iequals(beam_type, "electron_beam") ||
-                     boost::iequals(beam_type, "cube"),
+                     boost::iequals(beam_type, "cube") ||
+                     boost::iequals(beam_type, "layer"),
                  "Error: Beam type, '" + beam_type +
                      "', is not recognized. Valid options are: 'goldak', "
-                     "'electron_beam', and 'cube'.");
+                     "'electron_beam', 'cube', and 'layer'.");
     ASSERT_THROW(database.get_child("sources")
                          .get_child("beam_" + std::to_string(beam_index))
                          .count("scan_path_file") != 0,
@@ -366,6 +449,12 @@ void validate_input_database(boost::property_tree::ptree &database)
     ASSERT_THROW(
         absorption_efficiency >= 0.0 && absorption_efficiency <= 1.0,
         "Error: Heat source absorption efficiency must be between 0 and 1.");
+
+    ASSERT_THROW(database.get("sources.beam_" + std::to_string(beam_index) +
+                                  ".time_averaging_samples",
+                              1) >= 1,
+                 "Error: The number of time averaging samples of a heat source "
+                 "must be positive.");
   }
 
   // Tree: time_stepping
@@ -397,6 +486,66 @@ void validate_input_database(boost::property_tree::ptree &database)
   ASSERT_THROW(database.get<double>("time_stepping.time_step") >= 0.0,
                "Error: Time step must be non-negative.");
 
+  boost::optional<boost::property_tree::ptree &> two_scale_optional_database =
+      database.get_child_optional("time_stepping.two_scale");
+  if (two_scale_optional_database)
+  {
+    int const n_sub_steps =
+        database.get("time_stepping.two_scale.n_sub_steps", 1);
+    ASSERT_THROW(n_sub_steps >= 1,
+                 "Error: The number of sub-steps of the two-scale time "
+                 "stepping must be positive.");
+    if (n_sub_steps > 1)
+    {
+      ASSERT_THROW(boost::iequals(time_stepping_method, "forward_euler") ||
+                       boost::iequals(time_stepping_method, "rk_third_order") ||
+                       boost::iequals(time_stepping_method, "rk_fourth_order"),
+                   "Error: The two-scale time stepping requires the "
+                   "'forward_euler', 'rk_third_order', or 'rk_fourth_order' "
+                   "method.");
+      boost::optional<double> window_margin_optional =
+          database.get_optional<double>(
+              "time_stepping.two_scale.window_margin");
+      ASSERT_THROW(window_margin_optional &&
+                       (window_margin_optional.get() > 0.),
+                   "Error: The two-scale time stepping requires a positive "
+                   "window margin.");
+    }
+  }
+
+  if (database.get_child_optional("time_stepping.quasi_steady"))
+  {
+    boost::optional<double> time_optional =
+        database.get_optional<double>("time_stepping.quasi_steady.time");
+    ASSERT_THROW(time_optional && (time_optional.get() >= 0.),
+                 "Error: The quasi-steady solver requires a non-negative "
+                 "time.");
+    ASSERT_THROW(use_thermal_physics,
+                 "Error: The quasi-steady solver requires the thermal "
+                 "simulation.");
+    ASSERT_THROW(database.get("ensemble.ensemble_simulation", false) == false,
+                 "Error: The quasi-steady solver is not compatible with "
+                 "ensemble simulations.");
+  }
+
+  boost::optional<boost::property_tree::ptree const &> cooldown_optional =
+      database.get_child_optional("time_stepping.cooldown");
+  if (cooldown_optional)
+  {
+    ASSERT_THROW(cooldown_optional.get().count("temperature") != 0,
+                 "Error: The temperature below which the part is considered "
+                 "cooled down must be specified.");
+    ASSERT_THROW(cooldown_optional.get().get("temperature_rate", 1.) > 0.,
+                 "Error: The rate of change of the temperature below which the "
+                 "part is considered cooled down must be positive.");
+    ASSERT_THROW(use_thermal_physics,
+                 "Error: The cooldown termination requires the thermal "
+                 "simulation.");
+    ASSERT_THROW(database.get("ensemble.ensemble_simulation", false) == false,
+                 "Error: The cooldown termination is not compatible with "
+                 "ensemble simulations.");
+  }
+
   // Tree: experiment
   // I'm not checking for the existence of the experimental files here, that's
   // still done in `adamantine::read_experimental_data_point_cloud` and
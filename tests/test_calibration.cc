@@ -0,0 +1,92 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#define BOOST_TEST_MODULE Calibration
+
+#include "../application/calibration.hh"
+
+#include <filesystem>
+#include <limits>
+
+#include "main.cc"
+
+namespace utf = boost::unit_test;
+
+BOOST_AUTO_TEST_CASE(calibration_helpers, *utf::tolerance(1e-12))
+{
+  double const inf = std::numeric_limits<double>::infinity();
+  double const nan = std::numeric_limits<double>::quiet_NaN();
+
+  auto const degrees = parse_calibration_list<unsigned int>("1, 2,,3");
+  BOOST_TEST(degrees.size() == 3);
+  BOOST_TEST(degrees[2] == 3);
+
+  // A reference that failed or diverged is rejected.
+  check_calibration_reference(1., 300., 400.);
+  BOOST_CHECK_THROW(check_calibration_reference(inf, 300., 400.),
+                    std::runtime_error);
+  BOOST_CHECK_THROW(check_calibration_reference(1., nan, 400.),
+                    std::runtime_error);
+  BOOST_CHECK_THROW(check_calibration_reference(1., 300., nan),
+                    std::runtime_error);
+
+  // The error of a candidate that failed or diverged is infinite.
+  BOOST_TEST(compute_calibration_error(1., 300., 410., 300., 400., 100.) ==
+             0.1);
+  BOOST_TEST(compute_calibration_error(inf, 300., 400., 300., 400., 100.) ==
+             inf);
+  BOOST_TEST(compute_calibration_error(1., nan, nan, 300., 400., 100.) == inf);
+
+  // The fastest accurate candidate is selected.
+  std::vector<double> wall_times = {1., 3., 2.};
+  std::vector<double> errors = {inf, 1e-3, 1e-4};
+  BOOST_TEST(select_calibration_candidate(wall_times, errors, 1e-2) == 2);
+  // Without accurate candidate, the most accurate one is selected even if the
+  // first candidate failed.
+  BOOST_TEST(select_calibration_candidate(wall_times, errors, 1e-5) == 2);
+  // If every candidate failed, an exception is thrown.
+  errors = {inf, inf, inf};
+  BOOST_CHECK_THROW(select_calibration_candidate(wall_times, errors, 1e-2),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(calibration)
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  // Read the input.
+  std::string const filename = "integration_2d.info";
+  adamantine::ASSERT_THROW(std::filesystem::exists(filename) == true,
+                           "The file " + filename + " does not exist.");
+  boost::property_tree::ptree database;
+  boost::property_tree::info_parser::read_info(filename, database);
+  std::string const output_file = "calibration_test.info";
+  database.put("calibration.fe_degrees", "1,2");
+  database.put("calibration.quadratures", "gauss");
+  database.put("calibration.time_stepping_methods",
+               "forward_euler,rk_fourth_order");
+  database.put("calibration.duration", 2e-10);
+  database.put("calibration.tolerance", 1.);
+  database.put("calibration.output_file", output_file);
+  std::filesystem::remove(output_file);
+
+  calibrate<2, dealii::MemorySpace::Host>(communicator, database);
+
+  // Every candidate reaches the tolerance, the recommended configuration is
+  // one of the candidates.
+  BOOST_TEST(std::filesystem::exists(output_file));
+  boost::property_tree::ptree recommended;
+  boost::property_tree::info_parser::read_info(output_file, recommended);
+  unsigned int const fe_degree =
+      recommended.get<unsigned int>("discretization.thermal.fe_degree");
+  BOOST_TEST((fe_degree == 1 || fe_degree == 2));
+  std::string const method =
+      recommended.get<std::string>("time_stepping.method");
+  BOOST_TEST((method == "forward_euler" || method == "rk_fourth_order"));
+  // The GMRES parameters are only calibrated for the implicit methods.
+  BOOST_TEST(!recommended.get_optional<double>("time_stepping.tolerance"));
+}
@@ -0,0 +1,103 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#define BOOST_TEST_MODULE CartesianIndex
+
+#include <CartesianIndex.hh>
+#include <Geometry.hh>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/grid/grid_generator.h>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include "main.cc"
+
+BOOST_AUTO_TEST_CASE(cartesian_index)
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+  boost::property_tree::ptree database;
+  database.put("import_mesh", false);
+  database.put("length", 12);
+  database.put("length_divisions", 6);
+  database.put("height", 6);
+  database.put("height_divisions", 3);
+  database.put("width", 6);
+  database.put("width_divisions", 4);
+  adamantine::Geometry<3> geometry(communicator, database);
+  auto &triangulation = geometry.get_triangulation();
+  // Refine a corner of the domain twice.
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    for (auto cell : triangulation.active_cell_iterators())
+      if (cell->is_locally_owned() && (cell->center()[0] < 4.))
+        cell->set_refine_flag();
+    triangulation.execute_coarsening_and_refinement();
+  }
+
+  dealii::FE_Q<3> fe(1);
+  dealii::DoFHandler<3> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  adamantine::CartesianIndex<3> cartesian_index(dof_handler);
+  BOOST_TEST(cartesian_index.is_cartesian());
+
+  // Compare the box queries with a loop over all the active cells.
+  std::vector<dealii::BoundingBox<3>> boxes;
+  boxes.emplace_back(std::make_pair(dealii::Point<3>(0.1, 0.1, 0.1),
+                                    dealii::Point<3>(0.2, 0.2, 0.2)));
+  boxes.emplace_back(std::make_pair(dealii::Point<3>(1., 1.5, 2.),
+                                    dealii::Point<3>(5., 3., 2.)));
+  boxes.emplace_back(std::make_pair(dealii::Point<3>(3.5, -1., 4.5),
+                                    dealii::Point<3>(13., 2.5, 7.)));
+  boxes.emplace_back(std::make_pair(dealii::Point<3>(13., 0., 0.),
+                                    dealii::Point<3>(14., 1., 1.)));
+  for (auto const &box : boxes)
+  {
+    auto const cells = cartesian_index.intersect(box);
+    std::vector<typename dealii::DoFHandler<3>::active_cell_iterator> cells_ref;
+    for (auto const &cell : dof_handler.active_cell_iterators())
+    {
+      auto const &[lower, upper] = cell->bounding_box().get_boundary_points();
+      auto const &[box_lower, box_upper] = box.get_boundary_points();
+      bool intersect = true;
+      for (int d = 0; d < 3; ++d)
+        if ((lower[d] > box_upper[d]) || (box_lower[d] > upper[d]))
+          intersect = false;
+      if (intersect)
+        cells_ref.push_back(cell);
+    }
+    BOOST_TEST(cells.size() == cells_ref.size());
+    for (unsigned int i = 0; i < std::min(cells.size(), cells_ref.size()); ++i)
+      BOOST_TEST(cells[i]->id() == cells_ref[i]->id());
+  }
+
+  // Check the point queries.
+  for (auto const &cell : dof_handler.active_cell_iterators())
+  {
+    auto found_cell = cartesian_index.find_active_cell(cell->center());
+    BOOST_TEST(found_cell->id() == cell->id());
+  }
+  BOOST_TEST((cartesian_index.find_active_cell(dealii::Point<3>(
+                  -1., 1., 1.)) == dof_handler.end()));
+}
+
+BOOST_AUTO_TEST_CASE(not_cartesian)
+{
+  dealii::Triangulation<2> triangulation;
+  dealii::GridGenerator::hyper_ball(triangulation);
+  dealii::FE_Q<2> fe(1);
+  dealii::DoFHandler<2> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  adamantine::CartesianIndex<2> cartesian_index(dof_handler);
+  BOOST_TEST(!cartesian_index.is_cartesian());
+  BOOST_TEST(cartesian_index.intersect(dealii::BoundingBox<2>(std::make_pair(
+                                           dealii::Point<2>(-1., -1.),
+                                           dealii::Point<2>(1., 1.))))
+                 .size() == 0);
+}
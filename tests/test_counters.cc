@@ -0,0 +1,55 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#define BOOST_TEST_MODULE Counters
+
+#include <Counters.hh>
+
+#include <sstream>
+
+#include "main.cc"
+
+namespace utf = boost::unit_test;
+
+BOOST_AUTO_TEST_CASE(counters, *utf::tolerance(1e-12))
+{
+  adamantine::Counters counters;
+
+  counters.increment(adamantine::rk_stages);
+  counters.increment(adamantine::rk_stages);
+  counters.increment(adamantine::gmres_iterations, 12);
+  counters.increment(adamantine::operator_applications, 13);
+  counters.set(adamantine::n_active_dofs, 1000);
+  counters.set(adamantine::n_active_cells, 100);
+  counters.add_vmult(1000, 0.5);
+  counters.add_vmult(1000, 1.5);
+
+  BOOST_TEST(counters.get(adamantine::rk_stages) == 2);
+  BOOST_TEST(counters.get(adamantine::gmres_iterations) == 12);
+  BOOST_TEST(counters.get(adamantine::operator_applications) == 13);
+  BOOST_TEST(counters.get(adamantine::newton_iterations) == 0);
+  BOOST_TEST(counters.get_vmult_throughput() == 1000.);
+
+  std::stringstream header;
+  adamantine::Counters::write_csv_header(header);
+  std::stringstream row;
+  counters.write_csv_row(row, 3, 0.5);
+  BOOST_TEST(header.str() ==
+             "time_step,time,operator_applications,rk_stages,newton_iterations,"
+             "gmres_iterations,cg_iterations,rejected_steps,n_active_dofs,"
+             "n_active_cells,vmult_dofs_per_second\n");
+  BOOST_TEST(row.str() == "3,0.5,13,2,0,12,0,0,1000,100,1000\n");
+
+  // The counters of the size of the problem are not reset.
+  counters.reset();
+  BOOST_TEST(counters.get(adamantine::rk_stages) == 0);
+  BOOST_TEST(counters.get(adamantine::gmres_iterations) == 0);
+  BOOST_TEST(counters.get(adamantine::operator_applications) == 0);
+  BOOST_TEST(counters.get(adamantine::n_active_dofs) == 1000);
+  BOOST_TEST(counters.get(adamantine::n_active_cells) == 100);
+  BOOST_TEST(counters.get_vmult_throughput() == 0.);
+}
@@ -1,4 +1,4 @@
-/* Copyright (c) 2016 - 2021, the adamantine authors.
+/* Copyright (c) 2016 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -14,6 +14,9 @@
 
 #include <boost/property_tree/ptree.hpp>
 
+#include <cmath>
+#include <filesystem>
+
 #include "main.cc"
 
 template <int dim>
@@ -99,6 +102,76 @@ BOOST_AUTO_TEST_CASE(geometry_3D)
   check_material_id(tria, top_boundary);
 }
 
+BOOST_AUTO_TEST_CASE(geometry_3D_layer_aligned)
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+  boost::property_tree::ptree database;
+  database.put("import_mesh", false);
+  database.put("length", 12);
+  database.put("length_divisions", 4);
+  database.put("height", 4);
+  database.put("height_divisions", 2);
+  database.put("width", 6);
+  database.put("width_divisions", 5);
+  database.put("material_height", 2);
+  database.put("layer_aligned_mesh", true);
+  database.put("layer_thickness", 0.5);
+
+  adamantine::Geometry<3> geometry(communicator, database);
+  dealii::parallel::distributed::Triangulation<3> const &tria =
+      geometry.get_triangulation();
+
+  // One cell below the material height and four layers above it.
+  BOOST_TEST(tria.n_global_active_cells() == 100);
+  for (auto cell :
+       dealii::filter_iterators(tria.active_cell_iterators(),
+                                dealii::IteratorFilters::LocallyOwnedCell()))
+  {
+    double const cell_height = cell->extent_in_direction(2);
+    if (cell->center()[2] < 2.)
+      BOOST_TEST(cell_height == 2.);
+    else
+      BOOST_TEST(cell_height == 0.5);
+    BOOST_TEST(cell->extent_in_direction(0) == 3.);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(geometry_3D_symmetry)
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+  boost::property_tree::ptree database;
+  database.put("import_mesh", false);
+  database.put("length", 12);
+  database.put("length_divisions", 4);
+  database.put("height", 4);
+  database.put("height_divisions", 2);
+  database.put("width", 6);
+  database.put("width_divisions", 4);
+  database.put("symmetry", true);
+
+  adamantine::Geometry<3> geometry(communicator, database);
+  dealii::parallel::distributed::Triangulation<3> const &tria =
+      geometry.get_triangulation();
+
+  // Only the half of the domain below y = 3 is meshed.
+  BOOST_TEST(tria.n_global_active_cells() == 16);
+  for (auto cell :
+       dealii::filter_iterators(tria.active_cell_iterators(),
+                                dealii::IteratorFilters::LocallyOwnedCell()))
+  {
+    BOOST_TEST(cell->extent_in_direction(1) == 1.5);
+    for (auto const f : cell->face_indices())
+    {
+      if (cell->face(f)->at_boundary())
+      {
+        bool const on_plane = std::abs(cell->face(f)->center()[1] - 3.) < 1e-12;
+        BOOST_TEST((cell->face(f)->boundary_id() ==
+                    adamantine::g_symmetry_boundary_id) == on_plane);
+      }
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE(gmsh)
 {
   MPI_Comm communicator = MPI_COMM_WORLD;
@@ -119,3 +192,56 @@ BOOST_AUTO_TEST_CASE(gmsh)
   dealii::types::boundary_id const top_boundary = 1;
   check_material_id(tria, top_boundary);
 }
+
+BOOST_AUTO_TEST_CASE(gmsh_cache)
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+  std::string const cache_directory = "geometry_mesh_cache";
+  if (dealii::Utilities::MPI::this_mpi_process(communicator) == 0)
+    std::filesystem::remove_all(cache_directory);
+  MPI_Barrier(communicator);
+
+  boost::property_tree::ptree database;
+  database.put("import_mesh", true);
+  database.put("mesh_file", "extruded_cube.msh");
+  database.put("mesh_format", "gmsh");
+  database.put("mesh_cache_directory", cache_directory);
+  database.put("material_height", 1.);
+  database.put("use_powder", true);
+  database.put("powder_layer", 0.05);
+
+  // The first Geometry reads the mesh and writes the cache, the second one
+  // loads the cache.
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    adamantine::Geometry<3> geometry(communicator, database);
+    dealii::parallel::distributed::Triangulation<3> const &tria =
+        geometry.get_triangulation();
+    MPI_Barrier(communicator);
+
+    BOOST_TEST(std::distance(std::filesystem::directory_iterator(
+                                 cache_directory),
+                             std::filesystem::directory_iterator{}) == 1);
+    BOOST_TEST(tria.n_global_active_cells() == 320);
+
+    dealii::types::boundary_id const top_boundary = 1;
+    check_material_id(tria, top_boundary);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(missing_mesh_file)
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+  boost::property_tree::ptree database;
+  database.put("import_mesh", true);
+  database.put("mesh_file", "missing_mesh.msh");
+  database.put("mesh_format", "gmsh");
+  database.put("material_height", 1.);
+  database.put("use_powder", true);
+  database.put("powder_layer", 0.05);
+
+  // The error on the first processor is rethrown on every processor instead
+  // of leaving the other processors waiting for the mesh.
+  BOOST_CHECK_THROW(adamantine::Geometry<3>(communicator, database),
+                    std::exception);
+}
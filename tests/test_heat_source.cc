@@ -1,4 +1,4 @@
-/* Copyright (c) 2016 - 2021, the adamantine authors.
+/* Copyright (c) 2016 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -10,6 +10,7 @@
 #include <ElectronBeamHeatSource.hh>
 #include <GoldakHeatSource.hh>
 #include <HeatSource.hh>
+#include <LayerHeatSource.hh>
 #include <ScanPath.hh>
 
 #include "main.cc"
@@ -206,4 +207,120 @@ BOOST_AUTO_TEST_CASE(heat_source_height, *utf::tolerance(1e-12))
   BOOST_TEST(eb_height == 0.001);
 }
 
+BOOST_AUTO_TEST_CASE(layer_heat_source, *utf::tolerance(1e-12))
+{
+  boost::property_tree::ptree database;
+
+  database.put("depth", 0.1);
+  database.put("absorption_efficiency", 0.1);
+  database.put("diameter", 1.0);
+  database.put("max_power", 10.);
+  database.put("scan_path_file", "scan_path_layers.txt");
+  database.put("scan_path_file_format", "segment");
+  LayerHeatSource<2> layer_heat_source_2d(database);
+  LayerHeatSource<3> layer_heat_source_3d(database);
+
+  // The beam scans each layer during 0.0025 s. The energy deposited is spread
+  // over the segment enlarged by the radius of the beam and over the depth.
+  double const expected_value = 0.1 * 10. / (1.002 * 1.0 * 0.1);
+
+  // First layer
+  layer_heat_source_2d.update_time(0.001);
+  BOOST_TEST(layer_heat_source_2d.value(dealii::Point<2>(0.001, -0.05), 0.) ==
+             expected_value);
+  BOOST_TEST(layer_heat_source_2d.value(dealii::Point<2>(0.001, -0.2), 0.) ==
+             0.);
+  BOOST_TEST(layer_heat_source_2d.value(dealii::Point<2>(0.6, -0.05), 0.) ==
+             0.);
+  layer_heat_source_3d.update_time(0.001);
+  BOOST_TEST(layer_heat_source_3d.value(dealii::Point<3>(0.001, 0.4, -0.05),
+                                        0.) == expected_value);
+  BOOST_TEST(layer_heat_source_3d.value(dealii::Point<3>(0.001, 0.6, -0.05),
+                                        0.) == 0.);
+
+  // The beam is moving to the second layer
+  layer_heat_source_3d.update_time(0.0025015);
+  BOOST_TEST(layer_heat_source_3d.value(dealii::Point<3>(0.001, 0., -0.05),
+                                        0.) == 0.);
+
+  // Second layer
+  layer_heat_source_3d.update_time(0.003);
+  BOOST_TEST(layer_heat_source_3d.value(dealii::Point<3>(0.001, 0., 0.0005),
+                                        0.) == expected_value);
+  BOOST_TEST(layer_heat_source_3d.value(dealii::Point<3>(0.001, 0., -0.1),
+                                        0.) == 0.);
+
+  // After the end of the scan path
+  layer_heat_source_3d.update_time(1.);
+  BOOST_TEST(layer_heat_source_3d.value(dealii::Point<3>(0.001, 0., 0.0005),
+                                        0.) == 0.);
+}
+
+BOOST_AUTO_TEST_CASE(time_averaged_heat_source, *utf::tolerance(1e-12))
+{
+  boost::property_tree::ptree database;
+
+  database.put("depth", 0.1);
+  database.put("absorption_efficiency", 0.1);
+  database.put("diameter", 1.0);
+  database.put("max_power", 10.);
+  database.put("scan_path_file", "scan_path.txt");
+  database.put("scan_path_file_format", "segment");
+  GoldakHeatSource<3> goldak_heat_source(database);
+  ElectronBeamHeatSource<3> eb_heat_source(database);
+  unsigned int const n_samples = 4;
+  database.put("time_averaging_samples", n_samples);
+  GoldakHeatSource<3> averaged_goldak_heat_source(database);
+  ElectronBeamHeatSource<3> averaged_eb_heat_source(database);
+
+  // Without an interval, the source is not averaged.
+  double const time = 0.001;
+  dealii::Point<3> const point(4.0e-4, 0.1, 0.19);
+  goldak_heat_source.update_time(time);
+  averaged_goldak_heat_source.update_time(time);
+  BOOST_TEST(averaged_goldak_heat_source.value(point, 0.2) ==
+             goldak_heat_source.value(point, 0.2));
+
+  // The averaged source is the mean of the source at the midpoints of the
+  // sub-intervals of the window.
+  double const interval = 0.0008;
+  averaged_goldak_heat_source.set_time_averaging_window(time, interval);
+  averaged_eb_heat_source.set_time_averaging_window(time, interval);
+  averaged_goldak_heat_source.update_time(time);
+  averaged_eb_heat_source.update_time(time);
+  double g_value = 0.;
+  double eb_value = 0.;
+  for (unsigned int i = 0; i < n_samples; ++i)
+  {
+    double const sample_time = time + (i + 0.5) * interval / n_samples;
+    goldak_heat_source.update_time(sample_time);
+    g_value += goldak_heat_source.value(point, 0.2) / n_samples;
+    eb_heat_source.update_time(sample_time);
+    eb_value += eb_heat_source.value(point, 0.2) / n_samples;
+  }
+  BOOST_TEST(averaged_goldak_heat_source.value(point, 0.2) == g_value);
+  BOOST_TEST(averaged_eb_heat_source.value(point, 0.2) == eb_value);
+
+  // Every time in the window, in particular the end of the step used by the
+  // implicit methods, gives the same average.
+  for (double const stage_time : {time + 0.5 * interval, time + interval})
+  {
+    averaged_goldak_heat_source.update_time(stage_time);
+    averaged_eb_heat_source.update_time(stage_time);
+    BOOST_TEST(averaged_goldak_heat_source.value(point, 0.2) == g_value);
+    BOOST_TEST(averaged_eb_heat_source.value(point, 0.2) == eb_value);
+  }
+
+  // Outside of the window, the source is not averaged.
+  double const outside_time = time - 0.5 * interval;
+  averaged_goldak_heat_source.update_time(outside_time);
+  goldak_heat_source.update_time(outside_time);
+  BOOST_TEST(averaged_goldak_heat_source.value(point, 0.2) ==
+             goldak_heat_source.value(point, 0.2));
+
+  // The source is zero after the end of the scan path.
+  averaged_goldak_heat_source.update_time(100.);
+  BOOST_TEST(averaged_goldak_heat_source.value(point, 0.2) == 0.);
+}
+
 } // namespace adamantine
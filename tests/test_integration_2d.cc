@@ -71,3 +71,120 @@ BOOST_AUTO_TEST_CASE(integration_2D_ensemble, *utf::tolerance(0.1))
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(cooldown_check, *utf::tolerance(1e-12))
+{
+  dealii::LA::distributed::Vector<double, dealii::MemorySpace::Host>
+      temperature(10);
+  boost::property_tree::ptree cooldown_database;
+  cooldown_database.put("temperature", 400.);
+  cooldown_database.put("temperature_rate", 20.);
+  double const ambient_temperature = 300.;
+
+  // The temperature and its rate of change (10 K/s) are below the thresholds.
+  temperature = 350.;
+  BOOST_TEST(is_cooled_down(temperature, 350., 10., 0., 1., 3.,
+                            cooldown_database, ambient_temperature));
+  BOOST_TEST(temperature.linfty_norm() == 350.);
+
+  // The time did not advance.
+  BOOST_TEST(!is_cooled_down(temperature, 350., 10., 1., 1., 3.,
+                             cooldown_database, ambient_temperature));
+
+  // The temperature is too high.
+  temperature = 450.;
+  BOOST_TEST(!is_cooled_down(temperature, 450., 10., 0., 1., 3.,
+                             cooldown_database, ambient_temperature));
+
+  // The temperature changes too fast.
+  temperature = 350.;
+  BOOST_TEST(!is_cooled_down(temperature, 350., 30., 0., 1., 3.,
+                             cooldown_database, ambient_temperature));
+
+  // The rate is the change of the temperature divided by the time step.
+  BOOST_TEST(is_cooled_down(temperature, 350., 30., 0., 2., 3.,
+                            cooldown_database, ambient_temperature));
+
+  // With fast_forward, the difference with the ambient temperature decays
+  // exponentially until the end of the simulation.
+  cooldown_database.put("fast_forward", true);
+  BOOST_TEST(is_cooled_down(temperature, 350., 10., 0., 1., 3.,
+                            cooldown_database, ambient_temperature));
+  double const expected_temperature =
+      ambient_temperature + 50. * std::exp(-(3. - 1.) * 10. / 50.);
+  for (unsigned int i = 0; i < temperature.locally_owned_size(); ++i)
+    BOOST_TEST(temperature.local_element(i) == expected_temperature);
+
+  // Nothing is fast-forwarded past the end of the simulation.
+  temperature = 350.;
+  BOOST_TEST(is_cooled_down(temperature, 350., 10., 0., 1., 1.,
+                            cooldown_database, ambient_temperature));
+  BOOST_TEST(temperature.linfty_norm() == 350.);
+}
+
+BOOST_AUTO_TEST_CASE(integration_2D_cooldown, *utf::tolerance(1e-10))
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  // The beam stops at 2.2e-10 s. The cool-down is checked from the first time
+  // step that starts after that time, [2.5e-10, 3e-10].
+  boost::property_tree::ptree database;
+  boost::property_tree::info_parser::read_info("integration_2d.info", database);
+  database.put("sources.beam_0.scan_path_file", "scan_path_cooldown.txt");
+  database.put("post_processor.filename_prefix", "integration_2d_cooldown");
+  database.put("post_processor.time_steps_between_output", 1000);
+
+  auto run_database = [&](boost::property_tree::ptree const &input_database)
+  {
+    std::vector<adamantine::Timer> timers;
+    initialize_timers(communicator, timers);
+    boost::property_tree::ptree local_database = input_database;
+    return run<2, dealii::MemorySpace::Host>(communicator, local_database,
+                                             timers)
+        .first;
+  };
+
+  // Reference that stops at 3e-10 s.
+  boost::property_tree::ptree reference_database = database;
+  reference_database.put("time_stepping.duration", 3e-10);
+  auto const reference = run_database(reference_database);
+
+  // The part is considered cooled down as soon as the check starts. The
+  // simulation stops at 3e-10 s instead of 1e-9 s.
+  database.put("time_stepping.cooldown.temperature", 1e6);
+  auto const cooled_down = run_database(database);
+  BOOST_TEST(cooled_down.size() == reference.size());
+  for (unsigned int i = 0; i < reference.locally_owned_size(); ++i)
+    BOOST_TEST(cooled_down.local_element(i) == reference.local_element(i));
+
+  // The part never cools down below 1 K. The simulation runs until the end.
+  boost::property_tree::ptree hot_database = database;
+  hot_database.put("time_stepping.cooldown.temperature", 1.);
+  boost::property_tree::ptree full_database = database;
+  full_database.get_child("time_stepping").erase("cooldown");
+  auto const hot = run_database(hot_database);
+  auto const full = run_database(full_database);
+  for (unsigned int i = 0; i < full.locally_owned_size(); ++i)
+    BOOST_TEST(hot.local_element(i) == full.local_element(i));
+
+  // With fast_forward, the simulation stops at 3e-10 s and the difference with
+  // the ambient temperature is reduced by the same factor everywhere.
+  database.put("time_stepping.cooldown.fast_forward", true);
+  auto const fast_forward = run_database(database);
+  // The norms are reduced over all the processors. The temperature is
+  // positive so its infinity norm is its maximum.
+  double const initial_temperature = 300.;
+  double const max_difference = reference.linfty_norm() - initial_temperature;
+  BOOST_TEST(max_difference > 0.);
+  double const factor =
+      (fast_forward.linfty_norm() - initial_temperature) / max_difference;
+  BOOST_TEST(factor > 0.);
+  BOOST_TEST(factor < 1.);
+  for (unsigned int i = 0; i < reference.locally_owned_size(); ++i)
+  {
+    double const expected_temperature =
+        initial_temperature +
+        factor * (reference.local_element(i) - initial_temperature);
+    BOOST_TEST(fast_forward.local_element(i) == expected_temperature);
+  }
+}
@@ -55,3 +55,269 @@ BOOST_AUTO_TEST_CASE(integration_3D_amr, *utf::tolerance(0.1))
   BOOST_TEST(expected_max == global_max);
   BOOST_TEST(expected_min == global_min);
 }
+
+BOOST_AUTO_TEST_CASE(integration_3D_amr_gradient_jump, *utf::tolerance(0.1))
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  std::vector<adamantine::Timer> timers;
+  initialize_timers(communicator, timers);
+
+  // Read the input.
+  std::string const filename = "amr_test.info";
+  adamantine::ASSERT_THROW(std::filesystem::exists(filename) == true,
+                           "The file " + filename + " does not exist.");
+  boost::property_tree::ptree database;
+  boost::property_tree::info_parser::read_info(filename, database);
+  // The input file does not use the error estimator, enable it.
+  database.put("refinement.n_heat_refinements", 1);
+  database.put("refinement.error_estimator", "gradient_jump");
+  database.put("refinement.error_estimator_min_temperature", 300.);
+
+  auto [temperature, displacement] =
+      run<3, dealii::MemorySpace::Host>(communicator, database, timers);
+
+  double min_val = std::numeric_limits<double>::max();
+  double max_val = std::numeric_limits<double>::lowest();
+  for (unsigned int i = 0; i < temperature.locally_owned_size(); ++i)
+  {
+    min_val = std::min(min_val, temperature.local_element(i));
+    max_val = std::max(max_val, temperature.local_element(i));
+  }
+
+  double global_max =
+      dealii::Utilities::MPI::max(max_val, temperature.get_mpi_communicator());
+  double global_min =
+      dealii::Utilities::MPI::min(min_val, temperature.get_mpi_communicator());
+
+  // The indicator only changes the mesh so the temperature is close to the
+  // one obtained without the heat refinements.
+  double expected_max = 329.5;
+  double expected_min = 296.1;
+
+  BOOST_TEST(expected_max == global_max);
+  BOOST_TEST(expected_min == global_min);
+}
+
+BOOST_AUTO_TEST_CASE(coarsen_cell_data_children, *utf::tolerance(1e-12))
+{
+  unsigned int constexpr n_states = adamantine::g_n_material_states;
+  double const inf = std::numeric_limits<double>::infinity();
+  double const lowest = std::numeric_limits<double>::lowest();
+  // Each child has a different material state and a different temperature. The
+  // third child is not activated.
+  std::vector<std::vector<double>> children_data(
+      4, std::vector<double>(n_states + 5, 0.));
+  children_data[0][0] = 1.;
+  children_data[1][1] = 1.;
+  children_data[2][n_states - 1] = 1.;
+  children_data[3][1] = 1.;
+  std::vector<std::vector<double>> const other_data = {
+      {1., 0., 1., 2e-5, 500.},
+      {0., 1., 0., inf, 900.},
+      {inf, inf, inf, 1e-5, lowest},
+      {1., 0., 0., 3e-5, 700.}};
+  for (unsigned int i = 0; i < children_data.size(); ++i)
+    std::copy(other_data[i].begin(), other_data[i].end(),
+              children_data[i].begin() + n_states);
+
+  auto parent_data = coarsen_cell_data(children_data, n_states);
+  BOOST_TEST(parent_data.size() == n_states + 5);
+  BOOST_TEST(parent_data[0] == 0.25);
+  BOOST_TEST(parent_data[1] == 0.5);
+  BOOST_TEST(parent_data[n_states - 1] == 0.25);
+  BOOST_TEST(parent_data[n_states] == 2. / 3.);
+  BOOST_TEST(parent_data[n_states + 1] == 1. / 3.);
+  BOOST_TEST(parent_data[n_states + 2] == 1.);
+  // The second child is not cooling so the parent is not cooling either.
+  BOOST_TEST(std::isinf(parent_data[n_states + 3]));
+  BOOST_TEST(parent_data[n_states + 4] == 900.);
+
+  // When all the children are cooling, the parent started cooling with the
+  // last child.
+  children_data[1][n_states + 3] = 2.5e-5;
+  parent_data = coarsen_cell_data(children_data, n_states);
+  BOOST_TEST(parent_data[n_states + 3] == 3e-5);
+
+  // Without activated children, the deposition angle and the melted indicator
+  // stay infinite.
+  for (auto &child_data : children_data)
+    std::fill(child_data.begin() + n_states, child_data.begin() + n_states + 3,
+              inf);
+  parent_data = coarsen_cell_data(children_data, n_states);
+  BOOST_TEST(std::isinf(parent_data[n_states]));
+  BOOST_TEST(std::isinf(parent_data[n_states + 1]));
+  BOOST_TEST(std::isinf(parent_data[n_states + 2]));
+  BOOST_TEST(parent_data[n_states + 4] == 900.);
+}
+
+BOOST_AUTO_TEST_CASE(integration_3D_amr_progressive_coarsening,
+                     *utf::tolerance(0.1))
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  std::vector<adamantine::Timer> timers;
+  initialize_timers(communicator, timers);
+
+  // Read the input.
+  std::string const filename = "amr_test.info";
+  adamantine::ASSERT_THROW(std::filesystem::exists(filename) == true,
+                           "The file " + filename + " does not exist.");
+  boost::property_tree::ptree database;
+  boost::property_tree::info_parser::read_info(filename, database);
+  // The cells far from the beam cool down and they are coarsened while the
+  // temperature of their children differs.
+  database.put("refinement.time_steps_between_refinement", 50);
+
+  // Without coarsening, every cell crossed by the beam stays refined.
+  auto const reference_n_dofs =
+      std::get<0>(run<3, dealii::MemorySpace::Host>(communicator, database,
+                                                    timers))
+          .size();
+
+  database.put("refinement.progressive_coarsening.temperature", 1000.);
+  database.put("refinement.progressive_coarsening.temperature_rate", 1e5);
+  database.put("refinement.progressive_coarsening.cooling_time", 5e-5);
+  database.put("refinement.progressive_coarsening.layer_thickness", 0.5e-3);
+
+  auto [temperature, displacement] =
+      run<3, dealii::MemorySpace::Host>(communicator, database, timers);
+
+  double min_val = std::numeric_limits<double>::max();
+  double max_val = std::numeric_limits<double>::lowest();
+  for (unsigned int i = 0; i < temperature.locally_owned_size(); ++i)
+  {
+    min_val = std::min(min_val, temperature.local_element(i));
+    max_val = std::max(max_val, temperature.local_element(i));
+  }
+
+  double global_max =
+      dealii::Utilities::MPI::max(max_val, temperature.get_mpi_communicator());
+  double global_min =
+      dealii::Utilities::MPI::min(min_val, temperature.get_mpi_communicator());
+
+  // Only the mesh far from the beam changes so the temperature is close to the
+  // one obtained without the coarsening.
+  double expected_max = 329.5;
+  double expected_min = 296.1;
+
+  BOOST_TEST(expected_max == global_max);
+  BOOST_TEST(expected_min == global_min);
+
+  // The cells that cooled down have been coarsened.
+  BOOST_TEST(temperature.size() < reference_n_dofs);
+
+  // The cells are not coarsened below the minimum level of their layer.
+  database.put("refinement.progressive_coarsening.min_levels", "1");
+  BOOST_TEST(std::get<0>(run<3, dealii::MemorySpace::Host>(communicator,
+                                                           database, timers))
+                 .size() == reference_n_dofs);
+}
+
+BOOST_AUTO_TEST_CASE(integration_3D_amr_dry_run)
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  std::vector<adamantine::Timer> timers;
+  initialize_timers(communicator, timers);
+
+  // Read the input.
+  std::string const filename = "amr_test.info";
+  adamantine::ASSERT_THROW(std::filesystem::exists(filename) == true,
+                           "The file " + filename + " does not exist.");
+  boost::property_tree::ptree database;
+  boost::property_tree::info_parser::read_info(filename, database);
+
+  auto [max_n_dofs, max_n_cells, n_refinements, n_dofs] =
+      dry_run<3, dealii::MemorySpace::Host>(communicator, database, timers);
+
+  // The coarse mesh has 4x4x1 cells and the cells on the path of the beam are
+  // refined once. The mesh is refined at the first time step and after 200
+  // time steps.
+  BOOST_TEST(max_n_cells > 16ULL);
+  BOOST_TEST(max_n_cells <= 128ULL);
+  BOOST_TEST(max_n_dofs > max_n_cells);
+  BOOST_TEST(n_refinements == 2);
+}
+
+BOOST_AUTO_TEST_CASE(integration_3D_amr_beam_travel_dry_run)
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  std::vector<adamantine::Timer> timers;
+  initialize_timers(communicator, timers);
+
+  // Read the input.
+  std::string const filename = "amr_test.info";
+  adamantine::ASSERT_THROW(std::filesystem::exists(filename) == true,
+                           "The file " + filename + " does not exist.");
+  boost::property_tree::ptree database;
+  boost::property_tree::info_parser::read_info(filename, database);
+  // Keep the cells that the beam crossed recently refined.
+  database.put("refinement.time_steps_between_refinement", 10);
+  database.put("refinement.coarsen_after_beam", true);
+  database.put("refinement.coarsening_delay", 5e-5);
+
+  // Refining every 10 time steps is used as a reference.
+  auto const reference_n_refinements = std::get<2>(
+      dry_run<3, dealii::MemorySpace::Host>(communicator, database, timers));
+
+  // Refine every time the beam has traveled a quarter of the domain.
+  database.put("refinement.beam_travel_distance", 1.25e-3);
+  database.put("refinement.lookahead_distance", 2.5e-3);
+  auto [max_n_dofs, max_n_cells, n_refinements, n_dofs] =
+      dry_run<3, dealii::MemorySpace::Host>(communicator, database, timers);
+
+  BOOST_TEST(max_n_cells > 16ULL);
+  BOOST_TEST(max_n_cells <= 128ULL);
+  BOOST_TEST(max_n_dofs > max_n_cells);
+  // The beam travels 16e-6 m per time step during about 250 time steps. The
+  // mesh is refined at the first time step and then about every 79 time steps,
+  // when the beam has traveled 1.25e-3 m. This is much less often than every
+  // 10 time steps.
+  BOOST_TEST(n_refinements == 4);
+  BOOST_TEST(n_refinements < reference_n_refinements);
+}
+
+BOOST_AUTO_TEST_CASE(integration_3D_amr_progressive_coarsening_dry_run)
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  std::vector<adamantine::Timer> timers;
+  initialize_timers(communicator, timers);
+
+  // Read the input.
+  std::string const filename = "amr_test.info";
+  adamantine::ASSERT_THROW(std::filesystem::exists(filename) == true,
+                           "The file " + filename + " does not exist.");
+  boost::property_tree::ptree database;
+  boost::property_tree::info_parser::read_info(filename, database);
+  database.put("refinement.time_steps_between_refinement", 50);
+
+  // Without coarsening, every cell crossed by the beam stays refined.
+  auto const reference_n_dofs = std::get<3>(
+      dry_run<3, dealii::MemorySpace::Host>(communicator, database, timers));
+
+  // The temperature of the dry run is constant so the cells behind the beam
+  // are coarsened as soon as the cooling time is over.
+  database.put("refinement.progressive_coarsening.temperature", 1000.);
+  database.put("refinement.progressive_coarsening.temperature_rate", 1e3);
+  database.put("refinement.progressive_coarsening.cooling_time", 5e-5);
+  database.put("refinement.progressive_coarsening.layer_thickness", 0.5e-3);
+
+  auto [max_n_dofs, max_n_cells, n_refinements, n_dofs] =
+      dry_run<3, dealii::MemorySpace::Host>(communicator, database, timers);
+
+  BOOST_TEST(max_n_cells > 16ULL);
+  BOOST_TEST(max_n_cells <= 128ULL);
+  BOOST_TEST(max_n_dofs > max_n_cells);
+  BOOST_TEST(n_refinements == 6);
+  // Only the cells close to the end of the scan path are still refined.
+  BOOST_TEST(n_dofs < reference_n_dofs);
+  BOOST_TEST(n_dofs <= max_n_dofs);
+
+  // The cells are not coarsened below the minimum level of their layer.
+  database.put("refinement.progressive_coarsening.min_levels", "1");
+  BOOST_TEST(std::get<3>(dry_run<3, dealii::MemorySpace::Host>(
+                 communicator, database, timers)) == reference_n_dofs);
+}
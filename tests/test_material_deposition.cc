@@ -1,4 +1,4 @@
-/* Copyright (c) 2021 - 2022, the adamantine authors.
+/* Copyright (c) 2021 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -8,6 +8,7 @@
 #define BOOST_TEST_MODULE MaterialDeposition
 
 #include <Geometry.hh>
+#include <GoldakHeatSource.hh>
 #include <MaterialProperty.hh>
 #include <ThermalPhysics.hh>
 #include <Timer.hh>
@@ -106,6 +107,42 @@ BOOST_AUTO_TEST_CASE(read_material_deposition_file_3d, *utf::tolerance(1e-13))
   }
 }
 
+BOOST_AUTO_TEST_CASE(shared_material_deposition_boxes,
+                     *utf::tolerance(1e-13))
+{
+  // Geometry database
+  boost::property_tree::ptree geometry_database;
+  geometry_database.put("material_deposition", true);
+  geometry_database.put("material_deposition_method", "file");
+  geometry_database.put("material_deposition_file",
+                        "material_deposition_3d.txt");
+  std::vector<std::shared_ptr<adamantine::HeatSource<3>>> heat_sources;
+
+  auto [bounding_boxes_ref, time_ref, cos_ref, sin_ref] =
+      adamantine::create_material_deposition_boxes<3>(geometry_database,
+                                                      heat_sources);
+  // The boxes are only read by the first processor of the node but every
+  // processor gets the same boxes, times, and angles.
+  auto [bounding_boxes, time, deposition_cos, deposition_sin] =
+      adamantine::create_material_deposition_boxes<3>(
+          MPI_COMM_WORLD, geometry_database, heat_sources);
+
+  BOOST_TEST(time == time_ref);
+  BOOST_TEST(deposition_cos == cos_ref);
+  BOOST_TEST(deposition_sin == sin_ref);
+  BOOST_TEST(bounding_boxes.size() == bounding_boxes_ref.size());
+  for (unsigned int i = 0; i < bounding_boxes_ref.size(); ++i)
+  {
+    auto points = bounding_boxes[i].get_boundary_points();
+    auto points_ref = bounding_boxes_ref[i].get_boundary_points();
+    for (int d = 0; d < 3; ++d)
+    {
+      BOOST_TEST(points.first[d] == points_ref.first[d]);
+      BOOST_TEST(points.second[d] == points_ref.second[d]);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE(get_elements_to_activate_2d)
 {
   MPI_Comm communicator = MPI_COMM_WORLD;
@@ -214,10 +251,10 @@ BOOST_AUTO_TEST_CASE(get_elements_to_activate_3d)
     cell_id_ref[1].push_back(dealii::CellId("8_0:"));
     cell_id_ref[2].push_back(dealii::CellId("272_0:"));
     cell_id_ref[2].push_back(dealii::CellId("273_0:"));
-    cell_id_ref[2].push_back(dealii::CellId("276_0:"));
-    cell_id_ref[2].push_back(dealii::CellId("277_0:"));
     cell_id_ref[2].push_back(dealii::CellId("274_0:"));
     cell_id_ref[2].push_back(dealii::CellId("275_0:"));
+    cell_id_ref[2].push_back(dealii::CellId("276_0:"));
+    cell_id_ref[2].push_back(dealii::CellId("277_0:"));
     cell_id_ref[2].push_back(dealii::CellId("278_0:"));
     cell_id_ref[2].push_back(dealii::CellId("279_0:"));
 
@@ -645,3 +682,88 @@ BOOST_AUTO_TEST_CASE(merge_multiple_deposition_paths, *utf::tolerance(1e-10))
     BOOST_TEST(sin[i] == sin_ref[i]);
   }
 }
+
+BOOST_AUTO_TEST_CASE(lump_material_deposition, *utf::tolerance(1e-13))
+{
+  // Two boxes per layer and four layers of thickness 0.5. The second box of a
+  // layer is deposited one second after the first one.
+  std::vector<dealii::BoundingBox<2>> bounding_boxes;
+  std::vector<double> time;
+  std::vector<double> cos;
+  std::vector<double> sin;
+  for (unsigned int layer = 0; layer < 4; ++layer)
+  {
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+      bounding_boxes.emplace_back(
+          std::make_pair(dealii::Point<2>(i, 1. + 0.5 * layer),
+                         dealii::Point<2>(i + 1., 1.5 + 0.5 * layer)));
+      time.push_back(10. * layer + i);
+      cos.push_back(1.);
+      sin.push_back(0.);
+    }
+  }
+  auto const deposition = std::make_tuple(bounding_boxes, time, cos, sin);
+
+  // Lump the layers two by two
+  boost::property_tree::ptree geometry_database;
+  geometry_database.put("lumped_layers", 2);
+  auto [lumped_boxes, lumped_time, lumped_cos, lumped_sin] =
+      adamantine::lump_material_deposition<2>(geometry_database, deposition);
+  std::vector<double> time_ref = {0., 0., 0., 0., 20., 20., 20., 20.};
+  BOOST_TEST(lumped_boxes.size() == bounding_boxes.size());
+  BOOST_TEST(lumped_time == time_ref);
+
+  // Lump the layers using a height that covers three layers
+  geometry_database.clear();
+  geometry_database.put("lumped_height", 1.5);
+  auto [lumped_boxes_height, lumped_time_height, lumped_cos_height,
+        lumped_sin_height] =
+      adamantine::lump_material_deposition<2>(geometry_database, deposition);
+  time_ref = {0., 0., 0., 0., 0., 0., 30., 30.};
+  BOOST_TEST(lumped_time_height == time_ref);
+}
+
+BOOST_AUTO_TEST_CASE(symmetry_plane)
+{
+  boost::property_tree::ptree geometry_database;
+  geometry_database.put("width", 0.01);
+  geometry_database.put("symmetry", true);
+
+  boost::property_tree::ptree beam_database;
+  beam_database.put("depth", 1e-3);
+  beam_database.put("absorption_efficiency", 0.1);
+  beam_database.put("diameter", 1e-3);
+  beam_database.put("max_power", 10.);
+  beam_database.put("scan_path_file_format", "segment");
+  // The beam moves to the plane y = 0.005 while it is off and then moves on
+  // the plane.
+  beam_database.put("scan_path_file", "scan_path_symmetry.txt");
+  std::vector<std::shared_ptr<adamantine::HeatSource<3>>> symmetric_sources = {
+      std::make_shared<adamantine::GoldakHeatSource<3>>(beam_database)};
+  // The beam is on at y = 0.
+  beam_database.put("scan_path_file", "scan_path.txt");
+  std::vector<std::shared_ptr<adamantine::HeatSource<3>>> asymmetric_sources =
+      {std::make_shared<adamantine::GoldakHeatSource<3>>(beam_database)};
+
+  // The first box is centered on the plane, the second one is below it.
+  dealii::Point<3> const lower(0., 0.004, 0.);
+  std::vector<dealii::BoundingBox<3>> symmetric_boxes = {
+      dealii::BoundingBox<3>({lower, dealii::Point<3>(1e-3, 0.006, 1e-3)})};
+  std::vector<dealii::BoundingBox<3>> asymmetric_boxes = {
+      dealii::BoundingBox<3>({lower, dealii::Point<3>(1e-3, 0.005, 1e-3)})};
+
+  adamantine::check_symmetry_plane(geometry_database, symmetric_sources,
+                                   symmetric_boxes);
+  BOOST_CHECK_THROW(adamantine::check_symmetry_plane(
+                        geometry_database, asymmetric_sources, symmetric_boxes),
+                    std::runtime_error);
+  BOOST_CHECK_THROW(adamantine::check_symmetry_plane(
+                        geometry_database, symmetric_sources, asymmetric_boxes),
+                    std::runtime_error);
+
+  // Without symmetry plane, nothing is checked.
+  geometry_database.put("symmetry", false);
+  adamantine::check_symmetry_plane(geometry_database, asymmetric_sources,
+                                   asymmetric_boxes);
+}
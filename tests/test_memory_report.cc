@@ -0,0 +1,62 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#define BOOST_TEST_MODULE MemoryReport
+
+#include <MemoryReport.hh>
+
+#include <sstream>
+
+#include "main.cc"
+
+namespace utf = boost::unit_test;
+
+BOOST_AUTO_TEST_CASE(memory_report, *utf::tolerance(1e-12))
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+  unsigned int const rank =
+      dealii::Utilities::MPI::this_mpi_process(communicator);
+  unsigned int const n_procs =
+      dealii::Utilities::MPI::n_mpi_processes(communicator);
+
+  adamantine::MemoryReport memory_report(communicator);
+
+  // The memory of a subsystem added twice is accumulated.
+  memory_report.add("Triangulation", 1000 * (rank + 1));
+  memory_report.add("Temperature", 500);
+  memory_report.add("Temperature", 500);
+  std::stringstream first_report;
+  memory_report.print(first_report, "after refinement");
+  if (rank == 0)
+  {
+    BOOST_TEST(first_report.str().find("after refinement") !=
+               std::string::npos);
+    BOOST_TEST(first_report.str().find("Triangulation") <
+               first_report.str().find("Temperature"));
+    BOOST_TEST(first_report.str().find("Temperature") <
+               first_report.str().find("Total"));
+  }
+  else
+  {
+    BOOST_TEST(first_report.str().empty());
+  }
+
+  // The total memory used is smaller than in the first report on any number of
+  // processors (1510 < 1000 * n_procs + 1000), the high-water marks do not
+  // change except for the new subsystem.
+  memory_report.add("Triangulation", 10);
+  memory_report.add("MaterialProperty", 1500);
+  std::stringstream second_report;
+  memory_report.print(second_report, "after material deposition");
+
+  BOOST_TEST(memory_report.get_high_water_mark("Triangulation") ==
+             1000. * n_procs);
+  BOOST_TEST(memory_report.get_high_water_mark("Temperature") == 1000.);
+  BOOST_TEST(memory_report.get_high_water_mark("MaterialProperty") == 1500.);
+  BOOST_TEST(memory_report.get_high_water_mark("Total") ==
+             1000. * n_procs + 1000.);
+}
@@ -22,12 +22,12 @@ public:
   std::vector<ScanPathSegment> get_segment_format_list()
   {
     ScanPath scan_path("scan_path.txt", "segment");
-    return scan_path._segment_list;
+    return scan_path._segment_list.to_vector();
   };
   std::vector<ScanPathSegment> get_event_series_format_list()
   {
     ScanPath scan_path("scan_path_event_series.inp", "event_series");
-    return scan_path._segment_list;
+    return scan_path._segment_list.to_vector();
   };
 };
 
@@ -90,6 +90,10 @@ BOOST_AUTO_TEST_CASE(scan_path_location, *utf::tolerance(1e-10))
   BOOST_TEST(p2[0] == 8.0e-4);
   BOOST_TEST(p2[1] == 0.0);
   BOOST_TEST(p2[2] == 0.0);
+  dealii::Tensor<1, 3> velocity = scan_path.velocity(time);
+  BOOST_TEST(velocity[0] == 0.8);
+  BOOST_TEST(velocity[1] == 0.0);
+  BOOST_TEST(velocity[2] == 0.0);
 
   time = 100.0;
   dealii::Point<3> p3 = scan_path.value(time);
@@ -98,6 +102,8 @@ BOOST_AUTO_TEST_CASE(scan_path_location, *utf::tolerance(1e-10))
   BOOST_TEST(p3[2] == std::numeric_limits<double>::lowest());
   double power = scan_path.get_power_modifier(time);
   BOOST_TEST(power == 0.0);
+  velocity = scan_path.velocity(time);
+  BOOST_TEST(velocity.norm() == 0.0);
 }
 
 } // namespace adamantine
@@ -0,0 +1,87 @@
+/* Copyright (c) 2023, the adamantine authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#define BOOST_TEST_MODULE SharedMemoryArray
+
+#include <SharedMemoryArray.hh>
+
+#include <deal.II/base/point.h>
+
+#include <stdexcept>
+
+#include "main.cc"
+
+namespace utf = boost::unit_test;
+
+BOOST_AUTO_TEST_CASE(shared_memory_array, *utf::tolerance(1e-12))
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  // Count the number of processors that create the data.
+  unsigned int n_calls = 0;
+  adamantine::SharedMemoryArray<dealii::Point<3>> array(
+      communicator,
+      [&]()
+      {
+        ++n_calls;
+        std::vector<dealii::Point<3>> points;
+        for (unsigned int i = 0; i < 4; ++i)
+          points.emplace_back(i, 2. * i, 3. * i);
+        return points;
+      });
+
+  BOOST_TEST(array.size() == 4);
+  BOOST_TEST(!array.empty());
+  for (unsigned int i = 0; i < 4; ++i)
+  {
+    BOOST_TEST(array[i][0] == i);
+    BOOST_TEST(array[i][1] == 2. * i);
+    BOOST_TEST(array[i][2] == 3. * i);
+  }
+  BOOST_TEST(array.back()[2] == 9.);
+  BOOST_TEST(array.end() - array.begin() == 4);
+
+  // Only one processor per node creates and stores the data.
+  MPI_Comm node_communicator;
+  MPI_Comm_split_type(communicator, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL,
+                      &node_communicator);
+  BOOST_TEST(dealii::Utilities::MPI::sum(n_calls, node_communicator) == 1);
+  BOOST_TEST(dealii::Utilities::MPI::sum(array.memory_consumption(),
+                                         node_communicator) ==
+             4 * sizeof(dealii::Point<3>));
+  MPI_Comm_free(&node_communicator);
+
+  // Every processor reads the segment of the first processor of the node.
+  MPI_Aint segment_size = 0;
+  int displacement_unit = 0;
+  dealii::Point<3> *leader_data = nullptr;
+  MPI_Win_shared_query(array.get_window(), 0, &segment_size,
+                       &displacement_unit, &leader_data);
+  BOOST_TEST(static_cast<std::size_t>(segment_size) ==
+             4 * sizeof(dealii::Point<3>));
+  BOOST_TEST(static_cast<std::size_t>(displacement_unit) ==
+             sizeof(dealii::Point<3>));
+  BOOST_TEST(leader_data == array.data());
+  BOOST_TEST(leader_data[3][1] == 6.);
+
+  // Copies share the window of the first processor of the node.
+  adamantine::SharedMemoryArray<dealii::Point<3>> copy = array;
+  dealii::Point<3> *copy_leader_data = nullptr;
+  MPI_Win_shared_query(copy.get_window(), 0, &segment_size,
+                       &displacement_unit, &copy_leader_data);
+  BOOST_TEST(copy_leader_data == leader_data);
+  std::vector<dealii::Point<3>> points = copy.to_vector();
+  BOOST_TEST(points.size() == 4);
+  BOOST_TEST(points[1][1] == 2.);
+
+  // An exception thrown during the creation is thrown on every processor.
+  BOOST_CHECK_THROW(adamantine::SharedMemoryArray<double>(
+                        communicator,
+                        []() -> std::vector<double>
+                        { throw std::runtime_error("Error"); }),
+                    std::runtime_error);
+}
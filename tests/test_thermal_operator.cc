@@ -18,6 +18,7 @@
 #include <deal.II/fe/fe_q.h>
 #include <deal.II/fe/fe_values.h>
 #include <deal.II/fe/mapping_q1.h>
+#include <deal.II/hp/mapping_collection.h>
 #include <deal.II/lac/dynamic_sparsity_pattern.h>
 #include <deal.II/lac/sparse_matrix.h>
 #include <deal.II/matrix_free/fe_point_evaluation.h>
@@ -139,6 +140,153 @@ BOOST_AUTO_TEST_CASE(thermal_operator, *utf::tolerance(1e-15))
   dst_1 = 1.;
   thermal_operator.Tvmult_add(dst_1, src);
   BOOST_TEST(dst_1.l1_norm() == dst_2.l1_norm());
+
+  // Check the cell diagnostics. The temperature increases linearly along the
+  // length: the nodal values go from 0 K to 1200 K while the average
+  // temperatures of the four columns of cells are 150 K, 450 K, 750 K, and
+  // 1050 K. Only the last two columns are melted.
+  src = 0.;
+  std::map<dealii::types::global_dof_index, dealii::Point<2>> support_points;
+  dealii::DoFTools::map_dofs_to_support_points(
+      dealii::hp::MappingCollection<2>(dealii::MappingQ1<2>()), dof_handler,
+      support_points);
+  for (auto const &[dof, point] : support_points)
+    if (src.locally_owned_elements().is_element(dof))
+      src[dof] = 100. * point[0];
+  adamantine::CellDiagnostics<2> diagnostics(600.);
+  diagnostics.add("n_cells", adamantine::CellDiagnostics<2>::Reduction::sum,
+                  [](adamantine::CellDiagnostics<2>::CellValues const &)
+                  { return 1.; });
+  diagnostics.add("max_average_temperature",
+                  adamantine::CellDiagnostics<2>::Reduction::max,
+                  [](adamantine::CellDiagnostics<2>::CellValues const &values)
+                  { return values.average_temperature; });
+  thermal_operator.compute_cell_diagnostics(src, diagnostics);
+  BOOST_TEST(diagnostics.get("n_cells") == 20.);
+  BOOST_TEST(diagnostics.get("max_temperature") == 1200.,
+             tt::tolerance(1e-12));
+  BOOST_TEST(std::abs(diagnostics.get("min_temperature")) < 1e-10);
+  BOOST_TEST(diagnostics.get("max_average_temperature") == 1050.,
+             tt::tolerance(1e-12));
+  BOOST_TEST(diagnostics.get("activated_volume") == 72., tt::tolerance(1e-12));
+  BOOST_TEST(diagnostics.get("melt_pool_volume") == 36., tt::tolerance(1e-12));
+  auto const &melted_cells = diagnostics.get_melted_cells();
+  for (auto const &cell : dof_handler.active_cell_iterators())
+  {
+    if (cell->is_locally_owned())
+    {
+      BOOST_TEST(melted_cells[cell->active_cell_index()] ==
+                 (cell->center()[0] > 6.));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(refinement_indicator)
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  // Create the Geometry
+  boost::property_tree::ptree geometry_database;
+  geometry_database.put("import_mesh", false);
+  geometry_database.put("length", 12);
+  geometry_database.put("length_divisions", 4);
+  geometry_database.put("height", 6);
+  geometry_database.put("height_divisions", 5);
+  adamantine::Geometry<2> geometry(communicator, geometry_database);
+  // Create the DoFHandler
+  dealii::hp::FECollection<2> fe_collection;
+  fe_collection.push_back(dealii::FE_Q<2>(2));
+  fe_collection.push_back(dealii::FE_Nothing<2>());
+  dealii::DoFHandler<2> dof_handler(geometry.get_triangulation());
+  dof_handler.distribute_dofs(fe_collection);
+  dealii::AffineConstraints<double> affine_constraints;
+  affine_constraints.close();
+  dealii::hp::QCollection<1> q_collection;
+  q_collection.push_back(dealii::QGauss<1>(3));
+  q_collection.push_back(dealii::QGauss<1>(1));
+
+  // Create the MaterialProperty
+  boost::property_tree::ptree mat_prop_database;
+  mat_prop_database.put("property_format", "polynomial");
+  mat_prop_database.put("n_materials", 1);
+  mat_prop_database.put("material_0.solid.density", 1.);
+  mat_prop_database.put("material_0.powder.density", 1.);
+  mat_prop_database.put("material_0.liquid.density", 1.);
+  mat_prop_database.put("material_0.solid.specific_heat", 1.);
+  mat_prop_database.put("material_0.powder.specific_heat", 1.);
+  mat_prop_database.put("material_0.liquid.specific_heat", 1.);
+  mat_prop_database.put("material_0.solid.thermal_conductivity_x", 10.);
+  mat_prop_database.put("material_0.solid.thermal_conductivity_z", 10.);
+  mat_prop_database.put("material_0.powder.thermal_conductivity_x", 10.);
+  mat_prop_database.put("material_0.powder.thermal_conductivity_z", 10.);
+  mat_prop_database.put("material_0.liquid.thermal_conductivity_x", 10.);
+  mat_prop_database.put("material_0.liquid.thermal_conductivity_z", 10.);
+  adamantine::MaterialProperty<2, dealii::MemorySpace::Host> mat_properties(
+      communicator, geometry.get_triangulation(), mat_prop_database);
+
+  std::vector<std::shared_ptr<adamantine::HeatSource<2>>> heat_sources;
+
+  // The gradients on the inner faces are only computed when the indicator is
+  // enabled.
+  adamantine::ThermalOperator<2, 2, dealii::MemorySpace::Host>
+      default_operator(communicator, adamantine::BoundaryType::adiabatic,
+                       mat_properties, heat_sources);
+  default_operator.reinit(dof_handler, affine_constraints, q_collection);
+  adamantine::ThermalOperator<2, 2, dealii::MemorySpace::Host> thermal_operator(
+      communicator, adamantine::BoundaryType::adiabatic, mat_properties,
+      heat_sources, true);
+  thermal_operator.reinit(dof_handler, affine_constraints, q_collection);
+
+  // The temperature is T = 300 + 100 |x - 6|. The normal derivative only jumps
+  // across the faces at x = 6 where it goes from -100 to 100. The indicator of
+  // the two cells sharing such a face is sqrt(h / 24 * 200^2 * h) with h = 1.2
+  // the length of the face.
+  dealii::LA::distributed::Vector<double, dealii::MemorySpace::Host>
+      temperature;
+  thermal_operator.get_matrix_free().initialize_dof_vector(temperature);
+  std::map<dealii::types::global_dof_index, dealii::Point<2>> support_points;
+  dealii::DoFTools::map_dofs_to_support_points(
+      dealii::hp::MappingCollection<2>(dealii::MappingQ1<2>()), dof_handler,
+      support_points);
+  for (auto const &[dof, point] : support_points)
+    if (temperature.locally_owned_elements().is_element(dof))
+      temperature[dof] = 300. + 100. * std::abs(point[0] - 6.);
+
+  BOOST_CHECK_THROW(default_operator.compute_refinement_indicator(temperature,
+                                                                  0.),
+                    std::runtime_error);
+
+  double const expected_indicator = std::sqrt(1.2 / 24. * 200. * 200. * 1.2);
+  auto indicator = thermal_operator.compute_refinement_indicator(temperature,
+                                                                 0.);
+  for (auto const &cell : dof_handler.active_cell_iterators())
+  {
+    if (cell->is_locally_owned())
+    {
+      double const value = indicator[cell->active_cell_index()];
+      if (std::abs(cell->center()[0] - 6.) < 2.)
+        BOOST_TEST(value == expected_indicator, tt::tolerance(1e-5));
+      else
+        BOOST_TEST(std::abs(value) < 1e-3);
+    }
+  }
+
+  // The faces at x = 6 are colder than the minimum temperature: they are
+  // skipped and the indicator vanishes.
+  indicator = thermal_operator.compute_refinement_indicator(temperature, 400.);
+  for (auto const &cell : dof_handler.active_cell_iterators())
+    if (cell->is_locally_owned())
+      BOOST_TEST(std::abs(indicator[cell->active_cell_index()]) < 1e-3);
+
+  // The normal derivative of a linear temperature T = 300 + 100 x is
+  // continuous across every face and the indicator vanishes everywhere.
+  for (auto const &[dof, point] : support_points)
+    if (temperature.locally_owned_elements().is_element(dof))
+      temperature[dof] = 300. + 100. * point[0];
+  indicator = thermal_operator.compute_refinement_indicator(temperature, 0.);
+  for (auto const &cell : dof_handler.active_cell_iterators())
+    if (cell->is_locally_owned())
+      BOOST_TEST(std::abs(indicator[cell->active_cell_index()]) < 1e-3);
 }
 
 BOOST_AUTO_TEST_CASE(spmv, *utf::tolerance(1e-12))
@@ -896,3 +1044,113 @@ BOOST_AUTO_TEST_CASE(spmv_conv, *utf::tolerance(1e-12))
     BOOST_TEST(dst_1 == dst_2, tt::per_element());
   }
 }
+
+BOOST_AUTO_TEST_CASE(symmetry_plane, *utf::tolerance(1e-12))
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  // Create the Geometry. Only the half of the domain below y = 2 is meshed.
+  boost::property_tree::ptree geometry_database;
+  geometry_database.put("import_mesh", false);
+  geometry_database.put("length", 4);
+  geometry_database.put("length_divisions", 2);
+  geometry_database.put("height", 2);
+  geometry_database.put("height_divisions", 2);
+  geometry_database.put("width", 4);
+  geometry_database.put("width_divisions", 2);
+  geometry_database.put("symmetry", true);
+  adamantine::Geometry<3> geometry(communicator, geometry_database);
+  // Create the DoFHandler
+  dealii::hp::FECollection<3> fe_collection;
+  fe_collection.push_back(dealii::FE_Q<3>(2));
+  fe_collection.push_back(dealii::FE_Nothing<3>());
+  dealii::DoFHandler<3> dof_handler(geometry.get_triangulation());
+  dof_handler.distribute_dofs(fe_collection);
+  dealii::AffineConstraints<double> affine_constraints;
+  affine_constraints.close();
+  dealii::hp::QCollection<1> q_collection;
+  q_collection.push_back(dealii::QGauss<1>(3));
+  q_collection.push_back(dealii::QGauss<1>(1));
+
+  // Create the MaterialProperty
+  boost::property_tree::ptree mat_prop_database;
+  mat_prop_database.put("property_format", "polynomial");
+  mat_prop_database.put("n_materials", 1);
+  for (std::string state : {"solid", "powder", "liquid"})
+  {
+    mat_prop_database.put("material_0." + state + ".density", 1.);
+    mat_prop_database.put("material_0." + state + ".specific_heat", 1.);
+    mat_prop_database.put("material_0." + state + ".thermal_conductivity_x",
+                          1.);
+    mat_prop_database.put("material_0." + state + ".thermal_conductivity_y",
+                          1.);
+    mat_prop_database.put("material_0." + state + ".thermal_conductivity_z",
+                          1.);
+    mat_prop_database.put(
+        "material_0." + state + ".convection_heat_transfer_coef", 1.);
+  }
+  mat_prop_database.put("material_0.convection_temperature_infty", 0.0);
+  adamantine::MaterialProperty<3, dealii::MemorySpace::Host> mat_properties(
+      communicator, geometry.get_triangulation(), mat_prop_database);
+
+  // Apply the convective operator with and without the symmetry plane to a
+  // constant temperature. Only the boundary terms are non-zero.
+  std::vector<std::shared_ptr<adamantine::HeatSource<3>>> heat_sources;
+  auto apply = [&](adamantine::BoundaryType const boundary_type)
+  {
+    adamantine::ThermalOperator<3, 2, dealii::MemorySpace::Host>
+        thermal_operator(communicator, boundary_type, mat_properties,
+                         heat_sources);
+    std::vector<double> deposition_cos(
+        geometry.get_triangulation().n_locally_owned_active_cells(), 1.);
+    std::vector<double> deposition_sin(
+        geometry.get_triangulation().n_locally_owned_active_cells(), 0.);
+    thermal_operator.reinit(dof_handler, affine_constraints, q_collection);
+    thermal_operator.set_material_deposition_orientation(deposition_cos,
+                                                         deposition_sin);
+    thermal_operator.compute_inverse_mass_matrix(dof_handler,
+                                                 affine_constraints);
+    thermal_operator.get_state_from_material_properties();
+
+    dealii::LA::distributed::Vector<double, dealii::MemorySpace::Host> src;
+    dealii::LA::distributed::Vector<double, dealii::MemorySpace::Host> dst;
+    thermal_operator.get_matrix_free().initialize_dof_vector(src);
+    thermal_operator.get_matrix_free().initialize_dof_vector(dst);
+    src = 1.;
+    thermal_operator.vmult(dst, src);
+
+    return dst;
+  };
+  auto const convective = apply(adamantine::BoundaryType::convective);
+  auto const symmetry = apply(adamantine::BoundaryType::convective |
+                              adamantine::BoundaryType::symmetry);
+
+  // The dofs on the symmetry plane that are not on another boundary do not
+  // see any flux with the symmetry plane. The other dofs are not affected. The
+  // plane has 3 x 3 such dofs.
+  std::map<dealii::types::global_dof_index, dealii::Point<3>> support_points;
+  dealii::DoFTools::map_dofs_to_support_points(
+      dealii::hp::MappingCollection<3>(dealii::MappingQ1<3>()), dof_handler,
+      support_points);
+  unsigned int n_plane_dofs = 0;
+  for (auto const &[dof, point] : support_points)
+  {
+    if (!convective.locally_owned_elements().is_element(dof))
+      continue;
+    bool const on_plane = std::abs(point[1] - 2.) < 1e-12;
+    bool const on_other_boundary =
+        (point[0] < 1e-12) || (point[0] > 4. - 1e-12) || (point[1] < 1e-12) ||
+        (point[2] < 1e-12) || (point[2] > 2. - 1e-12);
+    if (on_plane && !on_other_boundary)
+    {
+      BOOST_TEST(std::abs(convective[dof]) > 1e-6);
+      BOOST_TEST(std::abs(symmetry[dof]) < 1e-12);
+      ++n_plane_dofs;
+    }
+    else if (!on_plane)
+    {
+      BOOST_TEST(symmetry[dof] == convective[dof]);
+    }
+  }
+  BOOST_TEST(dealii::Utilities::MPI::sum(n_plane_dofs, communicator) == 9);
+}
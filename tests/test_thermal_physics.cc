@@ -1,4 +1,4 @@
-/* Copyright (c) 2016 - 2021, the adamantine authors.
+/* Copyright (c) 2016 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -71,3 +71,38 @@ BOOST_AUTO_TEST_CASE(reference_temperature_host)
 {
   reference_temperature<dealii::MemorySpace::Host>();
 }
+
+BOOST_AUTO_TEST_CASE(cell_diagnostics_host)
+{
+  cell_diagnostics<dealii::MemorySpace::Host>();
+}
+
+BOOST_AUTO_TEST_CASE(two_scale_time_stepping_host)
+{
+  two_scale_time_stepping<dealii::MemorySpace::Host>();
+}
+
+BOOST_AUTO_TEST_CASE(two_scale_time_stepping_window_host)
+{
+  two_scale_time_stepping_window<dealii::MemorySpace::Host>();
+}
+
+BOOST_AUTO_TEST_CASE(time_averaged_source_host)
+{
+  time_averaged_source<dealii::MemorySpace::Host>();
+}
+
+BOOST_AUTO_TEST_CASE(condensation_host)
+{
+  condensation<dealii::MemorySpace::Host>();
+}
+
+BOOST_AUTO_TEST_CASE(far_field_bcs_host)
+{
+  far_field_bcs<dealii::MemorySpace::Host>();
+}
+
+BOOST_AUTO_TEST_CASE(quasi_steady_state_host)
+{
+  quasi_steady_state<dealii::MemorySpace::Host>();
+}
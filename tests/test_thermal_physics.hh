@@ -1,4 +1,4 @@
-/* Copyright (c) 2016 - 2022, the adamantine authors.
+/* Copyright (c) 2016 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -11,6 +11,9 @@
 #include <Timer.hh>
 
 #include <deal.II/base/quadrature_lib.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/fe/mapping_q1.h>
+#include <deal.II/hp/mapping_collection.h>
 
 namespace tt = boost::test_tools;
 
@@ -662,3 +665,485 @@ void reference_temperature()
   for (auto indicator : has_melted)
     BOOST_CHECK(indicator == true);
 }
+
+template <typename MemorySpaceType>
+void cell_diagnostics()
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  // Build Geometry
+  auto geometry_database = basic_geometry_database();
+  geometry_database.put("length_divisions", 4);
+  geometry_database.put("height_divisions", 5);
+  adamantine::Geometry<2> geometry(communicator, geometry_database);
+
+  // Build MaterialProperty
+  auto material_property_database = basic_material_properies_database();
+  adamantine::MaterialProperty<2, MemorySpaceType> material_properties(
+      communicator, geometry.get_triangulation(), material_property_database);
+
+  auto database = basic_input_database();
+  auto build_physics = [&]()
+  {
+    auto physics = std::make_unique<
+        adamantine::ThermalPhysics<2, 2, MemorySpaceType, dealii::QGauss<1>>>(
+        communicator, database, geometry, material_properties);
+    physics->setup_dofs();
+    physics->update_material_deposition_orientation();
+    physics->compute_inverse_mass_matrix();
+    physics->get_state_from_material_properties();
+    return physics;
+  };
+  auto diagnostics_physics = build_physics();
+  auto reference_physics = build_physics();
+
+  // The temperature increases linearly from 0 K to 2000 K along the length.
+  // The average temperature of the cells of the four columns are 250 K,
+  // 750 K, 1250 K, and 1750 K.
+  dealii::LA::distributed::Vector<double, MemorySpaceType> solution;
+  diagnostics_physics->initialize_dof_vector(0., solution);
+  std::map<dealii::types::global_dof_index, dealii::Point<2>> support_points;
+  dealii::DoFTools::map_dofs_to_support_points(
+      dealii::hp::MappingCollection<2>(dealii::MappingQ1<2>()),
+      diagnostics_physics->get_dof_handler(), support_points);
+  for (auto const &[dof, point] : support_points)
+    if (solution.locally_owned_elements().is_element(dof))
+      solution[dof] = 2000. * point[0] / 12e-3;
+
+  // Only the last column melts.
+  double const melting_temperature = 1500.;
+  adamantine::CellDiagnostics<2> diagnostics(melting_temperature);
+  diagnostics_physics->compute_cell_diagnostics(solution, diagnostics);
+  reference_physics->mark_has_melted(melting_temperature, solution);
+  BOOST_TEST(diagnostics.get("melt_pool_volume") == 3e-3 * 6e-3,
+             tt::tolerance(1e-10));
+
+  auto const has_melted = diagnostics_physics->get_has_melted_vector();
+  auto const reference_has_melted = reference_physics->get_has_melted_vector();
+  BOOST_CHECK(has_melted == reference_has_melted);
+  unsigned int n_melted_cells = 0;
+  for (bool const melted : has_melted)
+    if (melted)
+      ++n_melted_cells;
+  BOOST_TEST(dealii::Utilities::MPI::sum(n_melted_cells, communicator) == 5);
+}
+
+template <typename MemorySpaceType>
+void two_scale_time_stepping()
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  // Build Geometry
+  auto geometry_database = basic_geometry_database();
+  geometry_database.put("length_divisions", 4);
+  geometry_database.put("height_divisions", 5);
+  adamantine::Geometry<2> geometry(communicator, geometry_database);
+
+  // Build MaterialProperty
+  auto material_property_database = basic_material_properies_database();
+  adamantine::MaterialProperty<2, MemorySpaceType> material_properties(
+      communicator, geometry.get_triangulation(), material_property_database);
+
+  auto evolve = [&](boost::property_tree::ptree const &database,
+                    double const time_step)
+  {
+    adamantine::ThermalPhysics<2, 2, MemorySpaceType, dealii::QGauss<1>>
+        physics(communicator, database, geometry, material_properties);
+    physics.setup_dofs();
+    physics.update_material_deposition_orientation();
+    physics.compute_inverse_mass_matrix();
+
+    dealii::LA::distributed::Vector<double, MemorySpaceType> solution;
+    physics.initialize_dof_vector(solution);
+    physics.get_state_from_material_properties();
+    std::vector<adamantine::Timer> timers(adamantine::Timing::n_timers);
+    double time = 0;
+    while (time < 0.1)
+      time = physics.evolve_one_time_step(time, time_step, solution, timers);
+
+    return solution;
+  };
+
+  auto database = basic_input_database();
+  database.put("time_stepping.method", "forward_euler");
+  auto reference = evolve(database, 0.025);
+
+  // The window contains the whole domain so the two-scale time stepping is
+  // equivalent to using the sub-step everywhere.
+  database.put("time_stepping.two_scale.n_sub_steps", 2);
+  database.put("time_stepping.two_scale.window_margin", 1.);
+  auto solution = evolve(database, 0.05);
+
+  BOOST_TEST(solution.l2_norm() > 0.);
+  reference -= solution;
+  BOOST_TEST(reference.l2_norm() <= 1e-12 * solution.l2_norm());
+}
+
+template <typename MemorySpaceType>
+void two_scale_time_stepping_window()
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  // Build Geometry
+  auto geometry_database = basic_geometry_database();
+  geometry_database.put("length_divisions", 12);
+  geometry_database.put("height_divisions", 6);
+  adamantine::Geometry<2> geometry(communicator, geometry_database);
+
+  // Build MaterialProperty. The conductivity is small enough for the coarse
+  // time step to be stable.
+  auto material_property_database = basic_material_properies_database();
+  for (std::string state : {"solid", "powder", "liquid"})
+  {
+    material_property_database.put(
+        "material_0." + state + ".thermal_conductivity_x", 5e-6);
+    material_property_database.put(
+        "material_0." + state + ".thermal_conductivity_z", 5e-6);
+  }
+  adamantine::MaterialProperty<2, MemorySpaceType> material_properties(
+      communicator, geometry.get_triangulation(), material_property_database);
+
+  auto evolve = [&](boost::property_tree::ptree const &database,
+                    double const time_step)
+  {
+    adamantine::ThermalPhysics<2, 2, MemorySpaceType, dealii::QGauss<1>>
+        physics(communicator, database, geometry, material_properties);
+    physics.setup_dofs();
+    physics.update_material_deposition_orientation();
+    physics.compute_inverse_mass_matrix();
+
+    dealii::LA::distributed::Vector<double, MemorySpaceType> solution;
+    physics.initialize_dof_vector(0., solution);
+    physics.get_state_from_material_properties();
+    std::vector<adamantine::Timer> timers(adamantine::Timing::n_timers);
+    double time = 0;
+    while (time < 0.02 - 1e-12)
+      time = physics.evolve_one_time_step(time, time_step, solution, timers);
+
+    return solution;
+  };
+
+  // The beam moves along the top of the domain, starting in a corner.
+  auto database = basic_input_database();
+  database.put("sources.beam_0.depth", 3e-3);
+  database.put("sources.beam_0.diameter", 3e-3);
+  database.put("sources.beam_0.max_power", 1.);
+  database.put("sources.beam_0.scan_path_file",
+               "scan_path_time_averaging.txt");
+  database.put("time_stepping.method", "forward_euler");
+  double const coarse_time_step = 1e-3;
+  unsigned int const n_sub_steps = 4;
+  auto const reference = evolve(database, coarse_time_step / n_sub_steps);
+  auto const coarse = evolve(database, coarse_time_step);
+
+  // The window only covers the cells close to the corner where the beam is.
+  // The rest of the domain uses the coarse time step and the window uses the
+  // linear interpolation of the coarse solution as boundary condition.
+  database.put("time_stepping.two_scale.n_sub_steps", n_sub_steps);
+  database.put("time_stepping.two_scale.window_margin", 1e-3);
+  auto const solution = evolve(database, coarse_time_step);
+
+  double const norm = reference.l2_norm();
+  BOOST_TEST(norm > 0.);
+  // The two-scale solution is close to the fine solution.
+  auto error = reference;
+  error -= solution;
+  BOOST_TEST(error.l2_norm() <= 5e-2 * norm);
+  // It is neither the fine solution, since the coarse time step is used
+  // outside of the window, nor the coarse solution.
+  BOOST_TEST(error.l2_norm() > 1e-10 * norm);
+  auto coarse_difference = coarse;
+  coarse_difference -= solution;
+  BOOST_TEST(coarse_difference.l2_norm() > 1e-10 * norm);
+}
+
+template <typename MemorySpaceType>
+void time_averaged_source()
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  // Build Geometry
+  auto geometry_database = basic_geometry_database();
+  geometry_database.put("length_divisions", 4);
+  geometry_database.put("height_divisions", 5);
+  adamantine::Geometry<2> geometry(communicator, geometry_database);
+
+  // Build MaterialProperty
+  auto material_property_database = basic_material_properies_database();
+  adamantine::MaterialProperty<2, MemorySpaceType> material_properties(
+      communicator, geometry.get_triangulation(), material_property_database);
+
+  // The beam moves along the top of the domain. The problem is linear.
+  auto database = basic_input_database();
+  database.put("sources.beam_0.depth", 3e-3);
+  database.put("sources.beam_0.diameter", 3e-3);
+  database.put("sources.beam_0.max_power", 1.);
+  database.put("sources.beam_0.scan_path_file",
+               "scan_path_time_averaging.txt");
+  database.put("time_stepping.method", "backward_euler");
+  database.put("time_stepping.max_iteration", 100);
+  database.put("time_stepping.tolerance", 1e-12);
+  database.put("time_stepping.n_tmp_vectors", 100);
+
+  // Perform one implicit time step from a zero temperature.
+  auto evolve = [&](boost::property_tree::ptree const &database,
+                    double const time, double const time_step)
+  {
+    adamantine::ThermalPhysics<2, 2, MemorySpaceType, dealii::QGauss<1>>
+        physics(communicator, database, geometry, material_properties);
+    physics.setup_dofs();
+    physics.update_material_deposition_orientation();
+    physics.compute_inverse_mass_matrix();
+
+    dealii::LA::distributed::Vector<double, MemorySpaceType> solution;
+    physics.initialize_dof_vector(0., solution);
+    physics.get_state_from_material_properties();
+    std::vector<adamantine::Timer> timers(adamantine::Timing::n_timers);
+    physics.evolve_one_time_step(time, time_step, solution, timers);
+
+    return solution;
+  };
+
+  // Backward Euler evaluates the source at the end of the step. Since the
+  // problem is linear, a step with the source averaged over [t, t + dt] is
+  // the mean of the steps whose source is evaluated at the sample times.
+  double const time = 0.2;
+  double const time_step = 0.2;
+  unsigned int const n_samples = 4;
+  auto const instantaneous = evolve(database, time, time_step);
+  auto reference = instantaneous;
+  reference = 0.;
+  for (unsigned int i = 0; i < n_samples; ++i)
+  {
+    double const sample_time = time + (i + 0.5) * time_step / n_samples;
+    reference.add(1. / n_samples,
+                  evolve(database, sample_time - time_step, time_step));
+  }
+
+  database.put("sources.beam_0.time_averaging_samples", n_samples);
+  auto solution = evolve(database, time, time_step);
+
+  BOOST_TEST(solution.l2_norm() > 0.);
+  // The average differs from the source at the end of the step.
+  auto difference = instantaneous;
+  difference -= solution;
+  BOOST_TEST(difference.l2_norm() > 1e-3 * solution.l2_norm());
+  reference -= solution;
+  BOOST_TEST(reference.l2_norm() <= 1e-8 * solution.l2_norm());
+}
+
+template <typename MemorySpaceType>
+void condensation()
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  // Build Geometry. The cells are 1e-3 high.
+  auto geometry_database = basic_geometry_database();
+  geometry_database.put("length_divisions", 2);
+  geometry_database.put("height_divisions", 6);
+  adamantine::Geometry<2> geometry(communicator, geometry_database);
+
+  // Build MaterialProperty
+  auto material_property_database = basic_material_properies_database();
+  adamantine::MaterialProperty<2, MemorySpaceType> material_properties(
+      communicator, geometry.get_triangulation(), material_property_database);
+
+  // The beam is turned off and it is at the top of the domain.
+  auto database = basic_input_database();
+  database.put("sources.beam_0.scan_path_file", "scan_path_condensation.txt");
+  database.put("refinement.condensation.depth", 2.5e-3);
+  database.put("refinement.condensation.temperature", 1000.);
+  database.put("refinement.condensation.thermal_conductivity", 1.);
+
+  adamantine::ThermalPhysics<2, 2, MemorySpaceType, dealii::QGauss<1>> physics(
+      communicator, database, geometry, material_properties);
+  physics.setup_dofs();
+  physics.update_material_deposition_orientation();
+  physics.compute_inverse_mass_matrix();
+
+  dealii::LA::distributed::Vector<double, MemorySpaceType> solution;
+  physics.initialize_dof_vector(300., solution);
+  physics.get_state_from_material_properties();
+  std::vector<adamantine::Timer> timers(adamantine::Timing::n_timers);
+
+  // The three bottom rows of cells are condensed.
+  BOOST_TEST(physics.condense_cooled_material(0., solution, timers));
+  unsigned int n_active_cells = 0;
+  for (auto const &cell : physics.get_dof_handler().active_cell_iterators())
+    if (cell->is_locally_owned() && (cell->active_fe_index() == 0))
+      ++n_active_cells;
+  BOOST_TEST(dealii::Utilities::MPI::sum(n_active_cells, communicator) == 6);
+  BOOST_TEST(!physics.condense_cooled_material(0., solution, timers));
+
+  // The condensed material has the same temperature as the part so the
+  // temperature does not change.
+  double time = 0.;
+  for (unsigned int i = 0; i < 10; ++i)
+    time = physics.evolve_one_time_step(time, 1e-8, solution, timers);
+  for (unsigned int i = 0; i < solution.locally_owned_size(); ++i)
+    BOOST_TEST(solution.local_element(i) == 300., tt::tolerance(1e-12));
+
+  // The part is hotter than the condensed material so it cools down.
+  physics.initialize_dof_vector(400., solution);
+  for (unsigned int i = 0; i < 10; ++i)
+    time = physics.evolve_one_time_step(time, 1e-8, solution, timers);
+  double min_temperature = 400.;
+  for (unsigned int i = 0; i < solution.locally_owned_size(); ++i)
+  {
+    BOOST_TEST(solution.local_element(i) <= 400. + 1e-10);
+    min_temperature = std::min(min_temperature, solution.local_element(i));
+  }
+  BOOST_TEST(dealii::Utilities::MPI::min(min_temperature, communicator) < 400.);
+}
+
+template <typename MemorySpaceType>
+void far_field_bcs()
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  // Build Geometry
+  auto geometry_database = basic_geometry_database();
+  geometry_database.put("length", 5);
+  geometry_database.put("length_divisions", 5);
+  geometry_database.put("height", 5);
+  geometry_database.put("height_divisions", 5);
+  adamantine::Geometry<2> geometry(communicator, geometry_database);
+
+  // Build MaterialProperty
+  auto material_property_database = basic_material_properies_database();
+  adamantine::MaterialProperty<2, MemorySpaceType> material_properties(
+      communicator, geometry.get_triangulation(), material_property_database);
+
+  boost::property_tree::ptree database;
+  database.put("sources.n_beams", 0);
+  database.put("time_stepping.method", "forward_euler");
+  // The far-field condition is only used on the bottom half of the boundary.
+  // The rest of the boundary is adiabatic.
+  database.put("boundary.type", "far_field");
+  database.put("boundary.far_field_height", 2.5);
+  database.put("boundary.far_field_temperature", 20.);
+  database.put("boundary.far_field_time_offset", 0.1);
+  adamantine::ThermalPhysics<2, 2, MemorySpaceType, dealii::QGauss<1>> physics(
+      communicator, database, geometry, material_properties);
+  physics.setup_dofs();
+  physics.update_material_deposition_orientation();
+  physics.compute_inverse_mass_matrix();
+
+  dealii::LA::distributed::Vector<double, MemorySpaceType> solution;
+  physics.initialize_dof_vector(10., solution);
+  physics.get_state_from_material_properties();
+  std::vector<adamantine::Timer> timers(adamantine::Timing::n_timers);
+  double time = 0;
+  while (time < 10)
+    time = physics.evolve_one_time_step(time, 0.005, solution, timers);
+
+  // The part is heated by the substrate and the bottom of the part is hotter
+  // than the top.
+  double min = 1e4;
+  double max = -1;
+  for (unsigned int i = 0; i < solution.locally_owned_size(); ++i)
+  {
+    min = std::min(min, solution.local_element(i));
+    max = std::max(max, solution.local_element(i));
+  }
+  BOOST_TEST(min >= 10.);
+  BOOST_TEST(max > 10.);
+  BOOST_TEST(max <= 20.);
+  double bottom_temperature = 0.;
+  double top_temperature = 0.;
+  solution.update_ghost_values();
+  for (auto const &cell : physics.get_dof_handler().active_cell_iterators())
+  {
+    if (!cell->is_locally_owned())
+      continue;
+    dealii::Vector<double> cell_values(cell->get_fe().n_dofs_per_cell());
+    cell->get_dof_values(solution, cell_values);
+    double const cell_temperature = cell_values.mean_value();
+    if (cell->center()[1] < 1.)
+      bottom_temperature += cell_temperature;
+    else if (cell->center()[1] > 4.)
+      top_temperature += cell_temperature;
+  }
+  BOOST_TEST(dealii::Utilities::MPI::sum(bottom_temperature, communicator) >
+             dealii::Utilities::MPI::sum(top_temperature, communicator));
+}
+
+template <typename MemorySpaceType>
+void quasi_steady_state()
+{
+  MPI_Comm communicator = MPI_COMM_WORLD;
+
+  // Build Geometry
+  auto geometry_database = basic_geometry_database();
+  geometry_database.put("length", 10);
+  geometry_database.put("length_divisions", 20);
+  geometry_database.put("height", 2);
+  geometry_database.put("height_divisions", 4);
+  adamantine::Geometry<2> geometry(communicator, geometry_database);
+
+  // Build MaterialProperty
+  auto material_property_database = basic_material_properies_database();
+  adamantine::MaterialProperty<2, MemorySpaceType> material_properties(
+      communicator, geometry.get_triangulation(), material_property_database);
+
+  // The beam moves along the x axis at unit speed.
+  auto database = basic_input_database();
+  database.put("sources.beam_0.type", "goldak");
+  database.put("sources.beam_0.depth", 1.);
+  database.put("sources.beam_0.diameter", 1.);
+  database.put("sources.beam_0.max_power", 10.);
+  database.put("sources.beam_0.absorption_efficiency", 1.);
+  database.put("sources.beam_0.scan_path_file", "scan_path_quasi_steady.txt");
+  adamantine::ThermalPhysics<2, 2, MemorySpaceType, dealii::QGauss<1>> physics(
+      communicator, database, geometry, material_properties);
+  physics.setup_dofs();
+  physics.update_material_deposition_orientation();
+  physics.compute_inverse_mass_matrix();
+
+  dealii::LA::distributed::Vector<double, MemorySpaceType> solution;
+  physics.initialize_dof_vector(0., solution);
+  physics.get_state_from_material_properties();
+  std::vector<adamantine::Timer> timers(adamantine::Timing::n_timers);
+
+  // The beam is at x = 5.
+  unsigned int const n_newton_iterations =
+      physics.solve_quasi_steady_state(5., solution, timers);
+  BOOST_TEST(n_newton_iterations > 0u);
+  BOOST_TEST(n_newton_iterations < 20u);
+
+  // The material enters the frame at x = 10 where the temperature is fixed.
+  // The material is heated when it passes under the beam so the temperature
+  // behind the beam is higher than in front of it.
+  double back_temperature = 0.;
+  double front_temperature = 0.;
+  solution.update_ghost_values();
+  for (auto const &cell : physics.get_dof_handler().active_cell_iterators())
+  {
+    if (!cell->is_locally_owned())
+      continue;
+    dealii::Vector<double> cell_values(cell->get_fe().n_dofs_per_cell());
+    cell->get_dof_values(solution, cell_values);
+    if (cell->center()[0] < 5.)
+      back_temperature += cell_values.mean_value();
+    else
+      front_temperature += cell_values.mean_value();
+    for (auto const f : cell->face_indices())
+    {
+      if (cell->face(f)->at_boundary() && (cell->face(f)->center()[0] > 9.99))
+      {
+        std::vector<dealii::types::global_dof_index> face_dof_indices(
+            cell->get_fe().n_dofs_per_face());
+        cell->face(f)->get_dof_indices(face_dof_indices,
+                                       cell->active_fe_index());
+        for (auto const dof : face_dof_indices)
+          BOOST_TEST(solution(dof) == 0.);
+      }
+    }
+  }
+  back_temperature =
+      dealii::Utilities::MPI::sum(back_temperature, communicator);
+  front_temperature =
+      dealii::Utilities::MPI::sum(front_temperature, communicator);
+  BOOST_TEST(front_temperature > 0.);
+  BOOST_TEST(back_temperature > front_temperature);
+}
@@ -1,4 +1,4 @@
-/* Copyright (c) 2021, the adamantine authors.
+/* Copyright (c) 2021 - 2023, the adamantine authors.
  *
  * This file is subject to the Modified BSD License and may not be distributed
  * without copyright and license information. Please refer to the file LICENSE
@@ -119,6 +119,15 @@ BOOST_AUTO_TEST_CASE(expected_failures)
   database.get_child("boundary").erase("type");
   database.put("boundary.type", "adiabatic");
 
+  // Check 1: Invalid far-field time offset
+  database.get_child("boundary").erase("type");
+  database.put("boundary.type", "convective,far_field");
+  database.put("boundary.far_field_time_offset", 0.);
+  BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
+  database.get_child("boundary").erase("far_field_time_offset");
+  database.get_child("boundary").erase("type");
+  database.put("boundary.type", "adiabatic");
+
   // Check 2: Invalid fe degree
   database.get_child("discretization").erase("thermal.fe_degree");
   database.put("discretization.thermal.fe_degree", 11);
@@ -207,6 +216,11 @@ BOOST_AUTO_TEST_CASE(expected_failures)
   BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
   database.put("geometry.width", 10.0);
 
+  // Check 9: Symmetry plane with the mechanical simulation
+  database.put("geometry.symmetry", true);
+  BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
+  database.get_child("geometry").erase("symmetry");
+
   // Check 10: 'n_materials' missing
   database.get_child("materials").erase("n_materials");
   BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
@@ -366,6 +380,41 @@ BOOST_AUTO_TEST_CASE(expected_failures)
   BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
   database.put("refinement.n_heat_refinements", 0);
 
+  // Check 19: Refinement lookahead smaller than the beam travel distance
+  database.put("refinement.beam_travel_distance", 1e-3);
+  database.put("refinement.lookahead_distance", 5e-4);
+  BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
+  database.put("refinement.beam_travel_distance", -1e-3);
+  database.get_child("refinement").erase("lookahead_distance");
+  BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
+  database.get_child("refinement").erase("beam_travel_distance");
+
+  // Check 19: Progressive coarsening without layer thickness
+  database.put("refinement.progressive_coarsening.temperature", 500.);
+  BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
+  database.get_child("refinement").erase("progressive_coarsening");
+
+  // Check 19: Condensation without thermal conductivity
+  database.put("refinement.condensation.depth", 1e-3);
+  database.put("refinement.condensation.temperature", 500.);
+  BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
+  database.get_child("refinement").erase("condensation");
+
+  // Check 19: Condensation with the mechanical physics
+  database.put("refinement.condensation.depth", 1e-3);
+  database.put("refinement.condensation.temperature", 500.);
+  database.put("refinement.condensation.thermal_conductivity", 10.);
+  BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
+  database.put("physics.mechanical", false);
+  validate_input_database(database);
+  database.put("physics.mechanical", true);
+  database.get_child("refinement").erase("condensation");
+
+  // Check 19: Invalid error estimator
+  database.put("refinement.error_estimator", "gradient");
+  BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
+  database.get_child("refinement").erase("error_estimator");
+
   // Check 20: Missing 'n_beams'
   database.get_child("sources").erase("n_beams");
   BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
@@ -411,6 +460,12 @@ BOOST_AUTO_TEST_CASE(expected_failures)
   BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
   database.put("sources.beam_0.absorption_efficiency", 0.1);
 
+  // Check 24: Invalid number of time averaging samples
+  database.put("sources.beam_0.time_averaging_samples", 0);
+  BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
+  database.get_child("sources").get_child("beam_0").erase(
+      "time_averaging_samples");
+
   // Check 25: Missing time stepping method
   database.get_child("time_stepping").erase("method");
   BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
@@ -422,6 +477,27 @@ BOOST_AUTO_TEST_CASE(expected_failures)
   BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
   database.put("time_stepping.method", "forward_euler");
 
+  // Check 26: Two-scale time stepping without window margin
+  database.put("time_stepping.two_scale.n_sub_steps", 4);
+  BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
+  database.put("time_stepping.two_scale.window_margin", 1e-3);
+
+  // Check 26: Two-scale time stepping with an embedded method
+  database.put("time_stepping.method", "dopri");
+  BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
+  database.put("time_stepping.method", "forward_euler");
+  database.get_child("time_stepping").erase("two_scale");
+
+  // Check 26: Cooldown termination without temperature
+  database.put("time_stepping.cooldown.temperature_rate", 10.);
+  BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
+  database.put("time_stepping.cooldown.temperature", 400.);
+
+  // Check 26: Cooldown termination with a negative rate
+  database.put("time_stepping.cooldown.temperature_rate", -10.);
+  BOOST_CHECK_THROW(validate_input_database(database), std::runtime_error);
+  database.get_child("time_stepping").erase("cooldown");
+
   // Check 27: Missing experimental inputs
   database.put("experiment.read_in_experimental_data", true);
   database.put("experiment.file", "file.csv");